@@ -55,13 +55,10 @@ void vec_drop_many(size_t to_drop, ...) {
 //
 // # Failure
 // - Returns `NULL` if the allocation of the structure fails.
-//
-// # Panic
-// - Stops the program if the specified element size is 0.
+// - Returns `NULL` if the specified element size is 0.
 vec_t* vec_new(size_t elem_size) {
     if (elem_size == 0) {
-        printf("Error: element size of a `vec_t` cannot be 0\n");
-        exit(-1);
+        return NULL;
     }
 
     vec_t* v = malloc(sizeof(vec_t));
@@ -86,13 +83,10 @@ vec_t* vec_new(size_t elem_size) {
 // # Failures
 // - Returns `NULL` if the allocation of the structure fails.
 // - Returns `NULL` if the allocation of the underlying array fails.
-//
-// # Panic
-// - Stops the program if the specified element size is 0.
+// - Returns `NULL` if the specified element size is 0.
 vec_t* vec_with_capacity(size_t capacity, size_t elem_size) {
     if (elem_size == 0) {
-        printf("Error: element size of a `vec_t` cannot be 0\n");
-        exit(-1);
+        return NULL;
     }
 
     if (capacity == 0) {
@@ -120,8 +114,7 @@ vec_t* vec_with_capacity(size_t capacity, size_t elem_size) {
 // TODO!
 vec_t* vec_with_value(void* value, size_t len, size_t elem_size) {
     if (elem_size == 0) {
-        printf("Error: element size of a `vec_t` cannot be 0\n");
-        exit(-1);
+        return NULL;
     }
 
     if (len == 0) {
@@ -166,13 +159,10 @@ vec_t* vec_with_value(void* value, size_t len, size_t elem_size) {
 // # Failures
 // - Returns `NULL` if the allocation of the structure fails.
 // - Returns `NULL` if the specified raw pointer is not valid.
-//
-// # Panic
-// - Stops the program if the specified element size is 0.
+// - Returns `NULL` if the specified element size is 0.
 vec_t* vec_from_raw_parts(void* raw_ptr, size_t len, size_t elem_size) {
     if (elem_size == 0) {
-        printf("Error: element size of a `vec_t` cannot be 0\n");
-        exit(-1);
+        return NULL;
     }
 
     vec_t* v = vec_with_capacity(len, elem_size);
@@ -338,22 +328,11 @@ int vec_is_empty(vec_t* self) {
 //
 // # Failure
 // - Returns `NULL` if the pointer to the underlying data is not valid.
-//
-// # Panic
-// - Stops the program if the specified index is equal to or greater than
+// - Returns `NULL` if the specified index is equal to or greater than
 //   the length of the vector.
 inline
 void* vec_peek(vec_t* self, size_t index) {
-    if (index >= self->len) {
-        printf("Error: index out of bounds, `len` is %lu but `index` is %lu\n", 
-            self->len, 
-            index
-        );
-        vec_drop(self);
-        exit(-1);
-    }
-    
-    if (!self->data) {
+    if (index >= self->len || !self->data) {
         return NULL;
     }
 
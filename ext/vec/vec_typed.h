@@ -0,0 +1,165 @@
+/**
+ * @file    vec_typed.h
+ * @brief   Type-specialized variants of the generic vector, generated by a
+ *          macro for each element type.
+ * @author  Gabriel Dos Santos
+ **/
+
+#ifndef VEC_TYPED_H
+#define VEC_TYPED_H
+
+#include "vec.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Contiguous growable arrays of a single, known type.
+//
+// `VEC_TYPED(type, name)` declares the `vec_name_t` type, laid out like
+// `vec_t` without `elem_size`, and whose `data` field is a `type*`:
+//
+//      len     capacity    data
+//  +---------+----------+---------+
+//  |    2    |    3     | 0x06577 |
+//  +---------+----------+---------+
+//
+// It also declares the following inline functions:
+// - `vec_name_with_capacity(capacity)`, `vec_name_with_value(value, len)`:
+//   allocate a vector, or return `NULL` if the allocation failed.
+// - `vec_name_drop(self)`: deallocates a vector, `NULL` is ignored.
+// - `vec_name_fill(self, value, len)`: sets the length of the vector and all
+//   its elements, growing it if needed.
+// - `vec_name_reserve(self, additional)`, `vec_name_push(self, value)`.
+// - `vec_name_get(self, index)`, `vec_name_set(self, index, value)`.
+// Fallible functions return `VEC_OK` or `VEC_ERR`, like those of `vec_t`.
+//
+// An example: ```c
+// VEC_TYPED(int64_t, i64)
+//
+// vec_i64_t* v = vec_i64_with_value(0, 16);
+// vec_i64_set(v, 3, 42);
+// int64_t x = vec_i64_get(v, 3) + v->data[4];
+// vec_i64_drop(v);
+// ```
+//
+//
+// # Safety
+// Element accesses never go through `void*` nor `elem_size`, so the compiler
+// sees plain array indexing it can keep in registers and vectorize.
+// In release builds (`NDEBUG` defined), `vec_name_get()` and `vec_name_set()`
+// do not check their index. In debug builds, they abort the program when the
+// index is out of bounds.
+//
+// Unlike `vec_t`, the capacity grows geometrically, so that pushing is O(1)
+// amortized.
+
+#ifdef NDEBUG
+#define VEC_CHECK_INDEX(self, index) ((void)0)
+#else
+#define VEC_CHECK_INDEX(self, index)                                           \
+    vec_check_index((self)->len, (index), __FILE__, __LINE__)
+
+static inline void vec_check_index(size_t len, size_t index, char const* file,
+                                   int line) {
+    if (index >= len) {
+        fprintf(stderr,
+                "%s:%d: index out of bounds, `len` is %zu but `index` is %zu\n",
+                file, line, len, index);
+        abort();
+    }
+}
+#endif
+
+#define VEC_TYPED(type, name)                                                  \
+typedef struct vec_##name##_s {                                                \
+    size_t len;                                                                \
+    size_t capacity;                                                           \
+    type* data;                                                                \
+} vec_##name##_t;                                                              \
+                                                                               \
+static inline void vec_##name##_drop(vec_##name##_t* self) {                   \
+    if (self) {                                                                \
+        free(self->data);                                                      \
+        free(self);                                                            \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+static inline vec_##name##_t* vec_##name##_with_capacity(size_t capacity) {    \
+    vec_##name##_t* self = malloc(sizeof(vec_##name##_t));                     \
+    if (!self) {                                                               \
+        return NULL;                                                           \
+    }                                                                          \
+                                                                               \
+    self->len = 0;                                                             \
+    self->capacity = capacity ? capacity : 1;                                  \
+    self->data = malloc(self->capacity * sizeof(type));                        \
+    if (!self->data) {                                                         \
+        free(self);                                                            \
+        return NULL;                                                           \
+    }                                                                          \
+    return self;                                                               \
+}                                                                              \
+                                                                               \
+static inline int vec_##name##_reserve(vec_##name##_t* self,                   \
+                                       size_t additional) {                    \
+    if (self->len + additional <= self->capacity) {                            \
+        return VEC_OK;                                                         \
+    }                                                                          \
+                                                                               \
+    size_t capacity = 2 * self->capacity;                                      \
+    if (capacity < self->len + additional) {                                   \
+        capacity = self->len + additional;                                     \
+    }                                                                          \
+    type* data = realloc(self->data, capacity * sizeof(type));                 \
+    if (!data) {                                                               \
+        return VEC_ERR;                                                        \
+    }                                                                          \
+    self->data = data;                                                         \
+    self->capacity = capacity;                                                 \
+    return VEC_OK;                                                             \
+}                                                                              \
+                                                                               \
+static inline int vec_##name##_fill(vec_##name##_t* self, type value,          \
+                                    size_t len) {                              \
+    self->len = 0;                                                             \
+    if (!vec_##name##_reserve(self, len)) {                                    \
+        return VEC_ERR;                                                        \
+    }                                                                          \
+    for (size_t i = 0; i < len; i++) {                                         \
+        self->data[i] = value;                                                 \
+    }                                                                          \
+    self->len = len;                                                           \
+    return VEC_OK;                                                             \
+}                                                                              \
+                                                                               \
+static inline vec_##name##_t* vec_##name##_with_value(type value,              \
+                                                      size_t len) {            \
+    vec_##name##_t* self = vec_##name##_with_capacity(len);                    \
+    if (self) {                                                                \
+        vec_##name##_fill(self, value, len);                                   \
+    }                                                                          \
+    return self;                                                               \
+}                                                                              \
+                                                                               \
+static inline int vec_##name##_push(vec_##name##_t* self, type value) {        \
+    if (!vec_##name##_reserve(self, 1)) {                                      \
+        return VEC_ERR;                                                        \
+    }                                                                          \
+    self->data[self->len++] = value;                                           \
+    return VEC_OK;                                                             \
+}                                                                              \
+                                                                               \
+static inline type vec_##name##_get(vec_##name##_t const* self,                \
+                                    size_t index) {                            \
+    VEC_CHECK_INDEX(self, index);                                              \
+    return self->data[index];                                                  \
+}                                                                              \
+                                                                               \
+static inline void vec_##name##_set(vec_##name##_t* self, size_t index,        \
+                                    type value) {                              \
+    VEC_CHECK_INDEX(self, index);                                              \
+    self->data[index] = value;                                                 \
+}
+
+#endif
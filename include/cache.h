@@ -0,0 +1,80 @@
+/**
+ * @file    cache.h
+ * @brief   Declaration of the persistent result cache, storing solved
+ *          instances on disk so that identical queries skip solving.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "config.h"
+#include "options.h"
+#include "solver.h"
+#include "status.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Maximum number of results kept in a cache when `--cache-limit` is not given.
+ **/
+#define CACHE_DEFAULT_ENTRIES 1024
+
+/**
+ * Directory of cached results, one file per result, named after the hash of
+ * the instance and of the options that affect the result.
+ * Processes sharing a directory synchronize with `flock` on its `lock` file:
+ * lookups take a shared lock, stores and evictions an exclusive one. Results
+ * are written to a temporary file first, then renamed, so they are never
+ * read partially. Hits update the modification time of their file, which
+ * drives the least recently used eviction.
+ **/
+typedef struct cache_t {
+    char* dir;
+    size_t max_entries;
+} cache_t;
+
+/**
+ * Opens a cache directory, creating it if needed.
+ *
+ * @param dir Path to the directory.
+ * @param max_entries Maximum number of results kept in the directory.
+ * @return The cache, or `NULL` if the directory cannot be used.
+ **/
+cache_t* cache_open(char const* dir, size_t max_entries);
+
+/**
+ * Closes a cache. The results stay on disk.
+ *
+ * @param cache Cache to close.
+ **/
+void cache_close(cache_t* cache);
+
+/**
+ * Looks up the result of an instance solved with the same options.
+ *
+ * @param cache Cache to search.
+ * @param config Configuration of the problem.
+ * @param options Solving options. Only the engine matters for the exact
+ *                engine; heuristic results also depend on the time limit,
+ *                seed, threads and target cost.
+ * @param solver Pre-initialized solver, receiving the cached tour and cost on
+ *               a hit.
+ * @return `true` on a hit, `false` otherwise.
+ **/
+bool cache_lookup(cache_t const* cache, config_t const* config,
+                  options_t const* options, solver_t* solver);
+
+/**
+ * Stores the result of a solver, evicting the least recently used results if
+ * the cache is full.
+ *
+ * @param cache Cache to store the result in.
+ * @param config Configuration of the problem.
+ * @param options Solving options of the result.
+ * @param solver Solver holding the result.
+ * @return `TSP_OK`, `TSP_ERR_IO` if the result could not be written or
+ *         `TSP_ERR_ALLOC`.
+ **/
+tsp_status_t cache_store(cache_t const* cache, config_t const* config,
+                         options_t const* options, solver_t const* solver);
@@ -0,0 +1,57 @@
+/**
+ * @file    christofides.h
+ * @brief   Declaration of the Christofides approximation engine, which builds
+ *          a tour of guaranteed quality on metric instances in O(n²).
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "config.h"
+#include "solver.h"
+#include "status.h"
+
+/**
+ * Largest number of odd-degree nodes of the spanning tree that are matched
+ * exactly, by a dynamic program in O(2^k k). More of them are matched
+ * greedily.
+ **/
+#define CHRISTOFIDES_EXACT_MATCHING 20
+
+/**
+ * Number of nearest nodes each node may be paired with by the greedy
+ * matching, before the nodes left are paired with their nearest unpaired
+ * node.
+ **/
+#define CHRISTOFIDES_GREEDY_CANDIDATES 8
+
+/**
+ * Largest number of nodes on which the triangle inequality is checked, in
+ * O(n³), before twice the matching is used as a lower bound.
+ **/
+#define CHRISTOFIDES_METRIC_CHECK 500
+
+/**
+ * Builds a tour with Christofides' algorithm.
+ * A minimum spanning tree is built with Prim's algorithm, whose scan of each
+ * row is branch-free so that it is vectorized. Its nodes of odd degree are
+ * then paired by a minimum-weight perfect matching, exact for up to
+ * `CHRISTOFIDES_EXACT_MATCHING` nodes, and otherwise greedy, the lightest
+ * pairs among those of each node with its nearest nodes being taken first.
+ * The tree and the matching form a graph whose nodes all have an even degree,
+ * and the tour follows an Eulerian circuit of it, skipping the nodes already
+ * visited.
+ *
+ * The spanning tree weighs less than an optimal tour, and is stored as the
+ * lower bound of the solver. When the matching is exact and the instance is
+ * metric (checked on every triple of nodes for up to
+ * `CHRISTOFIDES_METRIC_CHECK` nodes), twice the matching weighs less than an
+ * optimal tour too and is stored instead if it is larger; the tour then costs
+ * at most 1.5 times that bound.
+ *
+ * @param config Configuration of the problem.
+ * @param solver Pre-initialized solver, receiving the tour.
+ * @return `TSP_OK`, `TSP_ERR_INVALID_ARGUMENT` if the instance is asymmetric
+ *         or has missing edges, or `TSP_ERR_ALLOC`.
+ **/
+tsp_status_t solve_christofides(config_t const* config, solver_t* solver);
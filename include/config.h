@@ -6,13 +6,60 @@
 
 #pragma once
 
-#include "vec.h"
+#include "pages.h"
+#include "status.h"
+#include "vectors.h"
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
 
+/**
+ * Above this number of nodes, Euclidean instances do not materialize their
+ * adjacency matrix and distances are computed on the fly from the coordinates.
+ **/
+#define CONFIG_DENSE_LIMIT 4096
+
+/**
+ * Number of bytes of the text of an adjacency matrix in each chunk parsed by
+ * a thread, the chunks being cut at the first line boundary past a multiple
+ * of this size.
+ **/
+#define CONFIG_PARSE_CHUNK (1UL << 20)
+
+/**
+ * Adjacency lists of a sparse instance in compressed sparse row (CSR) layout:
+ * the edges leaving node `i` go to `targets[offsets[i]]` to
+ * `targets[offsets[i + 1] - 1]`, sorted by increasing target, and weigh the
+ * same entries of `weights`. The other edges are missing.
+ **/
+typedef struct sparse_t {
+    vec_i64_t* offsets;
+    vec_i64_t* targets;
+    vec_i64_t* weights;
+} sparse_t;
+
+/**
+ * Instances are given by an adjacency matrix, by coordinates (with a matrix
+ * computed from them when they are few enough) or by adjacency lists. Once
+ * their nodes have been renumbered (see `reorder.h`), `labels` holds the
+ * original number of each node, and is `NULL` before. Matrices are allocated
+ * by `pages_alloc`, with the backing `matrix_backing`.
+ *
+ * Symmetric matrices are `triangular`: only their upper triangle, diagonal
+ * included, is stored row after row, in `n * (n + 1) / 2` entries (see
+ * `adj_matrix_index`). Euclidean matrices always are, and explicit ones are
+ * when they are verified to be symmetric once loaded.
+ **/
 typedef struct config_t {
     size_t nb_nodes;
-    vec_t* adjacency_matrix;
+    vec_i64_t* adjacency_matrix;
+    vec_f64_t* coordinates;
+    sparse_t* sparse;
+    vec_i64_t* labels;
+    pages_backing_t matrix_backing;
+    bool triangular;
 } config_t;
 
 /**
@@ -24,10 +71,60 @@ typedef struct config_t {
  *   WEIGHT_1-0      0     WEIGHT_1-2 ...
  *   WEIGHT_2-0 WEIGHT_2-1      0     ...
  *   ...
+ *
+ * Each row of the matrix is a line of exactly `NB_NODES` integers, of any
+ * length, and blank lines are skipped. The rows are parsed on all the OpenMP
+ * threads, in chunks of `CONFIG_PARSE_CHUNK` bytes, from a mapping of the
+ * file when it is a regular one.
+ *
+ * Euclidean instances can instead be given as coordinates, in which case the
+ * weights are the rounded distances between the nodes (never less than 1, as
+ * a weight of 0 means that there is no edge):
+ *
+ *   NB_NODES EUC_2D
+ *   X_0 Y_0
+ *   X_1 Y_1
+ *   ...
+ *
+ * Sparse instances can instead list their edges, one `FROM TO WEIGHT` line
+ * per directed edge between nodes numbered from 0, the others being missing.
+ * They are stored as adjacency lists, whose size grows with the number of
+ * edges rather than with the square of the number of nodes:
+ *
+ *   NB_NODES SPARSE
+ *   FROM_0 TO_0 WEIGHT_0
+ *   FROM_1 TO_1 WEIGHT_1
+ *   ...
+ *
+ * A header with any other kind of instance is malformed.
  * 
  * @param filename Path to the configuration file.
+ * @param config Output configuration, set to `NULL` on failure.
+ * @return `TSP_OK`, `TSP_ERR_IO` if the file cannot be opened,
+ *         `TSP_ERR_FORMAT` if it is malformed or `TSP_ERR_ALLOC`.
+ */
+tsp_status_t config_load(char const* filename, config_t** config);
+
+/**
+ * Reads a configuration from an open stream, in the format of `config_load`.
+ *
+ * @param fp Stream to read the configuration from.
+ * @param config Output configuration, set to `NULL` on failure.
+ * @return `TSP_OK`, `TSP_ERR_FORMAT` if the stream is malformed or
+ *         `TSP_ERR_ALLOC`.
+ */
+tsp_status_t config_read(FILE* fp, config_t** config);
+
+/**
+ * Builds a configuration from a copy of an adjacency matrix.
+ *
+ * @param matrix Row-major `nb_nodes * nb_nodes` adjacency matrix.
+ * @param nb_nodes Number of nodes.
+ * @param config Output configuration, set to `NULL` on failure.
+ * @return `TSP_OK`, `TSP_ERR_INVALID_ARGUMENT` or `TSP_ERR_ALLOC`.
  */
-config_t* config_load(char const* filename);
+tsp_status_t config_from_matrix(int64_t const* matrix, size_t nb_nodes,
+                                config_t** config);
 
 /**
  * Deallocates the configuration.
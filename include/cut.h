@@ -0,0 +1,57 @@
+/**
+ * @file    cut.h
+ * @brief   Declaration of the branch-and-cut exact engine, which bounds its
+ *          search by linear relaxations strengthened with subtour
+ *          elimination cuts.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "config.h"
+#include "solver.h"
+#include "status.h"
+
+/**
+ * Depth of the search tree down to which the fractional solutions of the
+ * relaxation are separated. Deeper nodes only separate the integral ones,
+ * which may still contain subtours.
+ **/
+#define CUT_SEPARATION_DEPTH 8
+
+/**
+ * Tolerance on the values of the relaxation, below which an edge is unused,
+ * a value is integral, or a cut is not violated.
+ **/
+#define CUT_EPSILON 1e-6
+
+/**
+ * Solves a symmetric problem exactly by branch and cut.
+ * Each edge is a variable between 0 and 1, and the relaxation starts with
+ * the degree constraints, each node having two edges. Its fractional
+ * solutions are separated with subtour elimination constraints: the edges
+ * inside a set of nodes `S` sum to at most `|S| - 1`, for the connected
+ * components of the support of the solution if there are several, and
+ * otherwise for the cuts of weight less than 2 that the Stoer-Wagner minimum
+ * cut algorithm meets. The relaxation is solved by the dual simplex of
+ * `simplex.h`, and its bound prunes the nodes that cannot beat the
+ * incumbent, which starts as the tour held by the solver or the one of the LK
+ * engine.
+ *
+ * The search branches on the most fractional edge, used first. A single
+ * relaxation is kept across the nodes: the cuts found anywhere stay, since
+ * they hold for every tour, and each node starts the dual simplex from the
+ * basis its parent left, after fixing the edge it branches on. Once the root
+ * is solved, the edges whose reduced cost proves that they cannot be part of
+ * a better tour are removed.
+ *
+ * `solver->lower_bound` receives the bound of the root, and
+ * `solver->nb_explored` the number of nodes of the search tree. Asymmetric
+ * instances are solved by `solve_little`, and instances of less than 5 nodes
+ * by `solve_tsp`.
+ *
+ * @param config Configuration of the problem.
+ * @param solver Pre-initialized solver.
+ * @return `TSP_OK`, or `TSP_ERR_ALLOC`.
+ **/
+tsp_status_t solve_cut(config_t const* config, solver_t* solver);
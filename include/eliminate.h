@@ -0,0 +1,77 @@
+/**
+ * @file    eliminate.h
+ * @brief   Declaration of the reduced-cost edge elimination, which removes the
+ *          edges that cannot be part of an optimal tour before the search.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "config.h"
+#include "pages.h"
+
+typedef struct solver_t solver_t;
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Maximum number of subgradient iterations of the 1-tree bound.
+ **/
+#define ELIMINATE_MAX_ITERATIONS 500
+
+/**
+ * Edges left after the elimination, as sorted successor lists: the successors
+ * of node `i` are `nodes[offsets[i]]` to `nodes[offsets[i + 1] - 1]`, reached
+ * through edges of the same entries of `weights`. `lower_bound` is a lower
+ * bound of the cost of any tour, `INT64_MAX` if there is none. `nb_edges` and
+ * `nb_eliminated` count the edges of symmetric instances once, and both
+ * directions of the edges of asymmetric ones.
+ *
+ * `nodes` and `weights` share one buffer of `capacity` entries each, which
+ * the search scans at every node and which is allocated by `pages_alloc`.
+ **/
+typedef struct candidates_t {
+    size_t nb_nodes;
+    size_t nb_edges;
+    size_t nb_eliminated;
+    size_t* offsets;
+    size_t* nodes;
+    int64_t* weights;
+    int64_t lower_bound;
+    size_t capacity;
+    pages_backing_t backing;
+} candidates_t;
+
+/**
+ * Eliminates the edges of a symmetric instance that no optimal tour uses.
+ *
+ * The Held-Karp lower bound is computed with subgradient optimization of the
+ * node penalties of a 1-tree, and an upper bound with the `lk` engine, whose
+ * tour is stored in the solver (see `solver_store_tour`) unless the solver
+ * already holds a tour at least as short. The reduced cost of an edge is the
+ * increase of the 1-tree bound when the 1-tree is forced to contain it. An
+ * edge whose bound, plus its reduced cost, reaches the cost of the incumbent
+ * of the solver is removed, since the search only looks for tours cheaper
+ * than its incumbent.
+ *
+ * The lower bound is the Held-Karp bound when it is computed, and otherwise
+ * the sum of the lightest edge leaving each node.
+ *
+ * Edges of weight 0 (missing) are never candidates. Nothing else is
+ * eliminated on asymmetric instances, nor on instances of less than 4 or more
+ * than `CONFIG_DENSE_LIMIT` nodes. The lists of sparse instances are copied
+ * from their adjacency lists instead of scanning every pair of nodes.
+ *
+ * @param config Configuration of the problem.
+ * @param solver Solver of the search, whose incumbent may be replaced.
+ * @return The candidate edges, or `NULL` if the allocation failed.
+ **/
+candidates_t* candidates_init(config_t const* config, solver_t* solver);
+
+/**
+ * Deallocates candidate edges.
+ *
+ * @param candidates Candidate edges to deallocate, `NULL` is ignored.
+ **/
+void candidates_destroy(candidates_t* candidates);
@@ -0,0 +1,43 @@
+/**
+ * @file    engine.h
+ * @brief   Declaration of the `engine_t` enumeration of the solving engines,
+ *          shared by the command line options and the public API.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include <stdbool.h>
+
+/**
+ * Solving engines that can be selected from the command line.
+ **/
+typedef enum engine_t {
+    ENGINE_EXACT,
+    ENGINE_LK,
+    ENGINE_PORTFOLIO,
+    ENGINE_HYBRID,
+    ENGINE_CHRISTOFIDES,
+    ENGINE_SPACEFILL,
+    ENGINE_GENETIC,
+    ENGINE_CUT,
+    ENGINE_LITTLE,
+    ENGINE_AUTO,
+} engine_t;
+
+/**
+ * Returns the name of an engine, as accepted by `--engine`.
+ *
+ * @param engine Engine to name.
+ * @return Name of the engine.
+ **/
+char const* engine_name(engine_t engine);
+
+/**
+ * Looks up an engine by its name, as accepted by `--engine`.
+ *
+ * @param name Name of the engine.
+ * @param engine Output engine.
+ * @return `true` if the name is known, `false` otherwise.
+ **/
+bool engine_parse(char const* name, engine_t* engine);
@@ -0,0 +1,73 @@
+/**
+ * @file    events.h
+ * @brief   Declaration of the incumbent event stream, which writes every
+ *          improvement of the solution as a JSON line from a dedicated
+ *          writer thread.
+ * @author  Gabriel Dos Santos
+ *
+ * Each line is a JSON object of the following form:
+ *
+ *   {"time":1760000000.123456,"elapsed":0.002131,"cost":2085,
+ *    "explored":1432,"lower_bound":2002,"tour":[0,3,12,...,0]}
+ *
+ * where `time` is the Unix time of the improvement in seconds, `elapsed` the
+ * time since the stream was opened, `explored` the number of nodes of the
+ * search tree (or local search kicks, or children of the genetic algorithm)
+ * explored so far and `lower_bound` the best known lower bound of the cost of
+ * a tour, `null` if the engine has none.
+ **/
+
+#pragma once
+
+#include "solver.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Number of events waiting for the writer thread. When the writer falls
+ * behind, the oldest waiting event is dropped to make room for the new one,
+ * so the last improvement is always written.
+ **/
+#define EVENTS_QUEUE_SIZE 64
+
+typedef struct events_t events_t;
+
+/**
+ * Opens an event stream and starts its writer thread.
+ * Opening a named pipe waits for its reader.
+ *
+ * @param path Path of the file or pipe to write the events to.
+ * @param nb_nodes Number of nodes of the problem.
+ * @return The event stream, or `NULL` if the file could not be opened or the
+ *         allocation failed.
+ **/
+events_t* events_open(char const* path, size_t nb_nodes);
+
+/**
+ * Queues the incumbent of a solver for the writer thread, unless it is not
+ * better than the last queued one.
+ * It never waits for the writer to do any I/O, the queue lock being only held
+ * while the event is copied in or out.
+ *
+ * @param events Event stream.
+ * @param solver Solver holding the new incumbent.
+ **/
+void events_push(events_t* events, solver_t const* solver);
+
+/**
+ * Incumbent callback of a solver (see `solver_incumbent_fn`) that queues its
+ * improvements in the event stream given as `data`.
+ *
+ * @param solver Solver holding the new incumbent.
+ * @param data Event stream.
+ **/
+void events_on_incumbent(solver_t const* solver, void* data);
+
+/**
+ * Writes the waiting events, stops the writer thread and closes the stream.
+ *
+ * @param events Event stream to close, `NULL` is ignored.
+ * @return `true` if every event was written, `false` on a write error.
+ **/
+bool events_close(events_t* events);
@@ -0,0 +1,73 @@
+/**
+ * @file    genetic.h
+ * @brief   Declaration of the genetic algorithm engine, which evolves islands
+ *          of tours with the edge assembly crossover (EAX) on a pool of
+ *          threads.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "config.h"
+#include "options.h"
+#include "solver.h"
+#include "status.h"
+
+/**
+ * Number of tours of each island.
+ **/
+#define GENETIC_POPULATION 40
+
+/**
+ * Maximum number of children generated from each pair of parents, the best
+ * of which replaces the first parent if it is shorter.
+ **/
+#define GENETIC_CHILDREN 20
+
+/**
+ * Number of generations between two migrations, in which each island sends
+ * a copy of its best tour to the next one.
+ **/
+#define GENETIC_MIGRATION_INTERVAL 10
+
+/**
+ * Number of generations without improvement of the best tour after which the
+ * search stops.
+ **/
+#define GENETIC_STALL_GENERATIONS 20
+
+/**
+ * Below this number of nodes, the instance is solved by the LK engine.
+ **/
+#define GENETIC_MIN_NODES 8
+
+/**
+ * Evolves a population of tours with a genetic algorithm.
+ * Each of the `options->threads` threads evolves its own island of
+ * `GENETIC_POPULATION` tours, first optimized by the LK local search (see
+ * `lk.h`) from randomized nearest-neighbor tours. Each generation pairs the
+ * tours of an island in a random cycle, and crosses every tour with the next
+ * one by the edge assembly crossover: the edges that only one of the parents
+ * has are decomposed into cycles alternating between the edges of both, and
+ * each child swaps the edges of one of these cycles in the first parent,
+ * then reconnects the subtours this leaves with the cheapest 2-opt moves
+ * between nearest neighbors. Every `GENETIC_MIGRATION_INTERVAL` generations,
+ * the best tour of each island replaces the worst tour of the next one.
+ *
+ * Tours are stored as the two neighbors of every node, in 32-bit integers,
+ * one contiguous block per island. Every improvement of the best tour is
+ * stored in the solver, so the event stream follows its cost over time.
+ *
+ * The search stops after `GENETIC_STALL_GENERATIONS` generations without
+ * improvement, when the time limit is reached, or when the best tour costs at
+ * most `options->target_cost`.
+ *
+ * @param config Configuration of the problem.
+ * @param solver Pre-initialized solver, receiving the best tour.
+ * @param options Options holding the time limit, target cost, seed and number
+ *                of threads.
+ * @return `TSP_OK`, `TSP_ERR_INVALID_ARGUMENT` if the instance is asymmetric,
+ *         or `TSP_ERR_ALLOC`.
+ **/
+tsp_status_t solve_genetic(config_t const* config, solver_t* solver,
+                           options_t const* options);
@@ -0,0 +1,58 @@
+/**
+ * @file    hybrid.h
+ * @brief   Declaration of the hybrid exact engine, a branch-and-bound search
+ *          whose last levels are replaced by a memoized Held-Karp dynamic
+ *          program.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "config.h"
+#include "solver.h"
+#include "status.h"
+
+/**
+ * Number of unvisited cities under which the search switches to the dynamic
+ * program.
+ **/
+#define HYBRID_TAIL_SIZE 8
+
+/**
+ * Number of entries of the memoization table, a power of 2. Each entry takes
+ * 24 bytes.
+ **/
+#define HYBRID_MEMO_ENTRIES ((size_t)1 << 20)
+
+/**
+ * Largest instance handled by the hybrid search, the unvisited cities being
+ * stored in a single 64-bit word. Larger instances are solved by
+ * `solve_tsp`.
+ **/
+#define HYBRID_MAX_NODES 64
+
+/**
+ * Solves the problem exactly, like `solve_tsp`, but replaces the bottom of
+ * the search tree with a dynamic program.
+ * Once at most `HYBRID_TAIL_SIZE` cities are left to visit, the cost of the
+ * cheapest path from the current city through all of them and back to the
+ * first city is computed with the Held-Karp recursion. Its sub-results are
+ * memoized in a direct-mapped table of `HYBRID_MEMO_ENTRIES` entries, keyed
+ * by the remaining set, the current city and the return city, so that the
+ * many prefixes of the search that end on the same tail share its cost. A
+ * collision overwrites the previous entry, which is recomputed if needed.
+ *
+ * Above the tail, the cities are tried nearest first, and a node is pruned
+ * when a lower bound of its completion, counting for each city the lightest
+ * edges it can still use, reaches the incumbent. Unlike the bound of
+ * `solve_tsp`, this one never overestimates, which matters here since the
+ * dynamic program finds good incumbents early.
+ *
+ * A tour already held by the solver is used as the initial incumbent.
+ *
+ * @param config Configuration of the problem.
+ * @param solver Pre-initialized solver.
+ * @return `TSP_OK`, or `TSP_ERR_ALLOC` if the memoization table could not be
+ *         allocated.
+ **/
+tsp_status_t solve_hybrid(config_t const* config, solver_t* solver);
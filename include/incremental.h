@@ -0,0 +1,91 @@
+/**
+ * @file    incremental.h
+ * @brief   Declaration of the incremental re-solve, which updates the solution
+ *          of an instance after the weights of a few edges changed.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "config.h"
+#include "options.h"
+#include "solver.h"
+#include "status.h"
+#include "vec.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * New weight of the edge between two nodes, in both directions. A weight of 0
+ * removes the edge.
+ **/
+typedef struct edge_change_t {
+    size_t from;
+    size_t to;
+    int64_t weight;
+} edge_change_t;
+
+/**
+ * Loads a tour, given as node indices separated by spaces or `->` (as printed
+ * by the solver). The closing node may be repeated at the end.
+ *
+ * @param filename Path to the tour file.
+ * @param nb_nodes Number of nodes of the problem.
+ * @param tour Output vector of `nb_nodes` `size_t` nodes, set to `NULL` on
+ *             failure.
+ * @return `TSP_OK`, `TSP_ERR_IO`, `TSP_ERR_FORMAT` if the file is not a tour
+ *         of `nb_nodes` nodes, or `TSP_ERR_ALLOC`.
+ **/
+tsp_status_t tour_load(char const* filename, size_t nb_nodes, vec_t** tour);
+
+/**
+ * Loads a delta file, made of `FROM TO WEIGHT` lines.
+ *
+ * @param filename Path to the delta file.
+ * @param nb_nodes Number of nodes of the problem.
+ * @param delta Output vector of `edge_change_t`, set to `NULL` on failure.
+ * @return `TSP_OK`, `TSP_ERR_IO`, `TSP_ERR_FORMAT` or `TSP_ERR_ALLOC`.
+ **/
+tsp_status_t delta_load(char const* filename, size_t nb_nodes, vec_t** delta);
+
+/**
+ * Applies a delta to the adjacency matrix, or adjacency lists, of a
+ * configuration. The edges of a sparse instance can be reweighted or removed,
+ * but not added.
+ *
+ * @param config Configuration to update, which must hold an adjacency matrix
+ *               or adjacency lists.
+ * @param delta Vector of `edge_change_t`.
+ * @param changed Output vector of the `size_t` nodes whose edges changed, each
+ *                listed once, set to `NULL` on failure.
+ * @return `TSP_OK`, `TSP_ERR_INVALID_ARGUMENT` if the configuration has
+ *         neither, or if the delta adds an edge to a sparse instance, or
+ *         `TSP_ERR_ALLOC`.
+ **/
+tsp_status_t delta_apply(config_t* config, vec_t const* delta,
+                         vec_t** changed);
+
+/**
+ * Solves an instance again after some of its weights changed, starting from
+ * the previous tour.
+ * The previous tour, with the new weights, is the initial incumbent of the
+ * exact engine, which only has to prove that no better tour exists. If the
+ * solver still holds the bound tables of the previous instance, such as after
+ * a previous call with the same solver, only those of the changed nodes are
+ * recomputed; a new solver computes them all once. The heuristic engines
+ * re-optimize the previous tour around the changed nodes (see
+ * `solve_lk_incremental`). The `auto` engine is resolved first (see
+ * `selector_resolve`).
+ *
+ * @param config Configuration of the problem, with the delta applied.
+ * @param solver Solver, either new or holding the bound tables of the
+ *               previous instance.
+ * @param options Options selecting and tuning the engine.
+ * @param previous Nodes of the previous tour, in order.
+ * @param changed Vector of the `size_t` nodes whose edges changed.
+ * @return `TSP_OK`, or the error of the engine.
+ **/
+tsp_status_t solve_incremental(config_t const* config, solver_t* solver,
+                               options_t const* options,
+                               size_t const* previous, vec_t const* changed);
@@ -0,0 +1,65 @@
+/**
+ * @file    kdtree.h
+ * @brief   Declaration of the `kdtree_t` structure, a 2D spatial index over the
+ *          coordinates of Euclidean instances.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "vec.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Maximum number of points stored in the leaves of the tree.
+ **/
+#define KDTREE_BUCKET 8
+
+/**
+ * The tree is implicit: `index` is a permutation of the points such that every
+ * subtree covers a contiguous range `[lo, hi)`. Internal nodes split their
+ * range at `mid = (lo + hi) / 2` along dimension `dims[mid]`, points in
+ * `[lo, mid)` being on the low side of `index[mid]` and points in `[mid, hi)`
+ * on its high side.
+ **/
+typedef struct kdtree_t {
+    size_t nb_points;
+    double const* coords;
+    vec_t* index;
+    vec_t* dims;
+} kdtree_t;
+
+/**
+ * Builds a k-d tree over a set of 2D points in O(n log n), the top levels of
+ * the tree being built in parallel.
+ *
+ * @param coords Coordinates of the points, stored as `x0 y0 x1 y1 ...`. They
+ *               must outlive the tree.
+ * @param nb_points Number of points.
+ * @return The tree, or `NULL` if the allocation failed.
+ **/
+kdtree_t* kdtree_build(double const* coords, size_t nb_points);
+
+/**
+ * Deallocates the tree.
+ *
+ * @param tree Tree to deallocate.
+ **/
+void kdtree_destroy(kdtree_t* tree);
+
+/**
+ * Finds the `k` nearest neighbors of one of the points of the tree, excluding
+ * the point itself.
+ *
+ * @param tree Tree to search.
+ * @param point Index of the point whose neighbors are searched.
+ * @param k Number of neighbors to find.
+ * @param nearest Output array of `k` point indices, sorted by increasing
+ *                distance.
+ * @param distances Scratch array of `k` squared distances.
+ * @return Number of neighbors found, `min(k, nb_points - 1)`.
+ **/
+size_t kdtree_nearest(kdtree_t const* tree, size_t point, size_t k,
+                      uint32_t* nearest, double* distances);
@@ -0,0 +1,37 @@
+/**
+ * @file    kernels.h
+ * @brief   Declaration of the branch-and-bound kernels specialized at compile
+ *          time for small instances.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "config.h"
+#include "solver.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Largest instance handled by the specialized kernels, the visited nodes
+ * being stored in a single 64-bit word.
+ **/
+#define KERNELS_MAX_NODES 64
+
+/**
+ * Solves small instances with a branch-and-bound kernel specialized for a
+ * fixed number of nodes (8, 16, 32 or 64), picking the smallest one that fits
+ * `config->nb_nodes`.
+ * The kernels explore the same search tree as `solve_branch_and_bound`, and
+ * thus find the same solution, but use fixed-size stack arrays, precomputed
+ * minimum weights, and single-word masks of the visited nodes and of the
+ * candidate successors of each node, whose child loops only go through the
+ * set bits.
+ *
+ * @param config Configuration of the problem.
+ * @param solver Pre-initialized solver.
+ * @param root_bound Lower bound of the root node.
+ * @return `true` if the instance was solved, `false` if it is too large.
+ **/
+bool solve_small(config_t const* config, solver_t* solver, int64_t root_bound);
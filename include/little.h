@@ -0,0 +1,45 @@
+/**
+ * @file    little.h
+ * @brief   Declaration of Little's exact engine, which branches on including
+ *          or excluding single edges and bounds its search with a reduced
+ *          cost matrix.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "config.h"
+#include "solver.h"
+#include "status.h"
+
+/**
+ * Solves a problem exactly with the algorithm of Little, Murty, Sweeney and
+ * Karel, which suits asymmetric instances much better than the search over
+ * the next city of `solve_tsp`.
+ * The matrix is reduced by subtracting from each row, then each column, its
+ * minimum: the sum of the amounts is a lower bound of the cost of a tour,
+ * and each edge of reduced cost 0 is free above it. The search branches on
+ * one of these edges, the one whose exclusion raises the bound the most, and
+ * first includes it, removing its row and column and forbidding the edge
+ * that would close its path into a subtour, then excludes it. Both branches
+ * reduce the matrix again, which only changes the entries of some rows and
+ * columns: they are logged and restored when the branch returns instead of
+ * copying the matrix at each node.
+ *
+ * Missing edges are never used. A tour already held by the solver is used as
+ * the initial incumbent, `solver->lower_bound` receives the bound of the
+ * root, and `solver->nb_explored` the number of nodes of the search tree.
+ *
+ * With a time limit, the search stops at the first node it meets past the
+ * limit once it holds a tour, which is then not proven optimal. Including
+ * edges first reaches a tour after `n` levels, each of which takes O(n²).
+ * The cost matrix takes `8 * n * n` bytes.
+ *
+ * @param config Configuration of the problem.
+ * @param solver Pre-initialized solver.
+ * @param time_limit Time budget in seconds, or 0 to search until the tour is
+ *                   proven optimal.
+ * @return `TSP_OK`, or `TSP_ERR_ALLOC`.
+ **/
+tsp_status_t solve_little(config_t const* config, solver_t* solver,
+                          double time_limit);
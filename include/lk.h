@@ -0,0 +1,205 @@
+/**
+ * @file    lk.h
+ * @brief   Declaration of the Lin-Kernighan-style local search engine, meant
+ *          for instances that are too large for the branch-and-bound solver.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "config.h"
+#include "neighbors.h"
+#include "solver.h"
+#include "status.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Number of candidate neighbors considered for each node.
+ **/
+#define LK_NEIGHBORS 10
+
+/**
+ * Maximum number of sequential 2-opt steps chained in a single LK move.
+ **/
+#define LK_MAX_DEPTH 6
+
+/**
+ * Number of kicks per node performed by the iterated local search when no
+ * time limit is given.
+ **/
+#define LK_KICKS_PER_NODE 2
+
+/**
+ * Number of kicks performed between two publications of the current tour.
+ **/
+#define LK_KICKS_PER_ROUND 256
+
+/**
+ * State of the local search: the current tour, its cost and the search
+ * buffers. Each thread must use its own. The gains of the moves assume that
+ * reversing a path keeps its cost, so the instance must be symmetric.
+ **/
+typedef struct lk_t lk_t;
+
+/**
+ * Allocates the local search state, starting with the tour `0, 1, 2, ...`.
+ *
+ * @param config Configuration of the problem.
+ * @param neighbors Candidate neighbor lists, which must outlive the state.
+ * @return The local search state, or `NULL` if the allocation failed.
+ **/
+lk_t* lk_init(config_t const* config, neighbors_t const* neighbors);
+
+/**
+ * Deallocates the local search state.
+ *
+ * @param lk State to deallocate.
+ **/
+void lk_destroy(lk_t* lk);
+
+/**
+ * Builds a tour with the nearest neighbor heuristic.
+ *
+ * @param lk Local search state.
+ * @param start Node the tour starts with.
+ * @param rng Generator used to sometimes pick the second nearest node instead
+ *            of the nearest one, or `NULL` for the plain heuristic.
+ **/
+void lk_nearest_neighbor(lk_t* lk, size_t start, uint64_t* rng);
+
+/**
+ * Replaces the current tour.
+ *
+ * @param lk Local search state.
+ * @param tour Nodes of the new tour, in order.
+ **/
+void lk_set_tour(lk_t* lk, size_t const* tour);
+
+/**
+ * Copies the current tour.
+ *
+ * @param lk Local search state.
+ * @param tour Output array of `nb_nodes` nodes.
+ **/
+void lk_get_tour(lk_t const* lk, size_t* tour);
+
+/**
+ * Returns the cost of the current tour.
+ *
+ * @param lk Local search state.
+ * @return Cost of the tour.
+ **/
+int64_t lk_cost(lk_t const* lk);
+
+/**
+ * Returns the status of the local search: `TSP_ERR_ALLOC` if its move log
+ * could not grow, in which case the tour is still valid but the search stops
+ * and `lk_cost` is no longer accurate.
+ *
+ * @param lk Local search state.
+ * @return Status of the local search.
+ **/
+tsp_status_t lk_status(lk_t const* lk);
+
+/**
+ * Improves the current tour with LK and Or-opt moves until it reaches a local
+ * optimum or the deadline passes.
+ *
+ * @param lk Local search state.
+ * @param deadline Wall time (see `wall_time`) after which the search stops,
+ *                 or 0 for none.
+ **/
+void lk_optimize(lk_t* lk, double deadline);
+
+/**
+ * Improves the current tour like `lk_optimize`, but only starts moves from the
+ * given nodes (and from the nodes whose edges these moves change), so that
+ * the work is proportional to the part of the tour that needs improvement.
+ *
+ * @param lk Local search state.
+ * @param nodes Nodes to start from.
+ * @param nb_nodes Number of nodes.
+ * @param deadline Wall time (see `wall_time`) after which the search stops,
+ *                 or 0 for none.
+ **/
+void lk_optimize_nodes(lk_t* lk, size_t const* nodes, size_t nb_nodes,
+                       double deadline);
+
+/**
+ * Improves the current tour with 2-opt moves only, which add an edge between
+ * a node and one of its candidate neighbors, until none improves it or the
+ * deadline passes. Moves that would reverse more than `max_reversal` nodes
+ * either way are skipped, so that each move stays cheap on millions of
+ * nodes.
+ *
+ * @param lk Local search state.
+ * @param max_reversal Longest path a move may reverse.
+ * @param deadline Wall time (see `wall_time`) after which the search stops,
+ *                 or 0 for none.
+ * @return Number of nodes the moves were started from.
+ **/
+uint64_t lk_two_opt_pass(lk_t* lk, size_t max_reversal, double deadline);
+
+/**
+ * Perturbs the current local optimum with kicks, each followed by a local
+ * search, and keeps the results that are shorter. Tours of less than 8 nodes
+ * are too short to be kicked, and are left unchanged.
+ *
+ * @param lk Local search state.
+ * @param kicks Maximum number of kicks.
+ * @param deadline Wall time (see `wall_time`) after which no kick is
+ *                 performed and the local search stops, or 0 for none.
+ * @param rng Generator of the kicks.
+ * @return Number of kicks performed.
+ **/
+size_t lk_perturb(lk_t* lk, size_t kicks, double deadline, uint64_t* rng);
+
+/**
+ * Computes a near-optimal tour with an iterated Lin-Kernighan-style local
+ * search.
+ * A tour along a space-filling curve (see `spacefill_order`) on Euclidean
+ * instances, or a nearest-neighbor tour otherwise, is improved with LK moves
+ * (sequences of 2-opt steps, which include 2-opt and sequential 3-opt moves)
+ * and Or-opt moves, driven by candidate neighbor lists and don't-look bits on
+ * an array-based tour. Local optima are then perturbed with segment-swap
+ * kicks, which are kept only when the local search finds a shorter tour
+ * afterwards.
+ *
+ * The tour and its cost are written in `solver->optimal_path` and
+ * `solver->minimum_cost`, starting and ending at node 0, every time the tour
+ * improves.
+ *
+ * @param config Configuration of the problem.
+ * @param solver Pre-initialized solver.
+ * @param time_limit Time budget in seconds, which also stops the first local
+ *                   search, or 0 to perform `LK_KICKS_PER_NODE * nb_nodes`
+ *                   kicks.
+ * @param seed Seed of the pseudo-random kicks.
+ * @return `TSP_OK`, `TSP_ERR_INVALID_ARGUMENT` if the instance is asymmetric,
+ *         or `TSP_ERR_ALLOC` if the engine could not allocate its buffers.
+ **/
+tsp_status_t solve_lk(config_t const* config, solver_t* solver,
+                      double time_limit, uint64_t seed);
+
+/**
+ * Re-optimizes a previous tour after the weights of some edges changed.
+ * Like `solve_lk`, but the local search starts from `previous` and only from
+ * the `changed` nodes, and, without time limit, performs
+ * `LK_KICKS_PER_NODE * nb_changed` kicks.
+ *
+ * @param config Configuration of the problem, with its new weights.
+ * @param solver Pre-initialized solver.
+ * @param time_limit Time budget in seconds, or 0 for none.
+ * @param seed Seed of the pseudo-random kicks.
+ * @param previous Nodes of the previous tour, in order.
+ * @param changed Endpoints of the changed edges.
+ * @param nb_changed Number of changed nodes.
+ * @return `TSP_OK`, `TSP_ERR_INVALID_ARGUMENT` if the instance is asymmetric,
+ *         or `TSP_ERR_ALLOC` if the engine could not allocate its buffers.
+ **/
+tsp_status_t solve_lk_incremental(config_t const* config, solver_t* solver,
+                                  double time_limit, uint64_t seed,
+                                  size_t const* previous,
+                                  size_t const* changed, size_t nb_changed);
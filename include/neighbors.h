@@ -0,0 +1,46 @@
+/**
+ * @file    neighbors.h
+ * @brief   Declaration of the `neighbors_t` structure, holding the candidate
+ *          neighbor lists used by the heuristic engines.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "config.h"
+#include "vec.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Neighbor lists in compressed sparse row (CSR) layout: the neighbors of node
+ * `i` are `nodes[offsets[i]]` to `nodes[offsets[i + 1] - 1]`, sorted by
+ * increasing weight.
+ **/
+typedef struct neighbors_t {
+    size_t nb_nodes;
+    vec_t* offsets;
+    vec_t* nodes;
+} neighbors_t;
+
+/**
+ * Builds the lists of the `k` nearest neighbors of every node, in parallel.
+ * Euclidean instances use a k-d tree over their coordinates, in O(n log n);
+ * sparse instances scan their adjacency lists, in O(number of edges); other
+ * instances scan the adjacency matrix, in O(n²).
+ * Nodes that are not linked by an edge are never neighbors, so lists may be
+ * shorter than `k`.
+ *
+ * @param config Configuration of the TSP problem.
+ * @param k Number of neighbors per node, clamped to `nb_nodes - 1`.
+ * @return The neighbor lists, or `NULL` if the allocation failed.
+ **/
+neighbors_t* neighbors_build(config_t const* config, size_t k);
+
+/**
+ * Deallocates the neighbor lists.
+ *
+ * @param neighbors Neighbor lists to deallocate.
+ **/
+void neighbors_destroy(neighbors_t* neighbors);
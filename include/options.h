@@ -0,0 +1,53 @@
+/**
+ * @file    options.h
+ * @brief   Declaration of the `options_t` structure and its related functions.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "engine.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct options_t {
+    char const* config_file;
+    char const* socket_path;
+    size_t workers;
+    char const* cache_dir;
+    size_t cache_limit;
+    char const* previous_file;
+    char const* delta_file;
+    engine_t engine;
+    double time_limit;
+    uint64_t seed;
+    size_t threads;
+    int64_t target_cost;
+    bool perf_counters;
+    char const* events_file;
+} options_t;
+
+/**
+ * Parses the command line arguments into an `options_t` structure.
+ * Options that are not specified keep their default values (exact engine, no
+ * time limit, seed 1, as many threads as OpenMP provides, no target cost, no
+ * server, no result cache, no incremental re-solve, no performance
+ * counters, no event stream). A configuration file is required unless a
+ * server socket is given, and the previous tour and delta files of an
+ * incremental re-solve must be given together.
+ *
+ * @param options Options to fill.
+ * @param argc Number of arguments.
+ * @param argv Arguments given to the program.
+ * @return `true` if the arguments are valid, `false` otherwise.
+ **/
+bool options_parse(options_t* options, int argc, char* argv[argc + 1]);
+
+/**
+ * Prints the usage of the program to the terminal.
+ *
+ * @param program Name of the program.
+ **/
+void options_usage(char const* program);
@@ -0,0 +1,79 @@
+/**
+ * @file    pages.h
+ * @brief   Declaration of the allocator of large buffers, which backs them by
+ *          huge pages when the system provides some, so that scanning them
+ *          takes fewer TLB misses.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "vectors.h"
+
+#include <stddef.h>
+
+/**
+ * Size of a huge page. Smaller buffers are allocated on the heap, and larger
+ * ones are rounded up to a multiple of it.
+ **/
+#define PAGES_HUGE_SIZE (2UL << 20)
+
+/**
+ * Backing of a buffer allocated by `pages_alloc`: explicit huge pages from
+ * the hugetlbfs pool, transparent huge pages requested with `madvise`, or
+ * ordinary pages of the heap.
+ **/
+typedef enum pages_backing_e {
+    PAGES_HEAP,
+    PAGES_TRANSPARENT,
+    PAGES_HUGETLB,
+} pages_backing_t;
+
+/**
+ * Allocates a buffer of at least `PAGES_HUGE_SIZE` bytes on huge pages.
+ * Explicit huge pages are tried first, then a heap buffer aligned on a huge
+ * page that the kernel is advised to back by transparent huge pages. If
+ * transparent huge pages are disabled, the buffer stays on ordinary pages.
+ * Smaller buffers are always allocated on the heap.
+ *
+ * @param size Size of the buffer in bytes.
+ * @param backing Output backing actually obtained.
+ * @return The buffer, or `NULL` if the allocation failed.
+ **/
+void* pages_alloc(size_t size, pages_backing_t* backing);
+
+/**
+ * Deallocates a buffer allocated by `pages_alloc`, `NULL` is ignored.
+ *
+ * @param data Buffer to deallocate.
+ * @param size Size it was allocated with.
+ * @param backing Backing it was allocated with.
+ **/
+void pages_free(void* data, size_t size, pages_backing_t backing);
+
+/**
+ * Allocates an empty vector whose elements are allocated by `pages_alloc`.
+ * It must not grow beyond its capacity, and must be deallocated by
+ * `pages_vec_i64_drop`.
+ *
+ * @param capacity Capacity of the vector.
+ * @param backing Output backing of its elements.
+ * @return The vector, or `NULL` if the allocation failed.
+ **/
+vec_i64_t* pages_vec_i64(size_t capacity, pages_backing_t* backing);
+
+/**
+ * Deallocates a vector allocated by `pages_vec_i64`, `NULL` is ignored.
+ *
+ * @param vec Vector to deallocate.
+ * @param backing Backing of its elements.
+ **/
+void pages_vec_i64_drop(vec_i64_t* vec, pages_backing_t backing);
+
+/**
+ * Describes a backing.
+ *
+ * @param backing Backing to describe.
+ * @return Its name, as printed by `config_print`.
+ **/
+char const* pages_name(pages_backing_t backing);
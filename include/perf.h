@@ -0,0 +1,88 @@
+/**
+ * @file    perf.h
+ * @brief   Declaration of the hardware performance counters, read with the
+ *          Linux `perf_event_open` system call around each phase of a solve.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Hardware events counted in every phase.
+ **/
+typedef enum perf_counter_t {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_NB_COUNTERS,
+} perf_counter_t;
+
+/**
+ * Open counters of the thread that opened them. The work of the other
+ * threads, such as those of the OpenMP pool, is not counted. A file
+ * descriptor is -1 if its event is not supported by the CPU or the kernel.
+ **/
+typedef struct perf_t {
+    int fds[PERF_NB_COUNTERS];
+} perf_t;
+
+/**
+ * Counts of a phase, estimated from the time each counter actually ran if the
+ * kernel had to multiplex them.
+ **/
+typedef struct perf_counts_t {
+    bool valid[PERF_NB_COUNTERS];
+    uint64_t values[PERF_NB_COUNTERS];
+} perf_counts_t;
+
+/**
+ * Opens the counters of the calling thread, disabled. Events the CPU or the
+ * kernel do not support are skipped.
+ *
+ * @param perf Counters to open.
+ * @return `true` if at least one counter is available, `false` otherwise
+ *         (e.g. not running on Linux, no PMU exposed by a virtual machine, or
+ *         forbidden by `kernel.perf_event_paranoid`).
+ **/
+bool perf_open(perf_t* perf);
+
+/**
+ * Resets and enables the counters at the start of a phase.
+ *
+ * @param perf Open counters.
+ **/
+void perf_start(perf_t const* perf);
+
+/**
+ * Disables the counters at the end of a phase and reads them.
+ *
+ * @param perf Open counters.
+ * @param counts Output counts of the phase.
+ **/
+void perf_stop(perf_t const* perf, perf_counts_t* counts);
+
+/**
+ * Closes the counters.
+ *
+ * @param perf Counters to close.
+ **/
+void perf_close(perf_t* perf);
+
+/**
+ * Prints the header of the table of counts.
+ **/
+void perf_print_header(void);
+
+/**
+ * Prints the counts of a phase as a row of the table, unavailable counters
+ * being shown as `n/a`.
+ *
+ * @param phase Name of the phase.
+ * @param counts Counts of the phase.
+ **/
+void perf_print(char const* phase, perf_counts_t const* counts);
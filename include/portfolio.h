@@ -0,0 +1,46 @@
+/**
+ * @file    portfolio.h
+ * @brief   Declaration of the multi-start heuristic portfolio, racing many
+ *          randomized local search runs on a pool of threads.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "config.h"
+#include "options.h"
+#include "solver.h"
+#include "status.h"
+
+/**
+ * Number of runs per thread performed when neither a time limit nor a target
+ * cost is given.
+ **/
+#define PORTFOLIO_RUNS_PER_THREAD 2
+
+/**
+ * Races randomized construction + local search runs (see `lk.h`) on
+ * `options->threads` threads.
+ * Runs alternately start from a new tour, or from the best tour found so far
+ * by any run, which they then perturb with their own seed. New tours follow a
+ * space-filling curve on Euclidean instances (see `spacefill_order`), and are
+ * otherwise randomized nearest-neighbor tours with a random first node. Every
+ * run publishes its improvements to the shared best tour as it goes, which is
+ * stored in the solver.
+ *
+ * The portfolio stops when the time limit is reached, even during the local
+ * search of a run, when the best tour costs at most `options->target_cost`,
+ * or, if neither is set, after `PORTFOLIO_RUNS_PER_THREAD` runs per thread.
+ * Instances too small to be kicked (see `lk_perturb`) stop after their first
+ * run.
+ *
+ * @param config Configuration of the problem.
+ * @param solver Pre-initialized solver, receiving the best tour.
+ * @param options Options holding the time limit, target cost, seed and number
+ *                of threads.
+ * @return `TSP_OK`, `TSP_ERR_INVALID_ARGUMENT` if the instance is asymmetric
+ *         (see `lk_t`), or `TSP_ERR_ALLOC` if no run could allocate its
+ *         buffers.
+ **/
+tsp_status_t solve_portfolio(config_t const* config, solver_t* solver,
+                             options_t const* options);
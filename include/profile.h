@@ -0,0 +1,159 @@
+/**
+ * @file    profile.h
+ * @brief   Declaration of the per-level latency histograms of the
+ *          branch-and-bound search, compiled only when `TSP_PROFILE` is
+ *          defined (see `make profile`).
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// The search functions are instrumented with the following macros, which
+// expand to nothing unless `TSP_PROFILE` is defined:
+// - `PROFILE_BEGIN()` and `PROFILE_END(title)` start and dump the profile of
+//   a search in the calling thread.
+// - `PROFILE_ENTER(level)` and `PROFILE_EXIT(level)` delimit a node of the
+//   search tree at depth `level`.
+// - `PROFILE_PAUSE()` and `PROFILE_RESUME()` surround the recursive calls, so
+//   that a node is only charged the time of its own child loop.
+//
+// Every node is counted, but only one in `PROFILE_SAMPLE_PERIOD` nodes of a
+// level is timed, the first one included. Timing a node costs a few reads of
+// the time-stamp counter, which would otherwise be as long as the child loops
+// of the deepest levels.
+
+#ifdef TSP_PROFILE
+
+/**
+ * Number of levels with their own histogram, deeper ones share the last.
+ **/
+#define PROFILE_MAX_LEVELS 64
+
+/**
+ * Number of buckets of a histogram, bucket `b` counting the nodes that took
+ * between `2^b` and `2^(b+1)` ticks.
+ **/
+#define PROFILE_BUCKETS 48
+
+/**
+ * Sampling period of the nodes of a level, a power of 2.
+ **/
+#define PROFILE_SAMPLE_PERIOD 64
+
+typedef struct profile_level_t {
+    uint64_t nodes;
+    uint64_t sampled;
+    uint64_t ticks;
+    uint64_t buckets[PROFILE_BUCKETS];
+} profile_level_t;
+
+typedef struct profile_t {
+    profile_level_t levels[PROFILE_MAX_LEVELS];
+} profile_t;
+
+typedef struct profile_span_t {
+    profile_level_t* level;
+    uint64_t start;
+    uint64_t elapsed;
+} profile_span_t;
+
+/**
+ * Profile of the search running in the current thread, `NULL` if none. Only a
+ * pointer is thread-local so that it fits the static TLS block, whose
+ * accesses are a single load.
+ **/
+extern _Thread_local profile_t* profile_current
+    __attribute__((tls_model("initial-exec")));
+
+/**
+ * Reads the time-stamp counter, or the monotonic clock in nanoseconds on
+ * architectures without one.
+ *
+ * @return Current number of ticks.
+ **/
+uint64_t profile_ticks_slow(void);
+
+static inline uint64_t profile_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return profile_ticks_slow();
+#endif
+}
+
+static inline profile_span_t profile_enter(size_t level)
+{
+    profile_span_t span = {.level = NULL, .start = 0, .elapsed = 0};
+    if (profile_current) {
+        profile_level_t* l = &profile_current->levels[
+            level < PROFILE_MAX_LEVELS ? level : PROFILE_MAX_LEVELS - 1];
+        if ((l->nodes++ & (PROFILE_SAMPLE_PERIOD - 1)) == 0) {
+            span.level = l;
+            span.start = profile_ticks();
+        }
+    }
+    return span;
+}
+
+static inline void profile_pause(profile_span_t* span)
+{
+    if (span->level) {
+        span->elapsed += profile_ticks() - span->start;
+    }
+}
+
+static inline void profile_resume(profile_span_t* span)
+{
+    if (span->level) {
+        span->start = profile_ticks();
+    }
+}
+
+static inline void profile_exit(profile_span_t* span)
+{
+    if (span->level) {
+        uint64_t elapsed = span->elapsed + profile_ticks() - span->start;
+        size_t bucket = elapsed ? 63 - __builtin_clzll(elapsed) : 0;
+        span->level->sampled++;
+        span->level->ticks += elapsed;
+        span->level->buckets[bucket < PROFILE_BUCKETS ? bucket
+                                                      : PROFILE_BUCKETS - 1]++;
+    }
+}
+
+/**
+ * Starts profiling a search in the current thread. Profiling is disabled if
+ * the histograms could not be allocated.
+ **/
+void profile_begin(void);
+
+/**
+ * Prints the histograms of the search of the current thread on `stderr`, and
+ * stops profiling it.
+ *
+ * @param title Name of the search.
+ **/
+void profile_end(char const* title);
+
+#define PROFILE_BEGIN() profile_begin()
+#define PROFILE_END(title) profile_end(title)
+#define PROFILE_ENTER(level) profile_span_t profile_span_ = profile_enter(level)
+#define PROFILE_PAUSE() profile_pause(&profile_span_)
+#define PROFILE_RESUME() profile_resume(&profile_span_)
+#define PROFILE_EXIT(level) profile_exit(&profile_span_)
+
+#else
+
+#define PROFILE_BEGIN() ((void)0)
+#define PROFILE_END(title) ((void)0)
+#define PROFILE_ENTER(level) ((void)0)
+#define PROFILE_PAUSE() ((void)0)
+#define PROFILE_RESUME() ((void)0)
+#define PROFILE_EXIT(level) ((void)0)
+
+#endif
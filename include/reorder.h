@@ -0,0 +1,49 @@
+/**
+ * @file    reorder.h
+ * @brief   Declaration of the load-time renumbering of the nodes, which puts
+ *          the rows of the adjacency matrix that a tour visits one after the
+ *          other close together in memory.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "config.h"
+#include "status.h"
+
+#include <stddef.h>
+
+/**
+ * Instances with fewer nodes are not renumbered, their matrix being small
+ * enough for the caches.
+ **/
+#define REORDER_MIN_NODES 1000
+
+/**
+ * Renumbers the nodes of an instance in the order of a short path through
+ * them, so that nearby nodes get nearby numbers. Euclidean instances are
+ * ordered along a Hilbert curve (see `spacefill_order`), and the others by a
+ * nearest-neighbor chain over their adjacency matrix, in O(n²). Node 0 keeps
+ * its number. The adjacency matrix and the coordinates are permuted to match,
+ * in parallel, and `config->labels` receives the original number of each
+ * node.
+ *
+ * Sparse instances, instances of fewer than `REORDER_MIN_NODES` nodes and
+ * instances already renumbered are left as they are.
+ *
+ * @param config Configuration to renumber.
+ * @return `TSP_OK`, or `TSP_ERR_ALLOC`, in which case the configuration is
+ *         left as it was.
+ **/
+tsp_status_t reorder_config(config_t* config);
+
+/**
+ * Translates original node numbers to those of a renumbered instance.
+ *
+ * @param config Configuration, renumbered or not.
+ * @param nodes Nodes to translate, in place.
+ * @param nb_nodes Number of nodes.
+ * @return `TSP_OK`, or `TSP_ERR_ALLOC`.
+ **/
+tsp_status_t reorder_rename(config_t const* config, size_t* nodes,
+                            size_t nb_nodes);
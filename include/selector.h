@@ -0,0 +1,109 @@
+/**
+ * @file    selector.h
+ * @brief   Declaration of the instance features and of the rule table that
+ *          picks an engine from them for `--engine auto`.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "config.h"
+#include "options.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Number of node triples, and of edges, sampled to estimate how metric the
+ * weights are and how spread out.
+ **/
+#define SELECTOR_SAMPLES 1024
+
+/**
+ * Time limit in seconds given to the engines that only stop at a time limit,
+ * when the options have none.
+ **/
+#define SELECTOR_TIME_LIMIT 60.0
+
+/**
+ * Cheap features of an instance. `density` is the fraction of the
+ * `n * (n - 1)` directed edges that are present, `violations` the fraction
+ * of the sampled triangles whose sides violate the triangle inequality, and
+ * `spread` the coefficient of variation (standard deviation over mean) of
+ * the sampled weights.
+ **/
+typedef struct features_t {
+    size_t nb_nodes;
+    bool euclidean;
+    bool symmetric;
+    double density;
+    double violations;
+    double spread;
+} features_t;
+
+/**
+ * Engine picked for an instance, with the number of threads it runs on, its
+ * time limit (0 for none), the lower bound it proves (`NULL` for the
+ * heuristic engines) and the rule that picked it.
+ **/
+typedef struct selection_t {
+    engine_t engine;
+    size_t threads;
+    double time_limit;
+    char const* bound;
+    char const* reason;
+} selection_t;
+
+/**
+ * Computes the features of an instance. Symmetry and density scan the stored
+ * weights once, which Euclidean instances and triangular matrices skip, and
+ * the other features are estimated from `SELECTOR_SAMPLES` samples drawn
+ * with a fixed seed, so that an instance always gets the same features.
+ *
+ * @param config Configuration of the problem.
+ * @param features Output features.
+ **/
+void selector_features(config_t const* config, features_t* features);
+
+/**
+ * Picks an engine with the first rule of a table, tuned on benchmark runs,
+ * that matches the features: `little` for asymmetric instances (beyond 80
+ * nodes, only until the time limit of the options or `SELECTOR_TIME_LIMIT`
+ * if they have none), `cut` for
+ * symmetric ones as long as it solves them in seconds, which depends on
+ * their metricity, spread and density, `spacefill` for very large Euclidean
+ * ones, `genetic` up to a few thousand nodes, then `portfolio` if there are
+ * several threads, and `lk` for the largest ones.
+ *
+ * @param features Features of the instance.
+ * @param options Options of the solve, whose threads bound those of the
+ *                parallel engines (0 for all the OpenMP threads), and whose
+ *                time limit is kept.
+ * @param selection Output engine and reason.
+ **/
+void selector_pick(features_t const* features, options_t const* options,
+                     selection_t* selection);
+
+/**
+ * Replaces the `auto` engine of options with the one picked for an instance,
+ * along with its threads and time limit. Other engines are left as they
+ * are.
+ *
+ * @param config Configuration of the problem.
+ * @param options Options to resolve.
+ * @param features Output features of the instance, if the engine is `auto`.
+ * @param selection Output engine and reason, if the engine is `auto`.
+ * @return Whether the engine was `auto`.
+ **/
+bool selector_resolve(config_t const* config, options_t* options,
+                      features_t* features, selection_t* selection);
+
+/**
+ * Prints the engine picked for an instance, with the features and the rule
+ * that picked it.
+ *
+ * @param features Features of the instance.
+ * @param selection Engine picked by `selector_pick`.
+ **/
+void selector_print(features_t const* features,
+                    selection_t const* selection);
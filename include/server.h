@@ -0,0 +1,78 @@
+/**
+ * @file    server.h
+ * @brief   Declaration of the solver daemon, serving requests over a Unix
+ *          domain socket with a pool of worker threads.
+ * @author  Gabriel Dos Santos
+ *
+ * The protocol is line-based. A connection can send any number of requests:
+ *
+ *   SOLVE <TEXT|BINARY> <SIZE> [engine=E] [time=S] [seed=N] [threads=N]
+ *         [target=C]
+ *   <SIZE bytes of payload>
+ *
+ * answered by `OK <COST> <NODE_0> ... <NODE_N>` (the tour starting and ending
+ * at node 0) or `ERR <MESSAGE>`, on a single line. A `TEXT` payload is a
+ * configuration file (see `config_load`), a `BINARY` payload is the number of
+ * nodes `N` as a native `uint64_t` followed by the `N * N` native `int64_t`
+ * weights of the adjacency matrix. Unspecified options default to those of
+ * the server command line.
+ *
+ *   METRICS
+ *
+ * is answered by `name value` lines terminated by an `END` line.
+ *
+ * A connection that sends nothing for `SERVER_IDLE_TIMEOUT` seconds, or does
+ * not read its answers for as long, is closed.
+ **/
+
+#pragma once
+
+#include "options.h"
+#include "status.h"
+
+/**
+ * Number of worker threads of the server when `--workers` is not given.
+ **/
+#define SERVER_DEFAULT_WORKERS 4
+
+/**
+ * Number of nodes the solver of each worker is preallocated for.
+ **/
+#define SERVER_PREALLOC_NODES 1024
+
+/**
+ * Number of accepted connections waiting for a worker before the server stops
+ * accepting new ones.
+ **/
+#define SERVER_QUEUE_SIZE 256
+
+/**
+ * Number of parsed instances kept in memory, keyed by the hash of their
+ * payload.
+ **/
+#define SERVER_CACHE_SIZE 16
+
+/**
+ * Maximum size of a request payload, in bytes.
+ **/
+#define SERVER_MAX_PAYLOAD ((size_t)1 << 30)
+
+/**
+ * Number of seconds a connection may stay idle before the server closes it,
+ * so that idle or half-open connections do not hold a worker forever.
+ **/
+#define SERVER_IDLE_TIMEOUT 30
+
+/**
+ * Serves solving requests on a Unix domain socket until the process receives
+ * `SIGINT` or `SIGTERM`.
+ * Connections are handled by `options->workers` threads, each owning a
+ * preallocated solver. Recently used instances are cached by the hash of
+ * their payload, so repeated queries skip parsing.
+ *
+ * @param options Options holding the socket path, the number of workers and
+ *                the default solving options of the requests.
+ * @return `TSP_OK` once stopped, `TSP_ERR_IO` if the socket could not be
+ *         created or `TSP_ERR_ALLOC`.
+ **/
+tsp_status_t server_run(options_t const* options);
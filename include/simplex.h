@@ -0,0 +1,136 @@
+/**
+ * @file    simplex.h
+ * @brief   Declaration of the bounded dual simplex, which solves the linear
+ *          relaxations of the branch-and-cut engine and re-optimizes them
+ *          from their previous basis when rows are added or bounds change.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "status.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Number of pivots after which the basis inverse is recomputed from scratch,
+ * to get rid of the rounding errors its updates accumulate.
+ **/
+#define SIMPLEX_REFACTOR_INTERVAL 64
+
+/**
+ * Maximum number of pivots of a single call to `simplex_solve`.
+ **/
+#define SIMPLEX_MAX_ITERATIONS 100000
+
+/**
+ * Tolerance on the bounds of the variables and the signs of reduced costs.
+ **/
+#define SIMPLEX_TOLERANCE 1e-7
+
+/**
+ * Outcome of `simplex_solve`.
+ **/
+typedef enum simplex_status_e {
+    SIMPLEX_OPTIMAL,
+    SIMPLEX_INFEASIBLE,
+    SIMPLEX_STALLED,
+} simplex_status_t;
+
+/**
+ * Linear program `min c.x` such that `lower_row <= A.x <= upper_row` and
+ * `lower <= x <= upper`, with its current basis. The rows of `A` are stored
+ * sparse, and the inverse of the basis dense.
+ **/
+typedef struct simplex_t simplex_t;
+
+/**
+ * Allocates a linear program without rows. Its columns must have finite
+ * bounds, the cost of a column being paid at its lower bound when it is
+ * nonnegative, and at its upper bound otherwise.
+ *
+ * @param nb_columns Number of columns.
+ * @param costs Costs of the columns.
+ * @param lower Lower bounds of the columns.
+ * @param upper Upper bounds of the columns.
+ * @return The linear program, or `NULL` if the allocation failed.
+ **/
+simplex_t* simplex_init(size_t nb_columns, double const* costs,
+                        double const* lower, double const* upper);
+
+/**
+ * Deallocates a linear program, `NULL` is ignored.
+ *
+ * @param lp Linear program to deallocate.
+ **/
+void simplex_destroy(simplex_t* lp);
+
+/**
+ * Adds a row to the linear program. Its slack enters the basis, which keeps
+ * the basis dual feasible, so that the next `simplex_solve` starts from it.
+ *
+ * @param lp Linear program.
+ * @param nb_entries Number of nonzero coefficients of the row.
+ * @param columns Columns of the coefficients, in increasing order.
+ * @param values Coefficients.
+ * @param lower Lower bound of the row, or `-INFINITY`.
+ * @param upper Upper bound of the row, or `INFINITY`.
+ * @return `TSP_OK`, or `TSP_ERR_ALLOC`.
+ **/
+tsp_status_t simplex_add_row(simplex_t* lp, size_t nb_entries,
+                             size_t const* columns, double const* values,
+                             double lower, double upper);
+
+/**
+ * Changes the bounds of a column, keeping the basis.
+ *
+ * @param lp Linear program.
+ * @param column Column to bound.
+ * @param lower New lower bound.
+ * @param upper New upper bound.
+ **/
+void simplex_set_bounds(simplex_t* lp, size_t column, double lower,
+                        double upper);
+
+/**
+ * Optimizes the linear program with the dual simplex, from its current basis.
+ *
+ * @param lp Linear program.
+ * @return `SIMPLEX_OPTIMAL`, `SIMPLEX_INFEASIBLE`, or `SIMPLEX_STALLED` if
+ *         `SIMPLEX_MAX_ITERATIONS` pivots were not enough.
+ **/
+simplex_status_t simplex_solve(simplex_t* lp);
+
+/**
+ * Gives the value of the objective at the current basis.
+ *
+ * @param lp Linear program.
+ * @return Sum of the costs of the columns times their values.
+ **/
+double simplex_objective(simplex_t const* lp);
+
+/**
+ * Gives the values of the columns at the current basis.
+ *
+ * @param lp Linear program.
+ * @return Array of `nb_columns` values, valid until the next change.
+ **/
+double const* simplex_values(simplex_t const* lp);
+
+/**
+ * Gives the reduced costs of the columns at the current basis, 0 for the
+ * basic ones.
+ *
+ * @param lp Linear program.
+ * @return Array of `nb_columns` reduced costs, valid until the next change.
+ **/
+double const* simplex_reduced_costs(simplex_t const* lp);
+
+/**
+ * Gives the number of rows of the linear program.
+ *
+ * @param lp Linear program.
+ * @return Number of rows.
+ **/
+size_t simplex_nb_rows(simplex_t const* lp);
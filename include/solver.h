@@ -7,23 +7,104 @@
 #pragma once
 
 #include "config.h"
-#include "vec.h"
+#include "eliminate.h"
+#include "status.h"
+#include "vectors.h"
 
-typedef struct solver_t {
-    vec_t* visited_nodes;
-    vec_t* path_taken;
-    vec_t* optimal_path;
+typedef struct solver_t solver_t;
+
+/**
+ * Lower bound tables of the branch-and-bound algorithm: the minimum and second
+ * minimum weight of the edges leaving each node.
+ **/
+typedef struct bounds_t {
+    vec_i64_t* first;
+    vec_i64_t* second;
+} bounds_t;
+
+/**
+ * Function called every time the solver finds a better tour, which is then
+ * held in `solver->optimal_path` and `solver->minimum_cost`.
+ **/
+typedef void (*solver_incumbent_fn)(solver_t const* solver, void* data);
+
+/**
+ * Besides its buffers and solution, a solver tracks the progress of its
+ * search: the number of nodes of the search tree (or local search kicks)
+ * explored so far, and the best known lower bound of the cost of a tour
+ * (`INT64_MIN` if the engine has none). When the instance was renumbered (see
+ * `reorder.h`), `labels` borrows its original numbers, which the solution is
+ * printed and streamed with.
+ **/
+struct solver_t {
+    vec_bool_t* visited_nodes;
+    vec_i64_t* path_taken;
+    vec_i64_t* optimal_path;
     int64_t minimum_cost;
-} solver_t;
+    uint64_t nb_explored;
+    int64_t lower_bound;
+    bounds_t* bounds;
+    candidates_t* candidates;
+    solver_incumbent_fn on_incumbent;
+    void* incumbent_data;
+    vec_i64_t const* labels;
+};
 
 /**
  * Initialize the solver based on the number of nodes set in the configuration.
  * 
  * @param nb_nodes Number of nodes in the problem.
- * @return The initialized solver structure.
+ * @return The initialized solver structure, or `NULL` if the allocation
+ *         failed.
  */
 solver_t* solver_init(size_t const nb_nodes);
 
+/**
+ * Resets the solver for a new problem, reusing its buffers when they are large
+ * enough. The incumbent callback and the original numbers of the nodes are
+ * kept, the bound tables and the candidate edges are dropped, and the
+ * progress of the search is cleared.
+ *
+ * @param solver Solver to reset.
+ * @param nb_nodes Number of nodes in the new problem.
+ * @return `TSP_OK`, or `TSP_ERR_ALLOC` if the buffers could not be grown.
+ */
+tsp_status_t solver_reset(solver_t* solver, size_t const nb_nodes);
+
+/**
+ * Calls the incumbent callback of the solver, if any.
+ *
+ * @param solver Solver that found a better tour.
+ */
+void solver_notify_incumbent(solver_t const* solver);
+
+/**
+ * Computes the bound tables of a problem.
+ *
+ * @param config Configuration of the problem.
+ * @return The bound tables, or `NULL` if the allocation failed.
+ */
+bounds_t* bounds_init(config_t const* config);
+
+/**
+ * Recomputes the bound tables of some nodes, after the weights of their edges
+ * changed.
+ *
+ * @param bounds Bound tables to update.
+ * @param config Configuration of the problem, with its new weights.
+ * @param nodes Nodes whose edges changed.
+ * @param nb_nodes Number of nodes.
+ */
+void bounds_update(bounds_t* bounds, config_t const* config,
+                   size_t const* nodes, size_t nb_nodes);
+
+/**
+ * Deallocates bound tables.
+ *
+ * @param bounds Bound tables to deallocate.
+ */
+void bounds_destroy(bounds_t* bounds);
+
 /**
  * Deallocates the solver.
  * 
@@ -34,6 +115,10 @@ void solver_destroy(solver_t* solver);
 /**
  * Initialize the TSP solving algorithm and calls the branch-and-bound
  * algorithm.
+ * The bound tables of the solver are computed if it has none, and so are its
+ * candidate edges (see `candidates_init`), which are the only ones the search
+ * follows. A tour already held by the solver is used as the initial
+ * incumbent, so that only better tours are searched for.
  *
  * @param config Configuration of the problem.
  * @param solver Pre-initialized solver.
@@ -53,6 +138,19 @@ void solve_branch_and_bound(config_t const* config, solver_t* solver,
                             int64_t current_bound, int64_t current_weight,
                             size_t const level);
 
+/**
+ * Stores a tour computed by a heuristic engine as the solution of the solver,
+ * rotated to start and end at node 0, and notifies the incumbent callback. A
+ * tour going through a missing edge is not a solution and sets the cost to
+ * `INT64_MAX`.
+ *
+ * @param config Configuration of the problem.
+ * @param solver Solver to store the tour in.
+ * @param tour Nodes of the tour, in order.
+ **/
+void solver_store_tour(config_t const* config, solver_t* solver,
+                       size_t const* tour);
+
 /**
  * Prints the solution computed by the solver.
  * 
@@ -0,0 +1,65 @@
+/**
+ * @file    spacefill.h
+ * @brief   Declaration of the space-filling curve engine, which builds a tour
+ *          of a Euclidean instance in O(n log n) by visiting its nodes along
+ *          a Hilbert curve.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "config.h"
+#include "solver.h"
+#include "status.h"
+
+/**
+ * Number of bits of each coordinate once quantized on the grid the Hilbert
+ * curve goes through, so that the index of a cell fits in 32 bits.
+ **/
+#define SPACEFILL_BITS 16
+
+/**
+ * Number of neighbors per node considered by the 2-opt polish.
+ **/
+#define SPACEFILL_NEIGHBORS 8
+
+/**
+ * Longest path that a 2-opt move of the polish may reverse. Longer moves are
+ * skipped, so that on millions of nodes a move costs at most this many swaps.
+ **/
+#define SPACEFILL_MAX_REVERSAL 50000
+
+/**
+ * Sorts the nodes of a Euclidean instance along a Hilbert curve, as
+ * `solve_spacefill` does.
+ *
+ * @param config Configuration of the problem.
+ * @param tour Output array of `nb_nodes` nodes, in the order of the curve.
+ * @return `TSP_OK`, `TSP_ERR_INVALID_ARGUMENT` if the instance has no
+ *         coordinates, or `TSP_ERR_ALLOC`.
+ **/
+tsp_status_t spacefill_order(config_t const* config, size_t* tour);
+
+/**
+ * Builds a tour by sorting the nodes along a Hilbert curve.
+ * The coordinates are quantized on a `2^SPACEFILL_BITS` square grid over
+ * their bounding box, and the index of each node's cell along the curve is
+ * computed in parallel by a branch-free sequence of bit operations, which the
+ * compiler vectorizes. The nodes are then sorted by index with a parallel
+ * radix sort and visited in that order. On uniformly random nodes, such a
+ * tour costs about 40% more than an optimal one.
+ *
+ * With a time limit, the tour is then polished by 2-opt moves between
+ * `SPACEFILL_NEIGHBORS` nearest neighbors, driven by don't-look bits, until it
+ * reaches a local optimum or the time runs out, which brings it within about
+ * 20% of the optimum. The time limit does not include the construction of
+ * the neighbor lists.
+ *
+ * @param config Configuration of the problem.
+ * @param solver Pre-initialized solver, receiving the tour.
+ * @param time_limit Time budget of the polish in seconds, or 0 for none.
+ * @return `TSP_OK`, `TSP_ERR_INVALID_ARGUMENT` if the instance has no
+ *         coordinates, or `TSP_ERR_ALLOC`.
+ **/
+tsp_status_t solve_spacefill(config_t const* config, solver_t* solver,
+                             double time_limit);
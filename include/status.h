@@ -0,0 +1,25 @@
+/**
+ * @file    status.h
+ * @brief   Declaration of the status codes returned by the fallible functions
+ *          of the solver.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+typedef enum tsp_status_t {
+    TSP_OK = 0,
+    TSP_ERR_INVALID_ARGUMENT = -1,
+    TSP_ERR_ALLOC = -2,
+    TSP_ERR_IO = -3,
+    TSP_ERR_FORMAT = -4,
+    TSP_ERR_NO_TOUR = -5,
+} tsp_status_t;
+
+/**
+ * Describes a status code.
+ *
+ * @param status Status code to describe.
+ * @return Static string describing the status.
+ **/
+char const* tsp_strerror(tsp_status_t status);
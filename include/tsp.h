@@ -0,0 +1,112 @@
+/**
+ * @file    tsp.h
+ * @brief   Public API of the `libtsp` library: a reentrant entry point to the
+ *          solving engines, which reports errors with status codes and never
+ *          prints anything nor exits the process.
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "engine.h"
+#include "status.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Internal structures of the solver, only handled through pointers so that
+ * their layout is not part of the API (see `config.h`, `solver.h` and
+ * `options.h`).
+ **/
+typedef struct config_t config_t;
+typedef struct solver_t solver_t;
+typedef struct options_t options_t;
+
+/**
+ * Reusable solver buffers. A workspace can be passed to any number of
+ * successive `tsp_solve` calls to avoid allocating the solver each time, but
+ * must not be used by two calls at once.
+ **/
+typedef struct tsp_workspace_t tsp_workspace_t;
+
+/**
+ * Function called every time a better tour is found.
+ *
+ * @param cost Cost of the tour.
+ * @param tour `nb_nodes + 1` nodes of the tour, starting and ending at node 0.
+ *             Only valid during the call.
+ * @param nb_nodes Number of nodes in the problem.
+ * @param user_data `user_data` field of the options.
+ **/
+typedef void (*tsp_incumbent_fn)(int64_t cost, int64_t const* tour,
+                                 size_t nb_nodes, void* user_data);
+
+typedef struct tsp_options_t {
+    engine_t engine;
+    double time_limit;
+    uint64_t seed;
+    size_t threads;
+    int64_t target_cost;
+    tsp_incumbent_fn on_incumbent;
+    void* user_data;
+    tsp_workspace_t* workspace;
+} tsp_options_t;
+
+typedef struct tsp_result_t {
+    int64_t cost;
+    int64_t* tour;
+} tsp_result_t;
+
+/**
+ * Fills the options with their default values: exact engine, no time limit,
+ * seed 1, default number of threads, no target cost, no callback and no
+ * workspace.
+ *
+ * @param options Options to fill.
+ **/
+void tsp_options_default(tsp_options_t* options);
+
+/**
+ * Allocates an empty workspace, which grows to the largest problem it solves.
+ *
+ * @return The workspace, or `NULL` if the allocation failed.
+ **/
+tsp_workspace_t* tsp_workspace_create(void);
+
+/**
+ * Deallocates a workspace.
+ *
+ * @param workspace Workspace to deallocate.
+ **/
+void tsp_workspace_destroy(tsp_workspace_t* workspace);
+
+/**
+ * Solves a TSP instance given by its adjacency matrix.
+ * This function is reentrant: concurrent calls are safe as long as they use
+ * different workspaces (or none).
+ *
+ * @param matrix Row-major `nb_nodes * nb_nodes` adjacency matrix, a weight of
+ *               0 meaning that there is no edge. It is not copied.
+ * @param nb_nodes Number of nodes.
+ * @param options Solving options, or `NULL` for the defaults.
+ * @param result Output cost and tour. `result->tour` must be provided by the
+ *               caller and hold `nb_nodes + 1` nodes.
+ * @return `TSP_OK`, `TSP_ERR_INVALID_ARGUMENT`, `TSP_ERR_ALLOC`, or
+ *         `TSP_ERR_NO_TOUR` if the graph has no Hamiltonian cycle.
+ **/
+tsp_status_t tsp_solve(int64_t const* matrix, size_t nb_nodes,
+                       tsp_options_t const* options, tsp_result_t* result);
+
+/**
+ * Runs the engine selected in the options on a loaded configuration. This is
+ * the dispatcher shared by `tsp_solve` and the command line program. The
+ * `auto` engine runs the one `selector_resolve` picks for the instance.
+ *
+ * @param config Configuration of the problem.
+ * @param solver Pre-initialized solver, receiving the solution.
+ * @param options Options selecting and tuning the engine.
+ * @return `TSP_OK`, or the error of the engine.
+ **/
+tsp_status_t tsp_dispatch(config_t const* config, solver_t* solver,
+                          options_t const* options);
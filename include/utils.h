@@ -11,17 +11,119 @@
 #include "solver.h"
 #include "vec.h"
 
+/**
+ * Initial value of `hash_bytes`, the FNV-1a offset basis.
+ **/
+#define HASH_SEED 0xcbf29ce484222325ULL
+
+/**
+ * Computes the weight between two nodes of a Euclidean instance from their
+ * coordinates.
+ *
+ * @param config Configuration holding the coordinates.
+ * @param i First node.
+ * @param j Second node.
+ * @return Rounded distance between the nodes, at least 1 if `i != j`.
+ **/
+int64_t coord_distance(config_t const* config, size_t i, size_t j);
+
+/**
+ * Finds an edge of a sparse instance, by binary search in the adjacency list
+ * of its source.
+ *
+ * @param sparse Adjacency lists of the instance.
+ * @param i Source of the edge.
+ * @param j Target of the edge.
+ * @return Index of the edge in `targets` and `weights`, or the end of the list
+ *         of `i` if it is missing.
+ **/
+static inline size_t sparse_find(sparse_t const* sparse, size_t i, size_t j)
+{
+    int64_t const* targets = sparse->targets->data;
+    size_t const end = sparse->offsets->data[i + 1];
+    size_t low = sparse->offsets->data[i];
+    size_t high = end;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if ((size_t)targets[mid] < j) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low < end && (size_t)targets[low] == j ? low : end;
+}
+
+/**
+ * Computes the position of an entry in the adjacency matrix, which is stored
+ * row-major, or as its upper triangle if it is `triangular` (see
+ * `config_t`): row `i` then holds entries `i` to `n - 1` and starts after the
+ * `n + (n - 1) + ... + (n - i + 1)` entries of the rows above.
+ *
+ * @param config Configuration holding the adjacency matrix.
+ * @param i Row of the entry.
+ * @param j Column of the entry.
+ * @return Index of the entry in `adjacency_matrix->data`.
+ **/
+static inline size_t adj_matrix_index(config_t const* config, size_t i,
+                                      size_t j)
+{
+    size_t const n = config->nb_nodes;
+    if (!config->triangular) {
+        return i * n + j;
+    }
+    size_t const low = i < j ? i : j;
+    size_t const high = i < j ? j : i;
+    return low * n - low * (low + 1) / 2 + high;
+}
+
 /**
  * Get a particular value from the adjacency matrix.
  * This is to simplify the vector's acesses as it stores data in a single
- * dimension.
+ * dimension. It is inline so that the solvers' loops see a plain array
+ * access.
  * 
  * @param config Configuration of the TSP problem.
  * @param i X coordinate.
  * @param j Y coordinate.
  * @return Value at the target address.
  **/
-int64_t adj_matrix_get(config_t const* config, size_t i, size_t j);
+static inline int64_t adj_matrix_get(config_t const* config, size_t i,
+                                     size_t j)
+{
+    sparse_t const* sparse = config->sparse;
+    if (sparse) {
+        size_t e = sparse_find(sparse, i, j);
+        return e < (size_t)sparse->offsets->data[i + 1]
+                   ? sparse->weights->data[e]
+                   : 0;
+    }
+    if (!config->adjacency_matrix) {
+        return coord_distance(config, i, j);
+    }
+    size_t const index = adj_matrix_index(config, i, j);
+    return vec_i64_get(config->adjacency_matrix, index);
+}
+
+/**
+ * Copies the weights of the edges leaving a node, whatever the storage of the
+ * instance. A triangular matrix is read down the column of the node up to
+ * the diagonal, then along its row.
+ *
+ * @param config Configuration of the TSP problem.
+ * @param i Node whose edges are copied.
+ * @param row Output array of `nb_nodes` weights.
+ **/
+void adj_matrix_row(config_t const* config, size_t i, int64_t* row);
+
+/**
+ * Checks whether the weight of every edge is the same in both directions,
+ * which Euclidean and triangular instances are by construction.
+ *
+ * @param config Configuration of the TSP problem.
+ * @return Whether the instance is symmetric.
+ **/
+bool adj_matrix_symmetric(config_t const* config);
 
 /**
  * Gets the minimum weight in the adjacency matrix considering a given `i`
@@ -49,3 +151,29 @@ int64_t second_min(config_t const* config, size_t i);
  * @param solver Solver to copy the optimal path.
  **/
 void copy_optimal(solver_t* solver);
+
+/**
+ * Draws the next value of a pseudo-random generator.
+ *
+ * @param state State of the generator, must not be 0.
+ * @return Pseudo-random 64-bit value.
+ **/
+uint64_t rng_next(uint64_t* state);
+
+/**
+ * Reads the monotonic clock.
+ *
+ * @return Current time in seconds.
+ **/
+double wall_time(void);
+
+/**
+ * Hashes a buffer with the 64-bit FNV-1a function.
+ *
+ * @param data Buffer to hash.
+ * @param len Length of the buffer in bytes.
+ * @param seed Initial value, to chain or salt hashes (use `HASH_SEED` for
+ *             none).
+ * @return Hash of the buffer.
+ **/
+uint64_t hash_bytes(void const* data, size_t len, uint64_t seed);
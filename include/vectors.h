@@ -0,0 +1,17 @@
+/**
+ * @file    vectors.h
+ * @brief   Instantiation of the typed vectors used by the solver (see
+ *          `vec_typed.h`).
+ * @author  Gabriel Dos Santos
+ **/
+
+#pragma once
+
+#include "vec_typed.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+VEC_TYPED(int64_t, i64)
+VEC_TYPED(bool, bool)
+VEC_TYPED(double, f64)
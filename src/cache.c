@@ -0,0 +1,310 @@
+/**
+ * @file    cache.c
+ * @brief   Implementation of the persistent result cache.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "cache.h"
+#include "utils.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char CACHE_MAGIC[4] = {'T', 'S', 'P', 'C'};
+static const uint32_t CACHE_VERSION = 1;
+static const char CACHE_SUFFIX[] = ".tour";
+
+// Length of the name of a result file: 16 hexadecimal digits and the suffix
+#define CACHE_NAME_LEN (16 + sizeof(CACHE_SUFFIX) - 1)
+
+// Two independent hashes of an instance: the first names its file, the second
+// is stored inside to detect collisions
+typedef struct cache_key_t {
+    uint64_t name;
+    uint64_t check;
+} cache_key_t;
+
+typedef struct cache_header_t {
+    char magic[4];
+    uint32_t version;
+    uint64_t check;
+    uint64_t nb_nodes;
+    int64_t cost;
+} cache_header_t;
+
+typedef struct cache_file_t {
+    struct timespec mtime;
+    char name[CACHE_NAME_LEN + 1];
+} cache_file_t;
+
+static inline void cache_mix(cache_key_t* key, uint64_t word)
+{
+    key->name = (key->name ^ word) * 0x9e3779b97f4a7c15ULL;
+    key->name ^= key->name >> 29;
+    key->check = (key->check ^ word) * 0xff51afd7ed558ccdULL;
+    key->check ^= key->check >> 32;
+}
+
+// Mixes `len` words of 8 bytes into the key
+static void cache_mix_words(cache_key_t* key, void const* data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        uint64_t word;
+        memcpy(&word, (char const*)data + i * sizeof(word), sizeof(word));
+        cache_mix(key, word);
+    }
+}
+
+// Hashes the instance 8 bytes at a time, along with the options the result
+// depends on
+static cache_key_t cache_key(config_t const* config, options_t const* options)
+{
+    cache_key_t key = {.name = HASH_SEED, .check = ~HASH_SEED};
+
+    // Instances with a matrix are identified by their weights, which a delta
+    // may have changed even when they were computed from coordinates (see
+    // `delta_apply`). Sparse ones are identified by their adjacency lists,
+    // and Euclidean ones without matrix by their coordinates.
+    cache_mix(&key, config->nb_nodes);
+    cache_mix(&key, config->adjacency_matrix ? 0 : config->sparse ? 1 : 2);
+    if (config->adjacency_matrix) {
+        // Entry by entry, so that triangular matrices hash like full ones
+        for (size_t i = 0; i < config->nb_nodes; i++) {
+            for (size_t j = 0; j < config->nb_nodes; j++) {
+                cache_mix(&key, (uint64_t)adj_matrix_get(config, i, j));
+            }
+        }
+    } else if (config->sparse) {
+        sparse_t const* sparse = config->sparse;
+        cache_mix_words(&key, sparse->offsets->data, sparse->offsets->len);
+        cache_mix_words(&key, sparse->targets->data, sparse->targets->len);
+        cache_mix_words(&key, sparse->weights->data, sparse->weights->len);
+    } else {
+        cache_mix_words(&key, config->coordinates->data,
+                        config->coordinates->len);
+    }
+
+    // The exact engines always find the same optimal cost, unless a time
+    // limit stops `little`, and the approximation always builds the same tour
+    cache_mix(&key, options->engine);
+    if (options->engine != ENGINE_EXACT && options->engine != ENGINE_HYBRID &&
+        options->engine != ENGINE_CHRISTOFIDES &&
+        options->engine != ENGINE_CUT &&
+        (options->engine != ENGINE_LITTLE || options->time_limit > 0.0)) {
+        uint64_t time_limit;
+        memcpy(&time_limit, &options->time_limit, sizeof(time_limit));
+        cache_mix(&key, time_limit);
+        cache_mix(&key, options->seed);
+        cache_mix(&key, options->threads);
+        cache_mix(&key, options->target_cost);
+    }
+    return key;
+}
+
+static void cache_path(cache_t const* cache, cache_key_t key, char* path)
+{
+    snprintf(path, PATH_MAX, "%s/%016lx%s", cache->dir, key.name,
+             CACHE_SUFFIX);
+}
+
+// Locks the cache against other processes and threads, returning the file
+// descriptor to close to release the lock
+static int cache_lock(cache_t const* cache, int operation)
+{
+    char path[PATH_MAX];
+    snprintf(path, PATH_MAX, "%s/lock", cache->dir);
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+
+    int ret;
+    while ((ret = flock(fd, operation)) && errno == EINTR) {
+    }
+    if (ret) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+cache_t* cache_open(char const* dir, size_t max_entries)
+{
+    struct stat st;
+    if ((mkdir(dir, 0755) && errno != EEXIST) || stat(dir, &st) ||
+        !S_ISDIR(st.st_mode) || strlen(dir) + CACHE_NAME_LEN + 2 > PATH_MAX) {
+        return NULL;
+    }
+
+    cache_t* cache = malloc(sizeof(cache_t));
+    if (!cache) {
+        return NULL;
+    }
+    cache->dir = strdup(dir);
+    cache->max_entries = max_entries;
+    if (!cache->dir) {
+        free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+void cache_close(cache_t* cache)
+{
+    if (cache) {
+        free(cache->dir);
+        free(cache);
+    }
+}
+
+bool cache_lookup(cache_t const* cache, config_t const* config,
+                  options_t const* options, solver_t* solver)
+{
+    cache_key_t key = cache_key(config, options);
+    char path[PATH_MAX];
+    cache_path(cache, key, path);
+
+    int lock = cache_lock(cache, LOCK_SH);
+    if (lock < 0) {
+        return false;
+    }
+
+    size_t const n = config->nb_nodes;
+    bool hit = false;
+    cache_header_t header;
+    FILE* fp = fopen(path, "rb");
+    if (fp && fread(&header, sizeof(header), 1, fp) == 1 &&
+        !memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) &&
+        header.version == CACHE_VERSION && header.check == key.check &&
+        header.nb_nodes == n &&
+        fread(solver->optimal_path->data, sizeof(int64_t), n + 1, fp) ==
+            n + 1) {
+        solver->minimum_cost = header.cost;
+        hit = true;
+        // Refresh the result for the least recently used eviction
+        utimensat(AT_FDCWD, path, NULL, 0);
+    }
+    if (fp) {
+        fclose(fp);
+    }
+    close(lock);
+
+    if (hit) {
+        solver_notify_incumbent(solver);
+    }
+    return hit;
+}
+
+static int cache_file_compare(void const* a, void const* b)
+{
+    struct timespec const* x = &((cache_file_t const*)a)->mtime;
+    struct timespec const* y = &((cache_file_t const*)b)->mtime;
+    if (x->tv_sec != y->tv_sec) {
+        return x->tv_sec < y->tv_sec ? -1 : 1;
+    }
+    return (x->tv_nsec > y->tv_nsec) - (x->tv_nsec < y->tv_nsec);
+}
+
+// Removes the least recently used results until at most `max_entries` are
+// left. The caller must hold the exclusive lock.
+static void cache_evict(cache_t const* cache)
+{
+    DIR* dir = opendir(cache->dir);
+    if (!dir) {
+        return;
+    }
+
+    size_t len = 0;
+    size_t capacity = 0;
+    cache_file_t* files = NULL;
+    struct dirent* entry;
+    while ((entry = readdir(dir))) {
+        size_t name_len = strlen(entry->d_name);
+        struct stat st;
+        if (name_len != CACHE_NAME_LEN ||
+            strcmp(entry->d_name + 16, CACHE_SUFFIX) ||
+            fstatat(dirfd(dir), entry->d_name, &st, 0)) {
+            continue;
+        }
+        if (len == capacity) {
+            capacity = capacity ? 2 * capacity : 64;
+            cache_file_t* grown = realloc(files, capacity * sizeof(*files));
+            if (!grown) {
+                break;
+            }
+            files = grown;
+        }
+        files[len].mtime = st.st_mtim;
+        memcpy(files[len].name, entry->d_name, CACHE_NAME_LEN + 1);
+        len++;
+    }
+
+    if (len > cache->max_entries) {
+        qsort(files, len, sizeof(*files), cache_file_compare);
+        for (size_t i = 0; i < len - cache->max_entries; i++) {
+            unlinkat(dirfd(dir), files[i].name, 0);
+        }
+    }
+    free(files);
+    closedir(dir);
+}
+
+tsp_status_t cache_store(cache_t const* cache, config_t const* config,
+                         options_t const* options, solver_t const* solver)
+{
+    cache_key_t key = cache_key(config, options);
+    char path[PATH_MAX];
+    char tmp[PATH_MAX];
+    cache_path(cache, key, path);
+    snprintf(tmp, PATH_MAX, "%s/.tmp.XXXXXX", cache->dir);
+
+    // Write a temporary file first, which is renamed once complete
+    int fd = mkstemp(tmp);
+    if (fd < 0) {
+        return TSP_ERR_IO;
+    }
+    fchmod(fd, 0644);
+    FILE* fp = fdopen(fd, "wb");
+    if (!fp) {
+        close(fd);
+        unlink(tmp);
+        return TSP_ERR_ALLOC;
+    }
+
+    size_t const n = config->nb_nodes;
+    cache_header_t header = {
+        .version = CACHE_VERSION,
+        .check = key.check,
+        .nb_nodes = n,
+        .cost = solver->minimum_cost,
+    };
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    bool written = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                   fwrite(solver->optimal_path->data, sizeof(int64_t), n + 1,
+                          fp) == n + 1;
+    if (fclose(fp) || !written) {
+        unlink(tmp);
+        return TSP_ERR_IO;
+    }
+
+    int lock = cache_lock(cache, LOCK_EX);
+    if (lock < 0 || rename(tmp, path)) {
+        if (lock >= 0) {
+            close(lock);
+        }
+        unlink(tmp);
+        return TSP_ERR_IO;
+    }
+    cache_evict(cache);
+    close(lock);
+    return TSP_OK;
+}
@@ -0,0 +1,423 @@
+/**
+ * @file    christofides.c
+ * @brief   Implementation of the Christofides approximation engine.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "christofides.h"
+#include "utils.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Fills `row` with the weights of the edges leaving `u`. Euclidean instances
+// compute their distances like `coord_distance`, but inline, rather than
+// walking down the column of their triangular matrix.
+static void christofides_row(config_t const* config, size_t u, int64_t* row)
+{
+    if (!config->coordinates) {
+        adj_matrix_row(config, u, row);
+        return;
+    }
+
+    size_t const n = config->nb_nodes;
+    double const* coords = config->coordinates->data;
+    double const x = coords[2 * u];
+    double const y = coords[2 * u + 1];
+    for (size_t v = 0; v < n; v++) {
+        double dx = x - coords[2 * v];
+        double dy = y - coords[2 * v + 1];
+        int64_t d = (int64_t)(sqrt(dx * dx + dy * dy) + 0.5);
+        row[v] = d ? d : 1;
+    }
+    row[u] = 0;
+}
+
+// The tour needs a symmetric and complete instance
+static bool christofides_check(config_t const* config)
+{
+    size_t const n = config->nb_nodes;
+    if (config->coordinates) {
+        return true;
+    }
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < i; j++) {
+            int64_t w = adj_matrix_get(config, i, j);
+            if (w <= 0 || w != adj_matrix_get(config, j, i)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Checks the triangle inequality on every triple of nodes, in O(n³) on a
+// copy of the matrix. Rounded Euclidean distances may violate it too.
+static tsp_status_t christofides_metric(config_t const* config, bool* metric)
+{
+    size_t const n = config->nb_nodes;
+    int64_t* matrix = malloc(n * n * sizeof(int64_t));
+    if (!matrix) {
+        return TSP_ERR_ALLOC;
+    }
+    for (size_t i = 0; i < n; i++) {
+        christofides_row(config, i, &matrix[i * n]);
+    }
+
+    bool violated = false;
+    for (size_t i = 0; i < n && !violated; i++) {
+        int64_t const* row_i = &matrix[i * n];
+        for (size_t j = 0; j < n; j++) {
+            int64_t const* row_j = &matrix[j * n];
+            int64_t const w = row_i[j];
+#pragma omp simd reduction(| : violated)
+            for (size_t k = 0; k < n; k++) {
+                violated |= row_i[k] > w + row_j[k];
+            }
+        }
+    }
+
+    free(matrix);
+    *metric = !violated;
+    return TSP_OK;
+}
+
+// Prim's algorithm in O(n²): `parent[v]` receives the parent of `v` in the
+// tree rooted at 0. Nodes already in the tree have a `blocked` mask of all
+// ones but the sign bit, so that the scan of a row only takes minimums.
+static int64_t christofides_mst(config_t const* config, int64_t* parent,
+                                int64_t* key, int64_t* blocked, int64_t* row)
+{
+    size_t const n = config->nb_nodes;
+    for (size_t v = 0; v < n; v++) {
+        key[v] = INT64_MAX;
+        blocked[v] = 0;
+        parent[v] = 0;
+    }
+
+    int64_t weight = 0;
+    size_t u = 0;
+    for (size_t k = 1; k < n; k++) {
+        blocked[u] = INT64_MAX;
+        key[u] = INT64_MAX;
+        christofides_row(config, u, row);
+
+        int64_t best = INT64_MAX;
+#pragma omp simd reduction(min : best)
+        for (size_t v = 0; v < n; v++) {
+            int64_t w = row[v] | blocked[v];
+            bool closer = w < key[v];
+            parent[v] = closer ? (int64_t)u : parent[v];
+            key[v] = closer ? w : key[v];
+            best = key[v] < best ? key[v] : best;
+        }
+
+        size_t next = 0;
+        while (key[next] != best) {
+            next++;
+        }
+        weight += best;
+        u = next;
+    }
+    return weight;
+}
+
+// Minimum-weight perfect matching of the `k` nodes of `odd` by dynamic
+// programming over the subsets of unmatched nodes, the lowest of which is
+// matched first. Returns `INT64_MAX` if the tables could not be allocated.
+static int64_t christofides_match_exact(config_t const* config,
+                                        size_t const* odd, size_t k,
+                                        size_t* mate)
+{
+    size_t const full = ((size_t)1 << k) - 1;
+    int64_t* cost = malloc((full + 1) * sizeof(int64_t));
+    uint8_t* pair = malloc((full + 1) * sizeof(uint8_t));
+    if (!cost || !pair) {
+        free(cost);
+        free(pair);
+        return INT64_MAX;
+    }
+
+    // `cost[m]` is the cheapest matching of the nodes not in `m`
+    cost[full] = 0;
+    for (size_t m = full; m-- > 0;) {
+        cost[m] = INT64_MAX;
+        if (__builtin_popcountll(m) % 2) {
+            continue;
+        }
+        size_t const i = __builtin_ctzll(~m);
+        for (size_t j = i + 1; j < k; j++) {
+            if ((m >> j) & 1) {
+                continue;
+            }
+            size_t const next = m | (size_t)1 << i | (size_t)1 << j;
+            int64_t c = adj_matrix_get(config, odd[i], odd[j]) + cost[next];
+            if (c < cost[m]) {
+                cost[m] = c;
+                pair[m] = j;
+            }
+        }
+    }
+
+    for (size_t m = 0; m != full;) {
+        size_t const i = __builtin_ctzll(~m);
+        size_t const j = pair[m];
+        mate[odd[i]] = odd[j];
+        mate[odd[j]] = odd[i];
+        m |= (size_t)1 << i | (size_t)1 << j;
+    }
+
+    int64_t weight = cost[0];
+    free(cost);
+    free(pair);
+    return weight;
+}
+
+// Candidate pair of the greedy matching
+typedef struct christofides_pair_t {
+    int64_t weight;
+    size_t i;
+    size_t j;
+} christofides_pair_t;
+
+static int christofides_compare_pairs(void const* a, void const* b)
+{
+    christofides_pair_t const* x = a;
+    christofides_pair_t const* y = b;
+    return (x->weight > y->weight) - (x->weight < y->weight);
+}
+
+// Greedy matching: the pairs of each node with its
+// `CHRISTOFIDES_GREEDY_CANDIDATES` nearest nodes are taken by increasing
+// weight while both of their nodes are unmatched, then every node left is
+// paired with its nearest unmatched node. Returns `INT64_MAX` if the pairs
+// could not be allocated.
+static int64_t christofides_match_greedy(config_t const* config,
+                                         size_t const* odd, size_t k,
+                                         size_t* mate, int64_t* row)
+{
+    size_t const n = config->nb_nodes;
+    size_t const c = k - 1 < CHRISTOFIDES_GREEDY_CANDIDATES
+                         ? k - 1
+                         : CHRISTOFIDES_GREEDY_CANDIDATES;
+    christofides_pair_t* pairs = malloc(k * c * sizeof(christofides_pair_t));
+    if (!pairs) {
+        return INT64_MAX;
+    }
+
+    // Nearest nodes of each node, kept sorted by an insertion sort
+    size_t len = 0;
+    for (size_t i = 0; i < k; i++) {
+        christofides_row(config, odd[i], row);
+        christofides_pair_t* nearest = pairs + len;
+        size_t count = 0;
+        for (size_t j = 0; j < k; j++) {
+            int64_t w = row[odd[j]];
+            if (j == i || (count == c && w >= nearest[c - 1].weight)) {
+                continue;
+            }
+            size_t p = count < c ? count++ : c - 1;
+            for (; p > 0 && nearest[p - 1].weight > w; p--) {
+                nearest[p] = nearest[p - 1];
+            }
+            nearest[p] = (christofides_pair_t){.weight = w, .i = i, .j = j};
+        }
+        len += count;
+    }
+    qsort(pairs, len, sizeof(christofides_pair_t), christofides_compare_pairs);
+
+    int64_t weight = 0;
+    for (size_t p = 0; p < len; p++) {
+        size_t const a = odd[pairs[p].i];
+        size_t const b = odd[pairs[p].j];
+        if (mate[a] == n && mate[b] == n) {
+            mate[a] = b;
+            mate[b] = a;
+            weight += pairs[p].weight;
+        }
+    }
+    free(pairs);
+
+    for (size_t i = 0; i < k; i++) {
+        if (mate[odd[i]] != n) {
+            continue;
+        }
+        christofides_row(config, odd[i], row);
+        size_t best = k;
+        for (size_t j = i + 1; j < k; j++) {
+            if (mate[odd[j]] == n &&
+                (best == k || row[odd[j]] < row[odd[best]])) {
+                best = j;
+            }
+        }
+        mate[odd[i]] = odd[best];
+        mate[odd[best]] = odd[i];
+        weight += row[odd[best]];
+    }
+    return weight;
+}
+
+// Follows an Eulerian circuit of the tree plus the matching from node 0 and
+// lists the nodes in the order of their first visit
+static void christofides_tour(size_t n, int64_t const* parent,
+                              size_t const* mate, size_t* tour)
+{
+    // Adjacency lists of the multigraph, each of its less than `2 * n` edges
+    // being listed at both ends with the same index
+    size_t* offsets = calloc(n + 1, sizeof(size_t));
+    size_t* targets = malloc(4 * n * sizeof(size_t));
+    size_t* ids = malloc(4 * n * sizeof(size_t));
+    bool* used = calloc(2 * n, sizeof(bool));
+    size_t* next = malloc(n * sizeof(size_t));
+    size_t* stack = malloc(2 * n * sizeof(size_t));
+    bool* seen = calloc(n, sizeof(bool));
+    if (!offsets || !targets || !ids || !used || !next || !stack || !seen) {
+        // Fall back to the identity tour
+        for (size_t v = 0; v < n; v++) {
+            tour[v] = v;
+        }
+        goto done;
+    }
+
+    for (size_t v = 1; v < n; v++) {
+        offsets[v + 1]++;
+        offsets[parent[v] + 1]++;
+    }
+    for (size_t v = 0; v < n; v++) {
+        if (mate[v] != n && v < mate[v]) {
+            offsets[v + 1]++;
+            offsets[mate[v] + 1]++;
+        }
+    }
+    for (size_t v = 0; v < n; v++) {
+        offsets[v + 1] += offsets[v];
+        next[v] = offsets[v];
+    }
+    size_t edge = 0;
+    for (size_t v = 0; v < 2 * n; v++) {
+        size_t const a = v % n;
+        size_t const b = v < n ? (size_t)parent[a] : mate[a];
+        if (v < n ? a == 0 : b == n || b < a) {
+            continue;
+        }
+        targets[next[a]] = b;
+        ids[next[a]++] = edge;
+        targets[next[b]] = a;
+        ids[next[b]++] = edge;
+        edge++;
+    }
+    for (size_t v = 0; v < n; v++) {
+        next[v] = offsets[v];
+    }
+
+    // Hierholzer's algorithm, shortcutting the nodes already visited
+    size_t len = 0;
+    size_t top = 0;
+    stack[top++] = 0;
+    while (top) {
+        size_t const v = stack[top - 1];
+        while (next[v] < offsets[v + 1] && used[ids[next[v]]]) {
+            next[v]++;
+        }
+        if (next[v] == offsets[v + 1]) {
+            top--;
+            if (!seen[v]) {
+                seen[v] = true;
+                tour[len++] = v;
+            }
+            continue;
+        }
+        used[ids[next[v]]] = true;
+        stack[top++] = targets[next[v]];
+    }
+
+done:
+    free(offsets);
+    free(targets);
+    free(ids);
+    free(used);
+    free(next);
+    free(stack);
+    free(seen);
+}
+
+tsp_status_t solve_christofides(config_t const* config, solver_t* solver)
+{
+    size_t const n = config->nb_nodes;
+    if (!christofides_check(config)) {
+        return TSP_ERR_INVALID_ARGUMENT;
+    }
+    if (n < 3) {
+        size_t tour[2] = {0, 1};
+        solver_store_tour(config, solver, tour);
+        solver->lower_bound = solver->minimum_cost;
+        return TSP_OK;
+    }
+
+    int64_t* parent = malloc(n * sizeof(int64_t));
+    int64_t* key = malloc(n * sizeof(int64_t));
+    int64_t* blocked = malloc(n * sizeof(int64_t));
+    int64_t* row = malloc(n * sizeof(int64_t));
+    size_t* degree = calloc(n, sizeof(size_t));
+    size_t* odd = malloc(n * sizeof(size_t));
+    size_t* mate = malloc(n * sizeof(size_t));
+    size_t* tour = malloc(n * sizeof(size_t));
+    tsp_status_t status = TSP_ERR_ALLOC;
+    if (!parent || !key || !blocked || !row || !degree || !odd || !mate ||
+        !tour) {
+        goto done;
+    }
+
+    int64_t const tree = christofides_mst(config, parent, key, blocked, row);
+    for (size_t v = 1; v < n; v++) {
+        degree[v]++;
+        degree[parent[v]]++;
+    }
+    size_t k = 0;
+    for (size_t v = 0; v < n; v++) {
+        mate[v] = n;
+        if (degree[v] % 2) {
+            odd[k++] = v;
+        }
+    }
+
+    int64_t matching = INT64_MAX;
+    if (k <= CHRISTOFIDES_EXACT_MATCHING) {
+        matching = christofides_match_exact(config, odd, k, mate);
+    }
+    bool const exact = matching != INT64_MAX;
+    if (!exact) {
+        matching = christofides_match_greedy(config, odd, k, mate, row);
+    }
+    if (matching == INT64_MAX) {
+        goto done;
+    }
+
+    christofides_tour(n, parent, mate, tour);
+    solver_store_tour(config, solver, tour);
+
+    // Twice the matching only bounds the optimum under the triangle
+    // inequality, the spanning tree always does
+    bool metric = false;
+    if (exact && 2 * matching > tree && n <= CHRISTOFIDES_METRIC_CHECK) {
+        status = christofides_metric(config, &metric);
+        if (status != TSP_OK) {
+            goto done;
+        }
+    }
+    solver->lower_bound = metric ? 2 * matching : tree;
+    status = TSP_OK;
+
+done:
+    free(parent);
+    free(key);
+    free(blocked);
+    free(row);
+    free(degree);
+    free(odd);
+    free(mate);
+    free(tour);
+    return status;
+}
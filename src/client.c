@@ -0,0 +1,211 @@
+/**
+ * @file    client.c
+ * @brief   Small client of the solver daemon (see `server.h`), sending a
+ *          configuration file and printing the answer.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "config.h"
+#include "status.h"
+#include "utils.h"
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static void client_usage(char const* program)
+{
+    printf("Usage: %s [OPTIONS] <SOCKET> <CONFIG_FILE> [KEY=VALUE...]\n"
+           "       %s --metrics <SOCKET>\n"
+           "\n"
+           "Request options (KEY=VALUE): engine, time, seed, threads, target\n"
+           "\n"
+           "Options:\n"
+           "  -b, --binary        Send the adjacency matrix in binary form\n"
+           "  -r, --repeat <N>    Send the request N times\n"
+           "  -m, --metrics       Print the metrics of the server\n"
+           "  -h, --help          Print this message\n",
+           program, program);
+}
+
+static int client_connect(char const* path)
+{
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr*)&addr, sizeof(addr))) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Reads a whole configuration file
+static char* client_read_text(char const* filename, size_t* size)
+{
+    FILE* fp = fopen(filename, "r");
+    if (!fp) {
+        return NULL;
+    }
+
+    size_t capacity = 4096;
+    char* payload = malloc(capacity);
+    *size = 0;
+    size_t read;
+    while (payload &&
+           (read = fread(payload + *size, 1, capacity - *size, fp)) > 0) {
+        *size += read;
+        if (*size == capacity) {
+            capacity *= 2;
+            char* grown = realloc(payload, capacity);
+            if (!grown) {
+                free(payload);
+            }
+            payload = grown;
+        }
+    }
+    fclose(fp);
+    return payload;
+}
+
+// Loads a configuration file and encodes its adjacency matrix
+static char* client_read_binary(char const* filename, size_t* size)
+{
+    config_t* config;
+    if (config_load(filename, &config) != TSP_OK) {
+        return NULL;
+    }
+
+    // Sparse instances are sent as their full matrix
+    uint64_t n = config->nb_nodes;
+    char* payload = NULL;
+    if (config->adjacency_matrix ||
+        (config->sparse && n <= CONFIG_DENSE_LIMIT)) {
+        *size = sizeof(n) + n * n * sizeof(int64_t);
+        payload = malloc(*size);
+    }
+    if (payload) {
+        memcpy(payload, &n, sizeof(n));
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                int64_t w = adj_matrix_get(config, i, j);
+                memcpy(payload + sizeof(n) + (i * n + j) * sizeof(w), &w,
+                       sizeof(w));
+            }
+        }
+    }
+    config_destroy(config);
+    return payload;
+}
+
+int main(int argc, char* argv[argc + 1])
+{
+    static struct option const long_options[] = {
+        {"binary", no_argument, NULL, 'b'},
+        {"repeat", required_argument, NULL, 'r'},
+        {"metrics", no_argument, NULL, 'm'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    bool binary = false;
+    bool metrics = false;
+    size_t repeat = 1;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "br:mh", long_options, NULL)) !=
+           -1) {
+        switch (opt) {
+        case 'b':
+            binary = true;
+            break;
+        case 'r':
+            repeat = strtoull(optarg, NULL, 10);
+            break;
+        case 'm':
+            metrics = true;
+            break;
+        default:
+            return client_usage(argv[0]), 1;
+        }
+    }
+    if (!repeat || optind >= argc || (!metrics && optind + 1 >= argc)) {
+        return client_usage(argv[0]), 1;
+    }
+
+    char const* socket_path = argv[optind];
+    int fd = client_connect(socket_path);
+    FILE* in = fd >= 0 ? fdopen(fd, "r") : NULL;
+    FILE* out = in ? fdopen(dup(fd), "w") : NULL;
+    if (!out) {
+        fprintf(stderr, "\033[1;31merror:\033[0m cannot connect to `%s`\n",
+                socket_path);
+        return 1;
+    }
+
+    char* line = NULL;
+    size_t capacity = 0;
+    int ret = 0;
+    if (metrics) {
+        fprintf(out, "METRICS\n");
+        fflush(out);
+        while (getline(&line, &capacity, in) > 0 && strcmp(line, "END\n")) {
+            fputs(line, stdout);
+        }
+    } else {
+        char const* filename = argv[optind + 1];
+        size_t size = 0;
+        char* payload = binary ? client_read_binary(filename, &size)
+                               : client_read_text(filename, &size);
+        if (!payload) {
+            fprintf(stderr, "\033[1;31merror:\033[0m failed to read `%s`\n",
+                    filename);
+            return 1;
+        }
+
+        double start = wall_time();
+        for (size_t r = 0; r < repeat && !ret; r++) {
+            fprintf(out, "SOLVE %s %zu", binary ? "BINARY" : "TEXT", size);
+            for (int i = optind + 2; i < argc; i++) {
+                fprintf(out, " %s", argv[i]);
+            }
+            fprintf(out, "\n");
+            fwrite(payload, 1, size, out);
+            fflush(out);
+
+            if (getline(&line, &capacity, in) <= 0) {
+                if (line) {
+                    line[0] = '\0';
+                }
+                fprintf(stderr, "\033[1;31merror:\033[0m connection closed\n");
+                ret = 1;
+            } else if (strncmp(line, "OK", 2)) {
+                ret = 1;
+            }
+        }
+        double elapsed = wall_time() - start;
+
+        if (line) {
+            fputs(line, stdout);
+        }
+        if (repeat > 1) {
+            fprintf(stderr, "%zu requests in %.3lfs (%.1lf requests/s)\n",
+                    repeat, elapsed, repeat / elapsed);
+        }
+        free(payload);
+    }
+
+    free(line);
+    fclose(out);
+    fclose(in);
+    return ret;
+}
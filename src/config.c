@@ -10,72 +10,496 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 static const uint16_t BUFFER_LEN = 4096;
 
-config_t* config_load(char const* filename)
+// Reads the `x y` lines of a Euclidean instance and materializes its adjacency
+// matrix when it is small enough.
+static tsp_status_t config_load_coordinates(config_t* config, FILE* fp)
 {
-    if (!filename) {
-        return NULL;
+    config->coordinates = vec_f64_with_capacity(2 * config->nb_nodes);
+    if (!config->coordinates) {
+        return TSP_ERR_ALLOC;
     }
 
-    FILE* fp = fopen(filename, "r");
-    if (!fp) {
+    char buf[BUFFER_LEN];
+    size_t i = 0;
+    while (fgets(buf, BUFFER_LEN, fp)) {
+        // Skip blank lines
+        if (!buf[strspn(buf, " \t\r\n")]) {
+            continue;
+        }
+        double x, y;
+        if (sscanf(buf, "%lf %lf", &x, &y) != 2) {
+            return TSP_ERR_FORMAT;
+        }
+        // Too many lines in the config file
+        if (++i > config->nb_nodes) {
+            return TSP_ERR_FORMAT;
+        }
+        if (!vec_f64_push(config->coordinates, x) ||
+            !vec_f64_push(config->coordinates, y)) {
+            return TSP_ERR_ALLOC;
+        }
+    }
+    if (i < config->nb_nodes) {
+        return TSP_ERR_FORMAT;
+    }
+
+    if (config->nb_nodes > CONFIG_DENSE_LIMIT) {
+        return TSP_OK;
+    }
+
+    // Distances are symmetric, only the upper triangle is computed
+    size_t const n = config->nb_nodes;
+    vec_i64_t* matrix =
+        pages_vec_i64(n * (n + 1) / 2, &config->matrix_backing);
+    if (!matrix) {
+        return TSP_ERR_ALLOC;
+    }
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i; j < n; j++) {
+            vec_i64_push(matrix, coord_distance(config, i, j));
+        }
+    }
+    config->adjacency_matrix = matrix;
+    config->triangular = true;
+    return TSP_OK;
+}
+
+static bool config_symmetric(int64_t const* matrix, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i + 1; j < n; j++) {
+            if (matrix[i * n + j] != matrix[j * n + i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Copies the upper triangle of a symmetric row-major matrix
+static vec_i64_t* config_pack(int64_t const* matrix, size_t n,
+                              pages_backing_t* backing)
+{
+    vec_i64_t* packed = pages_vec_i64(n * (n + 1) / 2, backing);
+    if (!packed) {
         return NULL;
     }
+    for (size_t i = 0; i < n; i++) {
+        memcpy(&packed->data[packed->len], &matrix[i * n + i],
+               (n - i) * sizeof(int64_t));
+        packed->len += n - i;
+    }
+    return packed;
+}
 
-    config_t* config = malloc(sizeof(config_t));
-    if (!config) {
-        fclose(fp);
+// Rest of a stream, mapped if it is a regular file and read otherwise
+typedef struct config_text_t {
+    char const* data;
+    size_t len;
+    void* mapping;
+    size_t mapping_len;
+} config_text_t;
+
+static tsp_status_t config_text_read(config_text_t* text, FILE* fp)
+{
+    *text = (config_text_t){0};
+    struct stat st;
+    int const fd = fileno(fp);
+    long const offset = ftell(fp);
+    if (fd >= 0 && offset >= 0 && !fstat(fd, &st) && S_ISREG(st.st_mode) &&
+        st.st_size > offset) {
+        void* mapping =
+            mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            text->mapping = mapping;
+            text->mapping_len = (size_t)st.st_size;
+            text->data = (char const*)mapping + offset;
+            text->len = (size_t)(st.st_size - offset);
+            return TSP_OK;
+        }
+    }
+
+    // Memory streams and pipes are read until their end
+    size_t capacity = BUFFER_LEN;
+    char* data = malloc(capacity);
+    size_t len = 0;
+    size_t read;
+    while (data && (read = fread(data + len, 1, capacity - len, fp))) {
+        len += read;
+        if (len == capacity) {
+            capacity *= 2;
+            char* grown = realloc(data, capacity);
+            if (!grown) {
+                free(data);
+            }
+            data = grown;
+        }
+    }
+    if (!data) {
+        return TSP_ERR_ALLOC;
+    }
+    text->data = data;
+    text->len = len;
+    return TSP_OK;
+}
+
+static void config_text_release(config_text_t* text)
+{
+    if (text->mapping) {
+        munmap(text->mapping, text->mapping_len);
+    } else {
+        free((char*)text->data);
+    }
+}
+
+static inline bool config_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// End of the line starting at `p`, on its newline or at `end`
+static inline char const* config_line_end(char const* p, char const* end)
+{
+    char const* eol = memchr(p, '\n', (size_t)(end - p));
+    return eol ? eol : end;
+}
+
+static inline bool config_blank(char const* p, char const* eol)
+{
+    while (p < eol && config_space(*p)) {
+        p++;
+    }
+    return p == eol;
+}
+
+// Parses an integer followed by a space or the end of the line, returns the
+// end of the integer or `NULL` if there is none
+static char const* config_parse_i64(char const* p, char const* eol,
+                                    int64_t* value)
+{
+    while (p < eol && config_space(*p)) {
+        p++;
+    }
+    bool const negative = p < eol && *p == '-';
+    if (p < eol && (*p == '-' || *p == '+')) {
+        p++;
+    }
+    if (p == eol || *p < '0' || *p > '9') {
         return NULL;
     }
+    uint64_t v = 0;
+    for (; p < eol && *p >= '0' && *p <= '9'; p++) {
+        uint64_t const digit = (uint64_t)(*p - '0');
+        if (v > (INT64_MAX - digit) / 10) {
+            return NULL;
+        }
+        v = 10 * v + digit;
+    }
+    if (p < eol && !config_space(*p)) {
+        return NULL;
+    }
+    *value = negative ? -(int64_t)v : (int64_t)v;
+    return p;
+}
+
+// Parses the rows of a chunk, starting at row `row`, straight into the
+// matrix. Each one must hold exactly `n` integers.
+static bool config_parse_rows(char const* p, char const* end, size_t row,
+                              size_t n, int64_t* matrix)
+{
+    while (p < end) {
+        char const* eol = config_line_end(p, end);
+        if (!config_blank(p, eol)) {
+            int64_t* values = &matrix[row++ * n];
+            for (size_t j = 0; j < n; j++) {
+                p = config_parse_i64(p, eol, &values[j]);
+                if (!p) {
+                    return false;
+                }
+            }
+            if (!config_blank(p, eol)) {
+                return false;
+            }
+        }
+        p = eol + (eol < end);
+    }
+    return true;
+}
+
+// Reads the rows of the adjacency matrix. The text is cut into chunks at line
+// boundaries, whose rows are counted, then parsed, on all the threads: the
+// counts give the row each chunk starts at.
+static tsp_status_t config_load_matrix(config_t* config, FILE* fp)
+{
+    size_t const n = config->nb_nodes;
+    config->adjacency_matrix = pages_vec_i64(n * n, &config->matrix_backing);
+    if (!config->adjacency_matrix) {
+        return TSP_ERR_ALLOC;
+    }
+    config_text_t text;
+    tsp_status_t status = config_text_read(&text, fp);
+    if (status != TSP_OK) {
+        return status;
+    }
+
+    char const* const end = text.data + text.len;
+    size_t const nb_chunks = text.len / CONFIG_PARSE_CHUNK + 1;
+    char const** starts = malloc((nb_chunks + 1) * sizeof(char const*));
+    size_t* rows = malloc((nb_chunks + 1) * sizeof(size_t));
+    if (!starts || !rows) {
+        free(starts);
+        free(rows);
+        config_text_release(&text);
+        return TSP_ERR_ALLOC;
+    }
+    starts[0] = text.data;
+    starts[nb_chunks] = end;
+    rows[0] = 0;
+
+#pragma omp parallel for schedule(dynamic)
+    for (size_t c = 0; c < nb_chunks; c++) {
+        // A chunk starts at the first line that starts in its bytes, and may
+        // have none
+        char const* p = text.data + c * CONFIG_PARSE_CHUNK;
+        if (c && p[-1] != '\n') {
+            p = config_line_end(p, end);
+            p += p < end;
+        }
+        starts[c] = c ? p : text.data;
+        char const* const last = text.data + (c + 1) * CONFIG_PARSE_CHUNK;
+        size_t count = 0;
+        while (p < end && p < last) {
+            char const* eol = config_line_end(p, end);
+            count += !config_blank(p, eol);
+            p = eol + (eol < end);
+        }
+        rows[c + 1] = count;
+    }
+    for (size_t c = 0; c < nb_chunks; c++) {
+        rows[c + 1] += rows[c];
+    }
+
+    bool valid = rows[nb_chunks] == n;
+    if (valid) {
+        int64_t* matrix = config->adjacency_matrix->data;
+#pragma omp parallel for schedule(dynamic) reduction(&& : valid)
+        for (size_t c = 0; c < nb_chunks; c++) {
+            valid = config_parse_rows(starts[c], starts[c + 1], rows[c], n,
+                                      matrix) &&
+                    valid;
+        }
+        config->adjacency_matrix->len = n * n;
+    }
+    free(starts);
+    free(rows);
+    config_text_release(&text);
+    if (!valid) {
+        return TSP_ERR_FORMAT;
+    }
+
+    // Symmetric matrices keep half of their entries, or all of them if the
+    // copy cannot be allocated
+    if (config_symmetric(config->adjacency_matrix->data, n)) {
+        pages_backing_t backing;
+        vec_i64_t* packed =
+            config_pack(config->adjacency_matrix->data, n, &backing);
+        if (packed) {
+            pages_vec_i64_drop(config->adjacency_matrix,
+                               config->matrix_backing);
+            config->adjacency_matrix = packed;
+            config->matrix_backing = backing;
+            config->triangular = true;
+        }
+    }
+    return TSP_OK;
+}
+
+// Orders `FROM TO WEIGHT` triples by source, then by target
+static int config_compare_edges(void const* a, void const* b)
+{
+    int64_t const* x = a;
+    int64_t const* y = b;
+    if (x[0] != y[0]) {
+        return x[0] < y[0] ? -1 : 1;
+    }
+    return (x[1] > y[1]) - (x[1] < y[1]);
+}
+
+// Reads the `FROM TO WEIGHT` lines of a sparse instance into adjacency lists
+static tsp_status_t config_load_sparse(config_t* config, FILE* fp)
+{
+    size_t const n = config->nb_nodes;
+    config->sparse = malloc(sizeof(sparse_t));
+    vec_i64_t* edges = vec_i64_with_capacity(3 * n);
+    if (!config->sparse || !edges) {
+        vec_i64_drop(edges);
+        return TSP_ERR_ALLOC;
+    }
+    config->sparse->offsets = NULL;
+    config->sparse->targets = NULL;
+    config->sparse->weights = NULL;
 
     char buf[BUFFER_LEN];
-    fgets(buf, BUFFER_LEN, fp);
-    sscanf(buf, "%zu\n", &config->nb_nodes);
-    if (!config->nb_nodes) {
-        fprintf(stderr,
-                "\033[1;31merror:\033[0m %zu is an invalid number of nodes\n",
-                config->nb_nodes);
-        config_destroy(config);
-        fclose(fp);
-        exit(EXIT_FAILURE);
-    }
-    config->adjacency_matrix =
-        vec_with_capacity(config->nb_nodes, sizeof(int64_t));
-
-    int64_t value;
-    size_t i = 0;
     while (fgets(buf, BUFFER_LEN, fp)) {
-        int offset = 0;
-        char* scan = buf;
-        for (size_t j = 0; j < config->nb_nodes; j++) {
-            sscanf(scan, "%ld%n", &value, &offset);
-            vec_push(config->adjacency_matrix, &value);
-            scan += offset;
+        // Skip blank lines
+        if (!buf[strspn(buf, " \t\r\n")]) {
+            continue;
+        }
+        int64_t from, to, weight;
+        if (sscanf(buf, "%ld %ld %ld", &from, &to, &weight) != 3 ||
+            from < 0 || to < 0 || (size_t)from >= n || (size_t)to >= n ||
+            from == to) {
+            vec_i64_drop(edges);
+            return TSP_ERR_FORMAT;
+        }
+        // A weight of 0 is a missing edge
+        if (!weight) {
+            continue;
+        }
+        if (!vec_i64_push(edges, from) || !vec_i64_push(edges, to) ||
+            !vec_i64_push(edges, weight)) {
+            vec_i64_drop(edges);
+            return TSP_ERR_ALLOC;
+        }
+    }
+
+    size_t const nb_edges = edges->len / 3;
+    qsort(edges->data, nb_edges, 3 * sizeof(int64_t), config_compare_edges);
+    sparse_t* sparse = config->sparse;
+    sparse->offsets = vec_i64_with_value(0, n + 1);
+    sparse->targets = vec_i64_with_capacity(nb_edges);
+    sparse->weights = vec_i64_with_capacity(nb_edges);
+    if (!sparse->offsets || !sparse->targets || !sparse->weights) {
+        vec_i64_drop(edges);
+        return TSP_ERR_ALLOC;
+    }
+
+    int64_t const* edge = edges->data;
+    for (size_t e = 0; e < nb_edges; e++, edge += 3) {
+        // The same edge cannot be given twice
+        if (e && edge[0] == edge[-3] && edge[1] == edge[-2]) {
+            vec_i64_drop(edges);
+            return TSP_ERR_FORMAT;
         }
-        i++;
-        if (i > config->nb_nodes) {
-            fprintf(stderr,
-                    "\033[1;31merror:\033[0m too many lines in config file\n"
-                    "-> number of nodes is set to %zu and current row is %zu\n",
-                    config->nb_nodes, i);
-            config_destroy(config);
-            fclose(fp);
-            exit(EXIT_FAILURE);
+        sparse->offsets->data[edge[0] + 1]++;
+        vec_i64_push(sparse->targets, edge[1]);
+        vec_i64_push(sparse->weights, edge[2]);
+    }
+    for (size_t i = 0; i < n; i++) {
+        sparse->offsets->data[i + 1] += sparse->offsets->data[i];
+    }
+
+    vec_i64_drop(edges);
+    return TSP_OK;
+}
+
+tsp_status_t config_read(FILE* fp, config_t** config)
+{
+    *config = NULL;
+    config_t* c = malloc(sizeof(config_t));
+    if (!c) {
+        return TSP_ERR_ALLOC;
+    }
+
+    c->nb_nodes = 0;
+    c->adjacency_matrix = NULL;
+    c->coordinates = NULL;
+    c->sparse = NULL;
+    c->labels = NULL;
+    c->matrix_backing = PAGES_HEAP;
+    c->triangular = false;
+
+    char buf[BUFFER_LEN];
+    char kind[16] = "";
+    tsp_status_t status = TSP_ERR_FORMAT;
+    if (fgets(buf, BUFFER_LEN, fp) &&
+        sscanf(buf, "%zu %15s\n", &c->nb_nodes, kind) >= 1 && c->nb_nodes) {
+        if (!strcmp(kind, "EUC_2D")) {
+            status = config_load_coordinates(c, fp);
+        } else if (!strcmp(kind, "SPARSE")) {
+            status = config_load_sparse(c, fp);
+        } else if (!*kind) {
+            status = config_load_matrix(c, fp);
         }
     }
 
+    if (status != TSP_OK) {
+        config_destroy(c);
+        return status;
+    }
+    *config = c;
+    return TSP_OK;
+}
+
+tsp_status_t config_load(char const* filename, config_t** config)
+{
+    *config = NULL;
+    if (!filename) {
+        return TSP_ERR_INVALID_ARGUMENT;
+    }
+
+    FILE* fp = fopen(filename, "r");
+    if (!fp) {
+        return TSP_ERR_IO;
+    }
+    tsp_status_t status = config_read(fp, config);
     fclose(fp);
-    return config;
+    return status;
+}
+
+tsp_status_t config_from_matrix(int64_t const* matrix, size_t nb_nodes,
+                                config_t** config)
+{
+    *config = NULL;
+    if (!matrix || !nb_nodes) {
+        return TSP_ERR_INVALID_ARGUMENT;
+    }
+
+    config_t* c = malloc(sizeof(config_t));
+    if (!c) {
+        return TSP_ERR_ALLOC;
+    }
+    c->nb_nodes = nb_nodes;
+    c->coordinates = NULL;
+    c->sparse = NULL;
+    c->labels = NULL;
+    c->triangular = config_symmetric(matrix, nb_nodes);
+    c->adjacency_matrix =
+        c->triangular
+            ? config_pack(matrix, nb_nodes, &c->matrix_backing)
+            : pages_vec_i64(nb_nodes * nb_nodes, &c->matrix_backing);
+    if (!c->adjacency_matrix) {
+        config_destroy(c);
+        return TSP_ERR_ALLOC;
+    }
+    if (!c->triangular) {
+        memcpy(c->adjacency_matrix->data, matrix,
+               nb_nodes * nb_nodes * sizeof(int64_t));
+        c->adjacency_matrix->len = nb_nodes * nb_nodes;
+    }
+
+    *config = c;
+    return TSP_OK;
 }
 
 void config_destroy(config_t* config)
 {
     if (config) {
-        if (config->adjacency_matrix) {
-            vec_drop(config->adjacency_matrix);
+        pages_vec_i64_drop(config->adjacency_matrix, config->matrix_backing);
+        vec_f64_drop(config->coordinates);
+        if (config->sparse) {
+            vec_i64_drop(config->sparse->offsets);
+            vec_i64_drop(config->sparse->targets);
+            vec_i64_drop(config->sparse->weights);
+            free(config->sparse);
         }
+        vec_i64_drop(config->labels);
         free(config);
     }
 }
@@ -87,8 +511,17 @@ void config_print(config_t const* config)
     }
 
     printf("Travelling Salesman Problem configuration:\n"
-           "  Number of nodes: %zu\n",
-           config->nb_nodes);
+           "  Number of nodes: %zu\n"
+           "  Edge weights: %s\n",
+           config->nb_nodes,
+           config->coordinates ? "2D Euclidean"
+           : config->sparse    ? "sparse adjacency lists"
+                               : "explicit matrix");
+    if (config->adjacency_matrix) {
+        printf("  Matrix storage: %s, on %s\n",
+               config->triangular ? "upper triangle" : "full",
+               pages_name(config->matrix_backing));
+    }
 
     if (config->nb_nodes > 16) {
         printf("  Adjacency matrix is too big to print, sorry!\n");
@@ -0,0 +1,502 @@
+/**
+ * @file    cut.c
+ * @brief   Implementation of the branch-and-cut exact engine.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "cut.h"
+#include "little.h"
+#include "lk.h"
+#include "simplex.h"
+#include "utils.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Edges are the columns of the relaxation, numbered by increasing first then
+// second end. The incident edges of node `v` are `incident[offsets[v]]` to
+// `incident[offsets[v + 1] - 1]`, in increasing order. `capacity` is the
+// support graph handed to the minimum cut, `merged` links the nodes merged
+// into each other by its phases. `fixed` marks the edges whose bounds the
+// search has fixed.
+typedef struct cut_state_t {
+    config_t const* config;
+    solver_t* solver;
+    simplex_t* lp;
+    size_t nb_nodes;
+    size_t nb_edges;
+    size_t* ends;
+    double* costs;
+    size_t* offsets;
+    size_t* incident;
+    double* capacity;
+    double* key;
+    size_t* merged;
+    size_t* last;
+    bool* active;
+    bool* inside;
+    bool* fixed;
+    size_t* row;
+    double* ones;
+    size_t* tour;
+    uint64_t explored;
+} cut_state_t;
+
+// Adds the cut `x(E(S)) <= |S| - 1` for the nodes marked in `inside`, or for
+// the others if they are fewer, which is the same cut
+static tsp_status_t cut_add(cut_state_t* s)
+{
+    size_t const n = s->nb_nodes;
+    size_t size = 0;
+    for (size_t v = 0; v < n; v++) {
+        size += s->inside[v];
+    }
+    bool const side = 2 * size <= n;
+    size = side ? size : n - size;
+
+    size_t len = 0;
+    for (size_t e = 0; e < s->nb_edges; e++) {
+        if (s->inside[s->ends[2 * e]] == side &&
+            s->inside[s->ends[2 * e + 1]] == side) {
+            s->row[len++] = e;
+        }
+    }
+    return simplex_add_row(s->lp, len, s->row, s->ones, -INFINITY,
+                           (double)size - 1.0);
+}
+
+// Finds the root of `v` in the union-find forest `parent`, halving its path
+static size_t cut_find(size_t* parent, size_t v)
+{
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+// Adds a cut for every connected component of the support of the solution,
+// if there are several. Returns the number of cuts, or -1 if a row could not
+// be allocated.
+static int64_t cut_components(cut_state_t* s, double const* x)
+{
+    size_t const n = s->nb_nodes;
+    size_t* parent = s->merged;
+    for (size_t v = 0; v < n; v++) {
+        parent[v] = v;
+    }
+    size_t nb_components = n;
+    for (size_t e = 0; e < s->nb_edges; e++) {
+        if (x[e] > CUT_EPSILON) {
+            size_t const a = cut_find(parent, s->ends[2 * e]);
+            size_t const b = cut_find(parent, s->ends[2 * e + 1]);
+            if (a != b) {
+                parent[a] = b;
+                nb_components--;
+            }
+        }
+    }
+    if (nb_components == 1) {
+        return 0;
+    }
+
+    int64_t added = 0;
+    for (size_t root = 0; root < n; root++) {
+        if (cut_find(parent, root) != root) {
+            continue;
+        }
+        for (size_t v = 0; v < n; v++) {
+            s->inside[v] = cut_find(parent, v) == root;
+        }
+        if (cut_add(s) != TSP_OK) {
+            return -1;
+        }
+        added++;
+    }
+    return added;
+}
+
+// Stoer-Wagner minimum cut of the support of the solution, in O(n^3). Every
+// phase cuts the last node it adds, with all the nodes merged into it, from
+// the others. Each of these cuts lighter than 2 is violated and added.
+// Returns the number of cuts, or -1 if a row could not be allocated.
+static int64_t cut_minimum(cut_state_t* s, double const* x)
+{
+    size_t const n = s->nb_nodes;
+    double* w = s->capacity;
+    for (size_t i = 0; i < n * n; i++) {
+        w[i] = 0.0;
+    }
+    for (size_t e = 0; e < s->nb_edges; e++) {
+        size_t const u = s->ends[2 * e];
+        size_t const v = s->ends[2 * e + 1];
+        // Round-off may leave tiny negative values, which would pass for
+        // the marks of the added nodes below
+        w[u * n + v] = w[v * n + u] = x[e] > CUT_EPSILON ? x[e] : 0.0;
+    }
+    for (size_t v = 0; v < n; v++) {
+        s->merged[v] = SIZE_MAX;
+        s->last[v] = v;
+        s->active[v] = true;
+    }
+
+    int64_t added = 0;
+    for (size_t remaining = n; remaining > 1; remaining--) {
+        // Adds the nodes one by one, the most tightly connected to the
+        // added ones first, with `key` marking the added ones by -1
+        for (size_t v = 0; v < n; v++) {
+            s->key[v] = s->active[v] ? 0.0 : -1.0;
+        }
+        size_t previous = SIZE_MAX;
+        size_t current = SIZE_MAX;
+        double weight = 0.0;
+        for (size_t k = 0; k < remaining; k++) {
+            previous = current;
+            current = SIZE_MAX;
+            for (size_t v = 0; v < n; v++) {
+                if (s->key[v] >= 0.0 &&
+                    (current == SIZE_MAX || s->key[v] > s->key[current])) {
+                    current = v;
+                }
+            }
+            weight = s->key[current];
+            s->key[current] = -1.0;
+            for (size_t v = 0; v < n; v++) {
+                if (s->key[v] >= 0.0) {
+                    s->key[v] += w[current * n + v];
+                }
+            }
+        }
+
+        if (weight < 2.0 - CUT_EPSILON) {
+            for (size_t v = 0; v < n; v++) {
+                s->inside[v] = false;
+            }
+            for (size_t v = current; v != SIZE_MAX; v = s->merged[v]) {
+                s->inside[v] = true;
+            }
+            if (cut_add(s) != TSP_OK) {
+                return -1;
+            }
+            added++;
+        }
+
+        // Merges the last node into the one added before it
+        for (size_t v = 0; v < n; v++) {
+            w[previous * n + v] += w[current * n + v];
+            w[v * n + previous] = w[previous * n + v];
+        }
+        w[previous * n + previous] = 0.0;
+        s->merged[s->last[previous]] = current;
+        s->last[previous] = s->last[current];
+        s->active[current] = false;
+    }
+    return added;
+}
+
+static bool cut_integral(cut_state_t const* s, double const* x)
+{
+    for (size_t e = 0; e < s->nb_edges; e++) {
+        if (x[e] > CUT_EPSILON && x[e] < 1.0 - CUT_EPSILON) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Stores the tour an integral solution without subtour describes, if it is
+// better than the incumbent
+static void cut_store(cut_state_t* s, double const* x)
+{
+    size_t const n = s->nb_nodes;
+    size_t* next = s->merged;
+    size_t* other = s->last;
+    for (size_t v = 0; v < n; v++) {
+        next[v] = other[v] = SIZE_MAX;
+    }
+    int64_t cost = 0;
+    for (size_t e = 0; e < s->nb_edges; e++) {
+        if (x[e] > 0.5) {
+            size_t const u = s->ends[2 * e];
+            size_t const v = s->ends[2 * e + 1];
+            *(next[u] == SIZE_MAX ? &next[u] : &other[u]) = v;
+            *(next[v] == SIZE_MAX ? &next[v] : &other[v]) = u;
+            cost += (int64_t)s->costs[e];
+        }
+    }
+    if (cost >= s->solver->minimum_cost) {
+        return;
+    }
+
+    size_t from = 0;
+    size_t current = 0;
+    for (size_t p = 0; p < n; p++) {
+        s->tour[p] = current;
+        size_t const to = next[current] != from ? next[current]
+                                                : other[current];
+        from = current;
+        current = to;
+    }
+    s->solver->nb_explored = s->explored;
+    solver_store_tour(s->config, s->solver, s->tour);
+}
+
+static inline bool cut_prunes(cut_state_t const* s, double bound)
+{
+    return s->solver->minimum_cost != INT64_MAX &&
+           ceil(bound - CUT_EPSILON) >= (double)s->solver->minimum_cost;
+}
+
+// Removes the edges whose reduced cost at the root lifts the bound up to the
+// incumbent: a better tour costs at least 1 less, and cannot use them
+static void cut_fix(cut_state_t* s, double bound)
+{
+    if (s->solver->minimum_cost == INT64_MAX) {
+        return;
+    }
+    double const* x = simplex_values(s->lp);
+    double const* reduced = simplex_reduced_costs(s->lp);
+    double const gap = (double)s->solver->minimum_cost - 1.0 - bound;
+    for (size_t e = 0; e < s->nb_edges; e++) {
+        if (x[e] < CUT_EPSILON && reduced[e] > gap + CUT_EPSILON) {
+            simplex_set_bounds(s->lp, e, 0.0, 0.0);
+            s->fixed[e] = true;
+        }
+    }
+}
+
+// Most fractional edge, the heaviest among equally fractional ones, or
+// `SIZE_MAX` if the solution is integral. A relaxation that could not be
+// solved may have none, any edge left free is then branched on.
+static size_t cut_branching(cut_state_t const* s, double const* x,
+                            bool solved)
+{
+    size_t best = SIZE_MAX;
+    double best_distance = 0.5 - CUT_EPSILON;
+    for (size_t e = 0; e < s->nb_edges; e++) {
+        double const distance = fabs(x[e] - 0.5);
+        if (distance < best_distance ||
+            (distance == best_distance && best != SIZE_MAX &&
+             s->costs[e] > s->costs[best])) {
+            best = e;
+            best_distance = distance;
+        }
+    }
+    for (size_t e = 0; e < s->nb_edges && best == SIZE_MAX && !solved; e++) {
+        best = s->fixed[e] ? SIZE_MAX : e;
+    }
+    return best;
+}
+
+static tsp_status_t cut_search(cut_state_t* s, size_t depth)
+{
+    s->explored++;
+    simplex_status_t status;
+    double const* x;
+    for (;;) {
+        status = simplex_solve(s->lp);
+        if (status == SIMPLEX_INFEASIBLE) {
+            return TSP_OK;
+        }
+        // Adding rows may move the values
+        x = simplex_values(s->lp);
+        if (status != SIMPLEX_OPTIMAL) {
+            break;
+        }
+        double const bound = simplex_objective(s->lp);
+        if (depth == 0) {
+            s->solver->lower_bound = (int64_t)ceil(bound - CUT_EPSILON);
+        }
+        if (cut_prunes(s, bound)) {
+            return TSP_OK;
+        }
+
+        // Integral solutions are tours once no subtour is left
+        bool const integral = cut_integral(s, x);
+        if (!integral && depth > CUT_SEPARATION_DEPTH) {
+            break;
+        }
+        int64_t added = cut_components(s, x);
+        if (!added) {
+            added = cut_minimum(s, x);
+        }
+        if (added < 0) {
+            return TSP_ERR_ALLOC;
+        }
+        if (!added && integral) {
+            cut_store(s, x);
+            return TSP_OK;
+        }
+        if (!added) {
+            if (depth == 0) {
+                cut_fix(s, bound);
+            }
+            break;
+        }
+    }
+
+    size_t const e = cut_branching(s, x, status == SIMPLEX_OPTIMAL);
+    if (e == SIZE_MAX) {
+        return TSP_OK;
+    }
+    s->fixed[e] = true;
+    for (int value = 1; value >= 0; value--) {
+        simplex_set_bounds(s->lp, e, value, value);
+        tsp_status_t const branch = cut_search(s, depth + 1);
+        simplex_set_bounds(s->lp, e, 0.0, 1.0);
+        if (branch != TSP_OK) {
+            s->fixed[e] = false;
+            return branch;
+        }
+    }
+    s->fixed[e] = false;
+    return TSP_OK;
+}
+
+// Lists the edges of a symmetric instance in `s`
+static tsp_status_t cut_edges(cut_state_t* s)
+{
+    config_t const* config = s->config;
+    size_t const n = s->nb_nodes;
+    size_t count = 0;
+    for (size_t u = 0; u < n; u++) {
+        for (size_t v = u + 1; v < n; v++) {
+            count += adj_matrix_get(config, u, v) != 0;
+        }
+    }
+
+    size_t const size = count ? count : 1;
+    s->nb_edges = count;
+    s->ends = malloc(2 * size * sizeof(size_t));
+    s->costs = malloc(size * sizeof(double));
+    s->incident = malloc(2 * size * sizeof(size_t));
+    s->row = malloc(size * sizeof(size_t));
+    s->ones = malloc(size * sizeof(double));
+    s->fixed = calloc(size, sizeof(bool));
+    if (!s->ends || !s->costs || !s->incident || !s->row || !s->ones ||
+        !s->fixed) {
+        return TSP_ERR_ALLOC;
+    }
+    size_t e = 0;
+    for (size_t u = 0; u < n; u++) {
+        for (size_t v = u + 1; v < n; v++) {
+            int64_t const w = adj_matrix_get(config, u, v);
+            if (w != 0) {
+                s->ends[2 * e] = u;
+                s->ends[2 * e + 1] = v;
+                s->costs[e] = (double)w;
+                s->ones[e] = 1.0;
+                s->offsets[u + 1]++;
+                s->offsets[v + 1]++;
+                e++;
+            }
+        }
+    }
+
+    // Scanning the edges in order lists those of each node in order
+    for (size_t v = 0; v < n; v++) {
+        s->offsets[v + 1] += s->offsets[v];
+    }
+    size_t* fill = s->merged;
+    for (size_t v = 0; v < n; v++) {
+        fill[v] = s->offsets[v];
+    }
+    for (size_t e = 0; e < count; e++) {
+        s->incident[fill[s->ends[2 * e]]++] = e;
+        s->incident[fill[s->ends[2 * e + 1]]++] = e;
+    }
+    return TSP_OK;
+}
+
+static void cut_destroy(cut_state_t* s)
+{
+    simplex_destroy(s->lp);
+    free(s->ends);
+    free(s->costs);
+    free(s->offsets);
+    free(s->incident);
+    free(s->capacity);
+    free(s->key);
+    free(s->merged);
+    free(s->last);
+    free(s->active);
+    free(s->inside);
+    free(s->fixed);
+    free(s->row);
+    free(s->ones);
+    free(s->tour);
+}
+
+// Starts from the tour of the LK engine, unless the solver holds a better one
+static void cut_incumbent(cut_state_t* s)
+{
+    size_t const n = s->nb_nodes;
+    solver_t* heuristic = solver_init(n);
+    if (heuristic && solve_lk(s->config, heuristic, 0.0, 1) == TSP_OK &&
+        heuristic->minimum_cost < s->solver->minimum_cost) {
+        for (size_t p = 0; p < n; p++) {
+            s->tour[p] = (size_t)heuristic->optimal_path->data[p];
+        }
+        solver_store_tour(s->config, s->solver, s->tour);
+    }
+    solver_destroy(heuristic);
+}
+
+tsp_status_t solve_cut(config_t const* config, solver_t* solver)
+{
+    size_t const n = config->nb_nodes;
+    if (!adj_matrix_symmetric(config)) {
+        return solve_little(config, solver, 0.0);
+    }
+    if (n < 5) {
+        solve_tsp(config, solver);
+        return TSP_OK;
+    }
+
+    cut_state_t s = {
+        .config = config,
+        .solver = solver,
+        .nb_nodes = n,
+        .offsets = calloc(n + 1, sizeof(size_t)),
+        .capacity = malloc(n * n * sizeof(double)),
+        .key = malloc(n * sizeof(double)),
+        .merged = malloc(n * sizeof(size_t)),
+        .last = malloc(n * sizeof(size_t)),
+        .active = malloc(n * sizeof(bool)),
+        .inside = malloc(n * sizeof(bool)),
+        .tour = malloc(n * sizeof(size_t)),
+    };
+    if (!s.offsets || !s.capacity || !s.key || !s.merged || !s.last ||
+        !s.active || !s.inside || !s.tour || cut_edges(&s) != TSP_OK) {
+        cut_destroy(&s);
+        return TSP_ERR_ALLOC;
+    }
+
+    // The relaxation starts with the degree constraints
+    double* lower = calloc(s.nb_edges, sizeof(double));
+    double* upper = malloc(s.nb_edges * sizeof(double));
+    if (lower && upper) {
+        for (size_t e = 0; e < s.nb_edges; e++) {
+            upper[e] = 1.0;
+        }
+        s.lp = simplex_init(s.nb_edges, s.costs, lower, upper);
+    }
+    free(lower);
+    free(upper);
+    tsp_status_t status = s.lp ? TSP_OK : TSP_ERR_ALLOC;
+    for (size_t v = 0; v < n && status == TSP_OK; v++) {
+        size_t const degree = s.offsets[v + 1] - s.offsets[v];
+        status = simplex_add_row(s.lp, degree, &s.incident[s.offsets[v]],
+                                 s.ones, 2.0, 2.0);
+    }
+
+    if (status == TSP_OK) {
+        cut_incumbent(&s);
+        status = cut_search(&s, 0);
+        solver->nb_explored = s.explored;
+    }
+    cut_destroy(&s);
+    return status;
+}
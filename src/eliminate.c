@@ -0,0 +1,371 @@
+/**
+ * @file    eliminate.c
+ * @brief   Implementation of the reduced-cost edge elimination.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "eliminate.h"
+#include "lk.h"
+#include "solver.h"
+#include "utils.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Margin below which a bound is not trusted to exceed an integer cost
+#define ELIMINATE_EPSILON 1e-6
+
+// Minimum 1-tree of the penalized weights `weight(i, j) + pi[i] + pi[j]`: a
+// spanning tree of the nodes 1 to n - 1, rooted at 1 and listed in the order
+// they were added, plus the two lightest edges of node 0
+typedef struct one_tree_t {
+    size_t nb_nodes;
+    double const* weights;
+    double* pi;
+    double* key;
+    size_t* parent;
+    size_t* order;
+    bool* in_tree;
+    int* degree;
+    size_t ends[2];
+    double bound;
+} one_tree_t;
+
+static inline double one_tree_weight(one_tree_t const* t, size_t i, size_t j)
+{
+    return t->weights[i * t->nb_nodes + j] + t->pi[i] + t->pi[j];
+}
+
+// Computes the 1-tree and its Lagrangian bound, returns `false` if the graph
+// is not connected
+static bool one_tree_build(one_tree_t* t)
+{
+    size_t const n = t->nb_nodes;
+    double cost = 0.0;
+    for (size_t v = 0; v < n; v++) {
+        t->key[v] = INFINITY;
+        t->parent[v] = 0;
+        t->in_tree[v] = false;
+        t->degree[v] = 0;
+    }
+
+    // Prim's algorithm on the nodes 1 to n - 1
+    t->key[1] = 0.0;
+    for (size_t k = 1; k < n; k++) {
+        size_t u = 0;
+        for (size_t v = 1; v < n; v++) {
+            if (!t->in_tree[v] && (!u || t->key[v] < t->key[u])) {
+                u = v;
+            }
+        }
+        if (t->key[u] == INFINITY) {
+            return false;
+        }
+        t->in_tree[u] = true;
+        t->order[k - 1] = u;
+        cost += t->key[u];
+        if (u != 1) {
+            t->degree[u]++;
+            t->degree[t->parent[u]]++;
+        }
+        for (size_t v = 1; v < n; v++) {
+            double w = one_tree_weight(t, u, v);
+            if (!t->in_tree[v] && w < t->key[v]) {
+                t->key[v] = w;
+                t->parent[v] = u;
+            }
+        }
+    }
+
+    // Two lightest edges of node 0
+    size_t a = 1;
+    size_t b = 2;
+    if (one_tree_weight(t, 0, b) < one_tree_weight(t, 0, a)) {
+        a = 2;
+        b = 1;
+    }
+    for (size_t v = 3; v < n; v++) {
+        double w = one_tree_weight(t, 0, v);
+        if (w < one_tree_weight(t, 0, a)) {
+            b = a;
+            a = v;
+        } else if (w < one_tree_weight(t, 0, b)) {
+            b = v;
+        }
+    }
+    if (one_tree_weight(t, 0, b) == INFINITY) {
+        return false;
+    }
+    t->ends[0] = a;
+    t->ends[1] = b;
+    t->degree[0] = 2;
+    t->degree[a]++;
+    t->degree[b]++;
+    cost += one_tree_weight(t, 0, a) + one_tree_weight(t, 0, b);
+
+    double penalties = 0.0;
+    for (size_t v = 0; v < n; v++) {
+        penalties += t->pi[v];
+    }
+    t->bound = cost - 2.0 * penalties;
+    return true;
+}
+
+// Maximizes the bound of the 1-tree over the node penalties with Polyak
+// steps towards the upper bound, leaving the best penalties in `t->pi`
+static bool one_tree_optimize(one_tree_t* t, double upper_bound, double* best)
+{
+    size_t const n = t->nb_nodes;
+    double* best_pi = malloc(n * sizeof(double));
+    if (!best_pi) {
+        return false;
+    }
+
+    double step = 2.0;
+    size_t stalled = 0;
+    *best = -INFINITY;
+    for (size_t it = 0; it < ELIMINATE_MAX_ITERATIONS && step > 1e-3; it++) {
+        if (!one_tree_build(t)) {
+            free(best_pi);
+            return false;
+        }
+        if (t->bound > *best) {
+            *best = t->bound;
+            for (size_t v = 0; v < n; v++) {
+                best_pi[v] = t->pi[v];
+            }
+            stalled = 0;
+        } else if (++stalled > n / 2) {
+            step /= 2.0;
+            stalled = 0;
+        }
+
+        // The 1-tree is a tour once every degree is 2
+        double norm = 0.0;
+        for (size_t v = 0; v < n; v++) {
+            norm += (t->degree[v] - 2) * (t->degree[v] - 2);
+        }
+        if (norm == 0.0 || *best > upper_bound - ELIMINATE_EPSILON) {
+            break;
+        }
+        double scale = step * (upper_bound - t->bound) / norm;
+        for (size_t v = 0; v < n; v++) {
+            t->pi[v] += scale * (t->degree[v] - 2);
+        }
+    }
+
+    for (size_t v = 0; v < n; v++) {
+        t->pi[v] = best_pi[v];
+    }
+    free(best_pi);
+    return one_tree_build(t);
+}
+
+// Marks the edges whose reduced cost proves they are not in a tour cheaper
+// than the incumbent, which costs `upper_bound`. Forcing an edge into the
+// tree replaces the heaviest edge of the tree path between its ends, which
+// `path_max` receives for every pair of nodes.
+static void one_tree_eliminate(one_tree_t* t, double upper_bound,
+                               bool* removed, double* path_max)
+{
+    size_t const n = t->nb_nodes;
+
+    // The path from a node to a newly added one goes through its parent
+    for (size_t k = 0; k < n - 1; k++) {
+        size_t v = t->order[k];
+        size_t p = t->parent[v];
+        path_max[v * n + v] = -INFINITY;
+        for (size_t m = 0; m < k; m++) {
+            size_t u = t->order[m];
+            double w = one_tree_weight(t, p, v);
+            double max = path_max[u * n + p] > w ? path_max[u * n + p] : w;
+            path_max[u * n + v] = path_max[v * n + u] = max;
+        }
+    }
+
+    for (size_t i = 1; i < n; i++) {
+        for (size_t j = i + 1; j < n; j++) {
+            double bound =
+                t->bound + one_tree_weight(t, i, j) - path_max[i * n + j];
+            double cost = ceil(bound - ELIMINATE_EPSILON);
+            if (cost >= upper_bound) {
+                removed[i * n + j] = removed[j * n + i] = true;
+            }
+        }
+    }
+
+    // Forcing an edge of node 0 replaces the heavier of its two edges
+    double heavier = one_tree_weight(t, 0, t->ends[1]);
+    for (size_t j = 1; j < n; j++) {
+        double bound = t->bound + one_tree_weight(t, 0, j) - heavier;
+        double cost = ceil(bound - ELIMINATE_EPSILON);
+        if (j != t->ends[0] && j != t->ends[1] && cost >= upper_bound) {
+            removed[j] = removed[j * n] = true;
+        }
+    }
+}
+
+// Stores the tour of the LK engine in the solver, unless the solver holds a
+// better one, so that the search starts from it
+static void eliminate_incumbent(config_t const* config, solver_t* solver)
+{
+    size_t const n = config->nb_nodes;
+    solver_t* heuristic = solver_init(n);
+    size_t* tour = malloc(n * sizeof(size_t));
+    if (heuristic && tour && solve_lk(config, heuristic, 0.0, 1) == TSP_OK &&
+        heuristic->minimum_cost < solver->minimum_cost) {
+        for (size_t p = 0; p < n; p++) {
+            tour[p] = (size_t)heuristic->optimal_path->data[p];
+        }
+        solver_store_tour(config, solver, tour);
+    }
+    free(tour);
+    solver_destroy(heuristic);
+}
+
+// Removes the edges of a symmetric instance proven absent from optimal tours
+// and returns the Held-Karp bound, leaves `removed` untouched and returns
+// `-INFINITY` if the instance is disconnected or without tour
+static double eliminate(config_t const* config, solver_t* solver,
+                        bool* removed)
+{
+    size_t const n = config->nb_nodes;
+
+    // The tour of the heuristic engine is the upper bound, and the incumbent
+    // of the search
+    eliminate_incumbent(config, solver);
+    int64_t const incumbent = solver->minimum_cost;
+    if (incumbent == INT64_MAX) {
+        return -INFINITY;
+    }
+    double const upper_bound = (double)incumbent;
+
+    one_tree_t t = {
+        .nb_nodes = n,
+        .pi = calloc(n, sizeof(double)),
+        .key = malloc(n * sizeof(double)),
+        .parent = malloc(n * sizeof(size_t)),
+        .order = malloc(n * sizeof(size_t)),
+        .in_tree = malloc(n * sizeof(bool)),
+        .degree = malloc(n * sizeof(int)),
+    };
+    double* weights = malloc(n * n * sizeof(double));
+    double* path_max = malloc(n * n * sizeof(double));
+    double bound = -INFINITY;
+    if (weights && path_max && t.pi && t.key && t.parent && t.order &&
+        t.in_tree && t.degree) {
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                int64_t w = adj_matrix_get(config, i, j);
+                weights[i * n + j] = w || i == j ? (double)w : INFINITY;
+            }
+        }
+        t.weights = weights;
+        if (one_tree_optimize(&t, upper_bound, &bound)) {
+            one_tree_eliminate(&t, upper_bound, removed, path_max);
+        } else {
+            bound = -INFINITY;
+        }
+    }
+
+    free(weights);
+    free(path_max);
+    free(t.pi);
+    free(t.key);
+    free(t.parent);
+    free(t.order);
+    free(t.in_tree);
+    free(t.degree);
+    return bound;
+}
+
+candidates_t* candidates_init(config_t const* config, solver_t* solver)
+{
+    size_t const n = config->nb_nodes;
+    sparse_t const* sparse = config->sparse;
+    size_t const capacity =
+        sparse ? (size_t)sparse->offsets->data[n] : n * (n - 1);
+    candidates_t* candidates = malloc(sizeof(candidates_t));
+    if (!candidates) {
+        return NULL;
+    }
+    candidates->nb_nodes = n;
+    candidates->capacity = capacity ? capacity : 1;
+    candidates->offsets = malloc((n + 1) * sizeof(size_t));
+    candidates->nodes = pages_alloc(candidates->capacity *
+                                        (sizeof(size_t) + sizeof(int64_t)),
+                                    &candidates->backing);
+    if (!candidates->offsets || !candidates->nodes) {
+        candidates_destroy(candidates);
+        return NULL;
+    }
+    candidates->weights = (int64_t*)&candidates->nodes[candidates->capacity];
+
+    // The elimination needs the whole matrix, sparse instances are only
+    // reduced if it is small enough
+    bool const symmetric = adj_matrix_symmetric(config);
+    bool* removed = NULL;
+    double held_karp = -INFINITY;
+    if (symmetric && n >= 4 && n <= CONFIG_DENSE_LIMIT) {
+        removed = calloc(n * n, sizeof(bool));
+        if (!removed) {
+            candidates_destroy(candidates);
+            return NULL;
+        }
+        held_karp = eliminate(config, solver, removed);
+    }
+
+    // Every node is left once, through its lightest edge at best
+    int64_t lightest_sum = 0;
+    size_t len = 0;
+    size_t directed = 0;
+    for (size_t i = 0; i < n; i++) {
+        int64_t lightest = INT64_MAX;
+        candidates->offsets[i] = len;
+        size_t const begin = sparse ? (size_t)sparse->offsets->data[i] : 0;
+        size_t const end = sparse ? (size_t)sparse->offsets->data[i + 1] : n;
+        for (size_t e = begin; e < end; e++) {
+            size_t const j = sparse ? (size_t)sparse->targets->data[e] : e;
+            int64_t const w = sparse ? sparse->weights->data[e]
+                                     : adj_matrix_get(config, i, j);
+            if (i == j || !w) {
+                continue;
+            }
+            directed++;
+            lightest = w < lightest ? w : lightest;
+            if (!removed || !removed[i * n + j]) {
+                candidates->nodes[len] = j;
+                candidates->weights[len++] = w;
+            }
+        }
+        if (lightest_sum != INT64_MAX && n > 1) {
+            lightest_sum =
+                lightest == INT64_MAX ? INT64_MAX : lightest_sum + lightest;
+        }
+    }
+    candidates->offsets[n] = len;
+    // Both directions of an edge are listed, but only count once if they
+    // always weigh the same
+    candidates->nb_edges = symmetric ? directed / 2 : directed;
+    candidates->nb_eliminated =
+        symmetric ? (directed - len) / 2 : directed - len;
+    candidates->lower_bound = lightest_sum;
+    if (held_karp > (double)lightest_sum) {
+        candidates->lower_bound = (int64_t)ceil(held_karp - ELIMINATE_EPSILON);
+    }
+
+    free(removed);
+    return candidates;
+}
+
+void candidates_destroy(candidates_t* candidates)
+{
+    if (candidates) {
+        free(candidates->offsets);
+        pages_free(candidates->nodes,
+                   candidates->capacity * (sizeof(size_t) + sizeof(int64_t)),
+                   candidates->backing);
+        free(candidates);
+    }
+}
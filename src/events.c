@@ -0,0 +1,212 @@
+/**
+ * @file    events.c
+ * @brief   Implementation of the incumbent event stream.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "events.h"
+#include "utils.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Improvement waiting to be written, its tour being `nb_nodes + 1` nodes long
+typedef struct event_t {
+    double time;
+    double elapsed;
+    int64_t cost;
+    uint64_t explored;
+    int64_t lower_bound;
+    int64_t* tour;
+} event_t;
+
+struct events_t {
+    FILE* fp;
+    size_t nb_nodes;
+    double start;
+    bool failed;
+
+    // Events waiting for the writer thread, from `head` on
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    event_t queue[EVENTS_QUEUE_SIZE];
+    size_t head;
+    size_t len;
+    bool closing;
+
+    // Cost of the last queued event, engines may store the same tour twice
+    int64_t last_cost;
+
+    // Event being written, only used by the writer thread
+    event_t current;
+    pthread_t writer;
+};
+
+// Copies an event, along with its tour
+static void event_copy(event_t* to, event_t const* from, size_t nb_nodes)
+{
+    int64_t* tour = to->tour;
+    *to = *from;
+    to->tour = tour;
+    memcpy(tour, from->tour, (nb_nodes + 1) * sizeof(int64_t));
+}
+
+static bool event_write(FILE* fp, event_t const* event, size_t nb_nodes)
+{
+    fprintf(fp, "{\"time\":%.6f,\"elapsed\":%.6f,\"cost\":%ld,"
+                "\"explored\":%lu,\"lower_bound\":",
+            event->time, event->elapsed, event->cost, event->explored);
+    if (event->lower_bound == INT64_MIN) {
+        fprintf(fp, "null");
+    } else {
+        fprintf(fp, "%ld", event->lower_bound);
+    }
+    fprintf(fp, ",\"tour\":[");
+    for (size_t i = 0; i <= nb_nodes; i++) {
+        fprintf(fp, i ? ",%ld" : "%ld", event->tour[i]);
+    }
+    fprintf(fp, "]}\n");
+
+    // Flush every line, readers follow the stream live
+    return fflush(fp) == 0 && !ferror(fp);
+}
+
+static void* events_writer(void* arg)
+{
+    events_t* events = arg;
+    pthread_mutex_lock(&events->lock);
+    for (;;) {
+        while (!events->len && !events->closing) {
+            pthread_cond_wait(&events->not_empty, &events->lock);
+        }
+        if (!events->len) {
+            break;
+        }
+        event_copy(&events->current, &events->queue[events->head],
+                   events->nb_nodes);
+        events->head = (events->head + 1) % EVENTS_QUEUE_SIZE;
+        events->len--;
+
+        // Write without holding the lock, so that the search never waits
+        pthread_mutex_unlock(&events->lock);
+        bool written =
+            event_write(events->fp, &events->current, events->nb_nodes);
+        pthread_mutex_lock(&events->lock);
+        events->failed |= !written;
+    }
+    pthread_mutex_unlock(&events->lock);
+    return NULL;
+}
+
+static void events_free(events_t* events)
+{
+    for (size_t e = 0; e < EVENTS_QUEUE_SIZE; e++) {
+        free(events->queue[e].tour);
+    }
+    free(events->current.tour);
+    free(events);
+}
+
+events_t* events_open(char const* path, size_t nb_nodes)
+{
+    events_t* events = calloc(1, sizeof(events_t));
+    if (!events) {
+        return NULL;
+    }
+    events->nb_nodes = nb_nodes;
+    events->last_cost = INT64_MAX;
+
+    // Tours are preallocated, pushing an event never allocates
+    bool allocated = true;
+    for (size_t e = 0; e < EVENTS_QUEUE_SIZE; e++) {
+        events->queue[e].tour = malloc((nb_nodes + 1) * sizeof(int64_t));
+        allocated &= events->queue[e].tour != NULL;
+    }
+    events->current.tour = malloc((nb_nodes + 1) * sizeof(int64_t));
+    if (!allocated || !events->current.tour) {
+        events_free(events);
+        return NULL;
+    }
+
+    events->fp = fopen(path, "w");
+    if (!events->fp) {
+        events_free(events);
+        return NULL;
+    }
+    events->start = wall_time();
+    pthread_mutex_init(&events->lock, NULL);
+    pthread_cond_init(&events->not_empty, NULL);
+    if (pthread_create(&events->writer, NULL, events_writer, events)) {
+        pthread_mutex_destroy(&events->lock);
+        pthread_cond_destroy(&events->not_empty);
+        fclose(events->fp);
+        events_free(events);
+        return NULL;
+    }
+    return events;
+}
+
+void events_push(events_t* events, solver_t const* solver)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    event_t event = {
+        .time = now.tv_sec + now.tv_nsec / 1e9,
+        .elapsed = wall_time() - events->start,
+        .cost = solver->minimum_cost,
+        .explored = solver->nb_explored,
+        .lower_bound = solver->lower_bound,
+        .tour = solver->optimal_path->data,
+    };
+
+    pthread_mutex_lock(&events->lock);
+    if (event.cost >= events->last_cost) {
+        pthread_mutex_unlock(&events->lock);
+        return;
+    }
+    events->last_cost = event.cost;
+    if (events->len == EVENTS_QUEUE_SIZE) {
+        events->head = (events->head + 1) % EVENTS_QUEUE_SIZE;
+        events->len--;
+    }
+    size_t tail = (events->head + events->len) % EVENTS_QUEUE_SIZE;
+    event_copy(&events->queue[tail], &event, events->nb_nodes);
+    if (solver->labels) {
+        int64_t* tour = events->queue[tail].tour;
+        for (size_t i = 0; i <= events->nb_nodes; i++) {
+            tour[i] = solver->labels->data[tour[i]];
+        }
+    }
+    events->len++;
+    pthread_cond_signal(&events->not_empty);
+    pthread_mutex_unlock(&events->lock);
+}
+
+void events_on_incumbent(solver_t const* solver, void* data)
+{
+    events_push(data, solver);
+}
+
+bool events_close(events_t* events)
+{
+    if (!events) {
+        return true;
+    }
+
+    pthread_mutex_lock(&events->lock);
+    events->closing = true;
+    pthread_cond_signal(&events->not_empty);
+    pthread_mutex_unlock(&events->lock);
+    pthread_join(events->writer, NULL);
+
+    bool ok = !events->failed;
+    ok &= fclose(events->fp) == 0;
+    pthread_mutex_destroy(&events->lock);
+    pthread_cond_destroy(&events->not_empty);
+    events_free(events);
+    return ok;
+}
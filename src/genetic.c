@@ -0,0 +1,666 @@
+/**
+ * @file    genetic.c
+ * @brief   Implementation of the genetic algorithm engine.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "genetic.h"
+#include "lk.h"
+#include "neighbors.h"
+#include "utils.h"
+
+#include <omp.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Weight given to pairs of nodes that are not linked by an edge, like in the
+// LK engine
+static const int64_t GENETIC_NO_EDGE = (int64_t)1 << 40;
+
+// Missing link or position
+static const uint32_t GENETIC_NONE = UINT32_MAX;
+
+// Island of tours evolved by a single thread, along with its crossover
+// buffers. Tours are stored as links: tour `t` links node `v` to the nodes
+// `links[2 * n * t + 2 * v]` and `links[2 * n * t + 2 * v + 1]`.
+typedef struct genetic_island_t {
+    uint32_t* links;
+    int64_t* costs;
+    size_t perm[GENETIC_POPULATION];
+    uint64_t rng;
+    lk_t* lk;
+    size_t* tour;
+
+    // Edges that only one of the parents has, and that are not yet part of
+    // an AB-cycle: node `v` has `nb_a[v]` of them from the first parent in
+    // `rest_a[2 * v]`..., and as many from the second one in `rest_b`
+    uint32_t* rest_a;
+    uint32_t* rest_b;
+    uint8_t* nb_a;
+    uint8_t* nb_b;
+
+    // Alternating walk being decomposed into AB-cycles, and the position of
+    // each node in it, at an even (`2 * v`) or odd (`2 * v + 1`) position
+    uint32_t* path;
+    uint32_t* path_pos;
+
+    // AB-cycle `c` goes through the nodes `cycles[cycle_offsets[c]]` to
+    // `cycles[cycle_offsets[c + 1] - 1]`, the first and last ones being the
+    // same, and its edges alternate between the first parent and the second
+    uint32_t* cycles;
+    size_t* cycle_offsets;
+    uint32_t* cycle_order;
+    size_t nb_cycles;
+
+    // Child being built, and the best one of the current parents
+    uint32_t* child;
+    uint32_t* best_child;
+
+    // Subtours of the child: the subtour of each node, and the size and a
+    // node of each subtour
+    uint32_t* label;
+    size_t* sizes;
+    uint32_t* heads;
+    uint32_t* members;
+} genetic_island_t;
+
+typedef struct genetic_t {
+    config_t const* config;
+    solver_t* solver;
+    neighbors_t const* neighbors;
+    options_t const* options;
+    size_t n;
+    size_t nb_islands;
+    double deadline;
+    genetic_island_t* islands;
+
+    // Best tour of each island, sent to the next one at migrations
+    uint32_t* migrants;
+    int64_t* migrant_costs;
+
+    // Shared best tour, written under the `genetic` critical section
+    size_t* best_tour;
+    _Atomic int64_t best_cost;
+    _Atomic uint64_t explored;
+
+    // Stopping state, only written by a single thread between generations
+    int64_t last_cost;
+    size_t stall;
+    bool stop;
+} genetic_t;
+
+static inline int64_t genetic_dist(genetic_t const* ga, size_t a, size_t b)
+{
+    int64_t w = adj_matrix_get(ga->config, a, b);
+    return (w || a == b) ? w : GENETIC_NO_EDGE;
+}
+
+// Replaces the link of `v` to `from` by a link to `to`
+static inline void genetic_relink(uint32_t* links, size_t v, uint32_t from,
+                                  uint32_t to)
+{
+    links[2 * v + (links[2 * v] != from)] = to;
+}
+
+static int64_t genetic_cost(genetic_t const* ga, uint32_t const* links)
+{
+    // Every edge is seen from both of its ends
+    int64_t cost = 0;
+    for (size_t v = 0; v < ga->n; v++) {
+        cost += genetic_dist(ga, v, links[2 * v]);
+        cost += genetic_dist(ga, v, links[2 * v + 1]);
+    }
+    return cost / 2;
+}
+
+static void genetic_from_tour(size_t const* tour, size_t n, uint32_t* links)
+{
+    for (size_t p = 0; p < n; p++) {
+        links[2 * tour[p]] = tour[p == 0 ? n - 1 : p - 1];
+        links[2 * tour[p] + 1] = tour[p + 1 == n ? 0 : p + 1];
+    }
+}
+
+static void genetic_to_tour(uint32_t const* links, size_t n, size_t* tour)
+{
+    size_t prev = links[0];
+    size_t cur = 0;
+    for (size_t p = 0; p < n; p++) {
+        tour[p] = cur;
+        size_t next = links[2 * cur] == prev ? links[2 * cur + 1]
+                                             : links[2 * cur];
+        prev = cur;
+        cur = next;
+    }
+}
+
+// Removes the edge to `w` from the remaining edges of `u`
+static inline void genetic_take(uint32_t* rest, uint8_t* nb, size_t u,
+                                uint32_t w)
+{
+    if (rest[2 * u] == w) {
+        rest[2 * u] = rest[2 * u + 1];
+    }
+    nb[u]--;
+}
+
+// Decomposes the edges that only one of the tours `a` and `b` has into
+// AB-cycles. Starting from a node with such edges, a walk takes random edges
+// of `a` and `b` alternately; whenever it comes back to a node it left by an
+// edge of the other tour than the one it arrives by, the loop it made is an
+// AB-cycle, and the walk goes on from that node without it.
+static void genetic_ab_cycles(genetic_t const* ga, genetic_island_t* is,
+                              uint32_t const* a, uint32_t const* b)
+{
+    size_t const n = ga->n;
+    for (size_t v = 0; v < n; v++) {
+        is->nb_a[v] = 0;
+        is->nb_b[v] = 0;
+        for (size_t s = 0; s < 2; s++) {
+            uint32_t w = a[2 * v + s];
+            if (w != b[2 * v] && w != b[2 * v + 1]) {
+                is->rest_a[2 * v + is->nb_a[v]++] = w;
+            }
+            w = b[2 * v + s];
+            if (w != a[2 * v] && w != a[2 * v + 1]) {
+                is->rest_b[2 * v + is->nb_b[v]++] = w;
+            }
+        }
+        is->path_pos[2 * v] = GENETIC_NONE;
+        is->path_pos[2 * v + 1] = GENETIC_NONE;
+    }
+
+    // The edge leaving position `i` of the walk is from `a` when `i` is even
+    is->nb_cycles = 0;
+    is->cycle_offsets[0] = 0;
+    for (size_t s = 0; s < n; s++) {
+        while (is->nb_a[s]) {
+            size_t len = 0;
+            is->path[0] = s;
+            is->path_pos[2 * s] = 0;
+            do {
+                uint32_t const cur = is->path[len];
+                uint32_t* rest = len & 1 ? is->rest_b : is->rest_a;
+                uint8_t* nb = len & 1 ? is->nb_b : is->nb_a;
+                size_t pick = nb[cur] == 2 ? rng_next(&is->rng) & 1 : 0;
+                uint32_t const next = rest[2 * cur + pick];
+                genetic_take(rest, nb, cur, next);
+                genetic_take(rest, nb, next, cur);
+                is->path[++len] = next;
+
+                uint32_t* slot = &is->path_pos[2 * next + (len & 1)];
+                if (*slot == GENETIC_NONE) {
+                    *slot = len;
+                    continue;
+                }
+
+                // Store the loop from an even position, so that it starts
+                // with an edge of `a`
+                size_t const p = *slot;
+                uint32_t* cycle =
+                    &is->cycles[is->cycle_offsets[is->nb_cycles]];
+                size_t k = 0;
+                for (size_t i = p + (p & 1); i <= len; i++) {
+                    cycle[k++] = is->path[i];
+                }
+                if (p & 1) {
+                    cycle[k++] = is->path[p + 1];
+                }
+                is->cycle_offsets[is->nb_cycles + 1] =
+                    is->cycle_offsets[is->nb_cycles] + k;
+                is->nb_cycles++;
+
+                for (size_t i = p + 1; i < len; i++) {
+                    is->path_pos[2 * is->path[i] + (i & 1)] = GENETIC_NONE;
+                }
+                len = p;
+            } while (len);
+            is->path_pos[2 * s] = GENETIC_NONE;
+        }
+    }
+}
+
+// Swaps the edges of an AB-cycle from the first parent in `child` for those
+// from the second one, and returns the change of cost
+static int64_t genetic_apply(genetic_t const* ga, uint32_t* child,
+                             uint32_t const* cycle, size_t len)
+{
+    int64_t delta = 0;
+    for (size_t i = 0; i + 1 < len; i += 2) {
+        genetic_relink(child, cycle[i], cycle[i + 1], GENETIC_NONE);
+        genetic_relink(child, cycle[i + 1], cycle[i], GENETIC_NONE);
+        delta -= genetic_dist(ga, cycle[i], cycle[i + 1]);
+    }
+    for (size_t i = 1; i + 1 < len; i += 2) {
+        genetic_relink(child, cycle[i], GENETIC_NONE, cycle[i + 1]);
+        genetic_relink(child, cycle[i + 1], GENETIC_NONE, cycle[i]);
+        delta += genetic_dist(ga, cycle[i], cycle[i + 1]);
+    }
+    return delta;
+}
+
+// Labels the subtours of `child` and returns their number
+static size_t genetic_subtours(genetic_t const* ga, genetic_island_t* is,
+                               uint32_t const* child)
+{
+    size_t const n = ga->n;
+    for (size_t v = 0; v < n; v++) {
+        is->label[v] = GENETIC_NONE;
+    }
+
+    size_t nb_subtours = 0;
+    for (size_t v = 0; v < n; v++) {
+        if (is->label[v] != GENETIC_NONE) {
+            continue;
+        }
+        size_t size = 0;
+        size_t prev = child[2 * v];
+        size_t cur = v;
+        do {
+            is->label[cur] = nb_subtours;
+            size++;
+            size_t next = child[2 * cur] == prev ? child[2 * cur + 1]
+                                                 : child[2 * cur];
+            prev = cur;
+            cur = next;
+        } while (cur != v);
+        is->sizes[nb_subtours] = size;
+        is->heads[nb_subtours] = v;
+        nb_subtours++;
+    }
+    return nb_subtours;
+}
+
+// Evaluates the 2-opt moves joining `u`, in the subtour being merged, to `v`,
+// in another one, and keeps the cheapest in `move`
+static inline void genetic_join(genetic_t const* ga, uint32_t const* child,
+                                size_t u, size_t v, int64_t* best,
+                                size_t move[4])
+{
+    for (size_t su = 0; su < 2; su++) {
+        size_t u2 = child[2 * u + su];
+        int64_t const d_uu2 = genetic_dist(ga, u, u2);
+        for (size_t sv = 0; sv < 2; sv++) {
+            size_t v2 = child[2 * v + sv];
+            int64_t delta = genetic_dist(ga, u, v) + genetic_dist(ga, u2, v2) -
+                            d_uu2 - genetic_dist(ga, v, v2);
+            if (delta < *best) {
+                *best = delta;
+                move[0] = u;
+                move[1] = u2;
+                move[2] = v;
+                move[3] = v2;
+            }
+        }
+    }
+}
+
+// Merges the subtours of `child`, smallest first, into the other subtour it
+// can be joined to by the cheapest 2-opt move: an edge is removed from each,
+// and their ends are linked together. Returns the change of cost.
+static int64_t genetic_merge(genetic_t const* ga, genetic_island_t* is,
+                             uint32_t* child, size_t nb_subtours)
+{
+    size_t const* offsets = ga->neighbors->offsets->data;
+    uint32_t const* neighbors = ga->neighbors->nodes->data;
+    size_t const nb_labels = nb_subtours;
+    int64_t delta = 0;
+    while (nb_subtours > 1) {
+        size_t smallest = SIZE_MAX;
+        for (size_t s = 0; s < nb_labels; s++) {
+            if (is->sizes[s] &&
+                (smallest == SIZE_MAX || is->sizes[s] < is->sizes[smallest])) {
+                smallest = s;
+            }
+        }
+
+        size_t m = 0;
+        size_t prev = child[2 * is->heads[smallest]];
+        size_t cur = is->heads[smallest];
+        do {
+            is->members[m++] = cur;
+            size_t next = child[2 * cur] == prev ? child[2 * cur + 1]
+                                                 : child[2 * cur];
+            prev = cur;
+            cur = next;
+        } while (cur != is->heads[smallest]);
+
+        int64_t best = INT64_MAX;
+        size_t move[4] = {0};
+        for (size_t i = 0; i < m; i++) {
+            size_t u = is->members[i];
+            for (size_t k = offsets[u]; k < offsets[u + 1]; k++) {
+                if (is->label[neighbors[k]] != smallest) {
+                    genetic_join(ga, child, u, neighbors[k], &best, move);
+                }
+            }
+        }
+
+        // The neighbors of the subtour may all be in it
+        for (size_t i = 0; best == INT64_MAX && i < m; i++) {
+            for (size_t v = 0; v < ga->n; v++) {
+                if (is->label[v] != smallest) {
+                    genetic_join(ga, child, is->members[i], v, &best, move);
+                }
+            }
+        }
+
+        genetic_relink(child, move[0], move[1], move[2]);
+        genetic_relink(child, move[1], move[0], move[3]);
+        genetic_relink(child, move[2], move[3], move[0]);
+        genetic_relink(child, move[3], move[2], move[1]);
+        delta += best;
+
+        size_t const into = is->label[move[2]];
+        for (size_t i = 0; i < m; i++) {
+            is->label[is->members[i]] = into;
+        }
+        is->sizes[into] += is->sizes[smallest];
+        is->sizes[smallest] = 0;
+        nb_subtours--;
+    }
+    return delta;
+}
+
+// Crosses the tours `a` and `b` of an island, and replaces `a` by the best of
+// their children if it is shorter. Returns the number of children.
+static size_t genetic_cross(genetic_t const* ga, genetic_island_t* is,
+                            size_t a, size_t b)
+{
+    size_t const n = ga->n;
+    uint32_t* parent = &is->links[2 * n * a];
+    genetic_ab_cycles(ga, is, parent, &is->links[2 * n * b]);
+
+    size_t const nb_children = is->nb_cycles < GENETIC_CHILDREN
+                                   ? is->nb_cycles
+                                   : GENETIC_CHILDREN;
+    for (size_t c = 0; c < is->nb_cycles; c++) {
+        is->cycle_order[c] = c;
+    }
+
+    int64_t best = is->costs[a];
+    for (size_t c = 0; c < nb_children; c++) {
+        // Each child swaps a different random AB-cycle
+        size_t r = c + rng_next(&is->rng) % (is->nb_cycles - c);
+        uint32_t const cycle = is->cycle_order[r];
+        is->cycle_order[r] = is->cycle_order[c];
+        is->cycle_order[c] = cycle;
+
+        memcpy(is->child, parent, 2 * n * sizeof(uint32_t));
+        size_t const begin = is->cycle_offsets[cycle];
+        int64_t cost = is->costs[a];
+        cost += genetic_apply(ga, is->child, &is->cycles[begin],
+                              is->cycle_offsets[cycle + 1] - begin);
+        size_t nb_subtours = genetic_subtours(ga, is, is->child);
+        cost += genetic_merge(ga, is, is->child, nb_subtours);
+        if (cost < best) {
+            best = cost;
+            memcpy(is->best_child, is->child, 2 * n * sizeof(uint32_t));
+        }
+    }
+
+    if (best < is->costs[a]) {
+        memcpy(parent, is->best_child, 2 * n * sizeof(uint32_t));
+        is->costs[a] = best;
+    }
+    return nb_children;
+}
+
+static size_t genetic_best(genetic_island_t const* is)
+{
+    size_t best = 0;
+    for (size_t t = 1; t < GENETIC_POPULATION; t++) {
+        if (is->costs[t] < is->costs[best]) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+// Replaces the shared best tour by the best tour of the island if it is
+// shorter, and stores it in the solver
+static void genetic_publish(genetic_t* ga, genetic_island_t const* is)
+{
+    size_t const t = genetic_best(is);
+    int64_t const cost = is->costs[t];
+    if (cost >= atomic_load(&ga->best_cost)) {
+        return;
+    }
+
+#pragma omp critical(genetic)
+    if (cost < atomic_load(&ga->best_cost)) {
+        genetic_to_tour(&is->links[2 * ga->n * t], ga->n, ga->best_tour);
+        atomic_store(&ga->best_cost, cost);
+        ga->solver->nb_explored = atomic_load(&ga->explored);
+        solver_store_tour(ga->config, ga->solver, ga->best_tour);
+    }
+}
+
+// Fills the island with locally optimal tours, or with copies of the first
+// one once the time is up
+static void genetic_populate(genetic_t* ga, genetic_island_t* is)
+{
+    size_t const n = ga->n;
+    for (size_t t = 0; t < GENETIC_POPULATION; t++) {
+        if (t && ga->deadline > 0.0 && wall_time() >= ga->deadline) {
+            memcpy(&is->links[2 * n * t], is->links, 2 * n * sizeof(uint32_t));
+            is->costs[t] = is->costs[0];
+            continue;
+        }
+        lk_nearest_neighbor(is->lk, rng_next(&is->rng) % n, &is->rng);
+        lk_optimize(is->lk, ga->deadline);
+        lk_get_tour(is->lk, is->tour);
+        genetic_from_tour(is->tour, n, &is->links[2 * n * t]);
+        is->costs[t] = genetic_cost(ga, &is->links[2 * n * t]);
+    }
+}
+
+// Crosses every tour of the island with the next one in a random order
+static void genetic_generation(genetic_t* ga, genetic_island_t* is)
+{
+    for (size_t t = 0; t < GENETIC_POPULATION; t++) {
+        size_t r = t + rng_next(&is->rng) % (GENETIC_POPULATION - t);
+        size_t swap = is->perm[r];
+        is->perm[r] = is->perm[t];
+        is->perm[t] = swap;
+    }
+    for (size_t t = 0; t < GENETIC_POPULATION; t++) {
+        if (ga->deadline > 0.0 && wall_time() >= ga->deadline) {
+            break;
+        }
+        size_t children = genetic_cross(
+            ga, is, is->perm[t], is->perm[(t + 1) % GENETIC_POPULATION]);
+        atomic_fetch_add(&ga->explored, children);
+    }
+}
+
+// Sends the best tour of the island to the next one
+static void genetic_emigrate(genetic_t* ga, genetic_island_t const* is,
+                             size_t id)
+{
+    size_t const n = ga->n;
+    size_t const t = genetic_best(is);
+    memcpy(&ga->migrants[2 * n * id], &is->links[2 * n * t],
+           2 * n * sizeof(uint32_t));
+    ga->migrant_costs[id] = is->costs[t];
+}
+
+// Replaces the worst tour of the island by the best tour of the previous one,
+// unless the island seems to have it already
+static void genetic_immigrate(genetic_t* ga, genetic_island_t* is, size_t id)
+{
+    size_t const n = ga->n;
+    size_t const from = (id + ga->nb_islands - 1) % ga->nb_islands;
+    size_t worst = 0;
+    for (size_t t = 0; t < GENETIC_POPULATION; t++) {
+        if (is->costs[t] == ga->migrant_costs[from]) {
+            return;
+        }
+        if (is->costs[t] > is->costs[worst]) {
+            worst = t;
+        }
+    }
+    memcpy(&is->links[2 * n * worst], &ga->migrants[2 * n * from],
+           2 * n * sizeof(uint32_t));
+    is->costs[worst] = ga->migrant_costs[from];
+}
+
+// Decides whether to stop before the next generation
+static void genetic_check(genetic_t* ga)
+{
+    int64_t const cost = atomic_load(&ga->best_cost);
+    if (cost < ga->last_cost) {
+        ga->last_cost = cost;
+        ga->stall = 0;
+    } else {
+        ga->stall++;
+    }
+    ga->stop = ga->stall >= GENETIC_STALL_GENERATIONS ||
+               cost <= ga->options->target_cost ||
+               (ga->deadline > 0.0 && wall_time() >= ga->deadline);
+}
+
+static void genetic_island_destroy(genetic_island_t* is)
+{
+    free(is->links);
+    free(is->costs);
+    lk_destroy(is->lk);
+    free(is->tour);
+    free(is->rest_a);
+    free(is->rest_b);
+    free(is->nb_a);
+    free(is->nb_b);
+    free(is->path);
+    free(is->path_pos);
+    free(is->cycles);
+    free(is->cycle_offsets);
+    free(is->cycle_order);
+    free(is->child);
+    free(is->best_child);
+    free(is->label);
+    free(is->sizes);
+    free(is->heads);
+    free(is->members);
+}
+
+static bool genetic_island_init(genetic_island_t* is, genetic_t const* ga,
+                                size_t id)
+{
+    size_t const n = ga->n;
+    uint64_t rng = (ga->options->seed + id + 1) * 0x9E3779B97F4A7C15ULL;
+    *is = (genetic_island_t){
+        .links = malloc(GENETIC_POPULATION * 2 * n * sizeof(uint32_t)),
+        .costs = malloc(GENETIC_POPULATION * sizeof(int64_t)),
+        .rng = rng ? rng : 1,
+        .lk = lk_init(ga->config, ga->neighbors),
+        .tour = malloc(n * sizeof(size_t)),
+        .rest_a = malloc(2 * n * sizeof(uint32_t)),
+        .rest_b = malloc(2 * n * sizeof(uint32_t)),
+        .nb_a = malloc(n * sizeof(uint8_t)),
+        .nb_b = malloc(n * sizeof(uint8_t)),
+        .path = malloc((2 * n + 1) * sizeof(uint32_t)),
+        .path_pos = malloc(2 * n * sizeof(uint32_t)),
+        // Each of the at most `2n / 4` AB-cycles repeats its first node
+        .cycles = malloc(3 * n * sizeof(uint32_t)),
+        .cycle_offsets = malloc((n + 1) * sizeof(size_t)),
+        .cycle_order = malloc(n * sizeof(uint32_t)),
+        .child = malloc(2 * n * sizeof(uint32_t)),
+        .best_child = malloc(2 * n * sizeof(uint32_t)),
+        .label = malloc(n * sizeof(uint32_t)),
+        .sizes = malloc(n * sizeof(size_t)),
+        .heads = malloc(n * sizeof(uint32_t)),
+        .members = malloc(n * sizeof(uint32_t)),
+    };
+    for (size_t t = 0; t < GENETIC_POPULATION; t++) {
+        is->perm[t] = t;
+    }
+    return is->links && is->costs && is->lk && is->tour && is->rest_a &&
+           is->rest_b && is->nb_a && is->nb_b && is->path && is->path_pos &&
+           is->cycles && is->cycle_offsets && is->cycle_order && is->child &&
+           is->best_child && is->label && is->sizes && is->heads &&
+           is->members;
+}
+
+tsp_status_t solve_genetic(config_t const* config, solver_t* solver,
+                           options_t const* options)
+{
+    size_t const n = config->nb_nodes;
+    if (!adj_matrix_symmetric(config)) {
+        return TSP_ERR_INVALID_ARGUMENT;
+    }
+    if (n < GENETIC_MIN_NODES) {
+        return solve_lk(config, solver, options->time_limit, options->seed);
+    }
+
+    size_t const threads =
+        options->threads ? options->threads : (size_t)omp_get_max_threads();
+    genetic_t ga = {
+        .config = config,
+        .solver = solver,
+        .neighbors = neighbors_build(config, LK_NEIGHBORS),
+        .options = options,
+        .n = n,
+        .nb_islands = threads,
+        .deadline = options->time_limit > 0.0
+                        ? wall_time() + options->time_limit
+                        : 0.0,
+        .islands = calloc(threads, sizeof(genetic_island_t)),
+        .migrants = malloc(threads * 2 * n * sizeof(uint32_t)),
+        .migrant_costs = malloc(threads * sizeof(int64_t)),
+        .best_tour = malloc(n * sizeof(size_t)),
+        .last_cost = INT64_MAX,
+    };
+    atomic_init(&ga.best_cost, INT64_MAX);
+    atomic_init(&ga.explored, 0);
+
+    // Allocate everything up front, threads then never fail between barriers
+    bool allocated = ga.neighbors && ga.islands && ga.migrants &&
+                     ga.migrant_costs && ga.best_tour;
+    for (size_t i = 0; allocated && i < threads; i++) {
+        allocated = genetic_island_init(&ga.islands[i], &ga, i);
+    }
+
+    if (allocated) {
+#pragma omp parallel num_threads(threads)
+        {
+#pragma omp single
+            ga.nb_islands = (size_t)omp_get_num_threads();
+
+            size_t const id = (size_t)omp_get_thread_num();
+            genetic_island_t* is = &ga.islands[id];
+            genetic_populate(&ga, is);
+            genetic_publish(&ga, is);
+            for (size_t generation = 1;; generation++) {
+#pragma omp barrier
+#pragma omp single
+                genetic_check(&ga);
+
+                if (ga.stop) {
+                    break;
+                }
+                genetic_generation(&ga, is);
+                genetic_publish(&ga, is);
+                if (ga.nb_islands > 1 &&
+                    generation % GENETIC_MIGRATION_INTERVAL == 0) {
+                    genetic_emigrate(&ga, is, id);
+#pragma omp barrier
+                    genetic_immigrate(&ga, is, id);
+                }
+            }
+        }
+        solver->nb_explored = atomic_load(&ga.explored);
+    }
+
+    for (size_t i = 0; ga.islands && i < threads; i++) {
+        genetic_island_destroy(&ga.islands[i]);
+    }
+    free(ga.islands);
+    free(ga.migrants);
+    free(ga.migrant_costs);
+    free(ga.best_tour);
+    neighbors_destroy((neighbors_t*)ga.neighbors);
+    return allocated ? TSP_OK : TSP_ERR_ALLOC;
+}
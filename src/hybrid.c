@@ -0,0 +1,338 @@
+/**
+ * @file    hybrid.c
+ * @brief   Implementation of the hybrid exact engine.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "hybrid.h"
+#include "utils.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Cost of a tail through a missing edge
+#define HYBRID_INFINITY INT64_MAX
+
+// Memoized cost of the cheapest path from `city` through all the cities of
+// `set` to `ret`. An empty set marks an empty entry, such tails not being
+// stored.
+typedef struct hybrid_entry_t {
+    uint64_t set;
+    uint32_t city;
+    uint32_t ret;
+    int64_t cost;
+} hybrid_entry_t;
+
+// The lower bound of a node of the search is its weight plus half of
+// `bound`, which sums, for every edge of the tour still to choose, the minimum
+// weight it may have at each of its ends. The arrays hold what `bound` loses
+// when a city is left as the first city, left later, or entered.
+typedef struct hybrid_state_t {
+    int64_t* weights;
+    int64_t leave_first[HYBRID_MAX_NODES];
+    int64_t leave[HYBRID_MAX_NODES];
+    int64_t enter[HYBRID_MAX_NODES];
+    uint8_t order[HYBRID_MAX_NODES][HYBRID_MAX_NODES];
+    hybrid_entry_t* memo;
+    size_t memo_mask;
+    bool symmetric;
+    size_t nb_nodes;
+    int64_t best_cost;
+    uint64_t explored;
+    size_t path[HYBRID_MAX_NODES + 1];
+    solver_t* solver;
+} hybrid_state_t;
+
+static inline hybrid_entry_t* hybrid_slot(hybrid_state_t* s, uint64_t set,
+                                          size_t city, size_t ret)
+{
+    uint64_t h = (set * 0x9e3779b97f4a7c15ULL ^ (city << 8 | ret)) *
+                 0xff51afd7ed558ccdULL;
+    return &s->memo[(h >> 32) & s->memo_mask];
+}
+
+// Held-Karp recursion: the cheapest tail leaves `city` for one of the cities
+// of `set`, then goes through the others
+static int64_t hybrid_tail(hybrid_state_t* s, uint64_t set, size_t city,
+                           size_t ret)
+{
+    int64_t const* row = &s->weights[city * s->nb_nodes];
+    if (!set) {
+        return row[ret] ? row[ret] : HYBRID_INFINITY;
+    }
+
+    hybrid_entry_t* slot = hybrid_slot(s, set, city, ret);
+    if (slot->set == set && slot->city == city && slot->ret == ret) {
+        return slot->cost;
+    }
+
+    int64_t best = HYBRID_INFINITY;
+    for (uint64_t rest = set; rest; rest &= rest - 1) {
+        size_t next = __builtin_ctzll(rest);
+        if (!row[next]) {
+            continue;
+        }
+        int64_t tail = hybrid_tail(s, set & ~((uint64_t)1 << next), next, ret);
+        if (tail != HYBRID_INFINITY && row[next] + tail < best) {
+            best = row[next] + tail;
+        }
+    }
+
+    // The recursion may have overwritten the slot
+    *slot = (hybrid_entry_t){
+        .set = set,
+        .city = city,
+        .ret = ret,
+        .cost = best,
+    };
+    return best;
+}
+
+// Stores the tour made of the current path and the cheapest tail of the
+// remaining cities in the solver
+static void hybrid_store(hybrid_state_t* s, size_t level, uint64_t set)
+{
+    size_t const ret = s->path[0];
+    size_t city = s->path[level - 1];
+    for (size_t p = 0; p < level; p++) {
+        vec_i64_set(s->solver->optimal_path, p, s->path[p]);
+    }
+
+    // Follow the successors achieving the memoized costs
+    for (size_t p = level; set; p++) {
+        int64_t const* row = &s->weights[city * s->nb_nodes];
+        int64_t cost = hybrid_tail(s, set, city, ret);
+        for (uint64_t rest = set; rest; rest &= rest - 1) {
+            size_t next = __builtin_ctzll(rest);
+            uint64_t left = set & ~((uint64_t)1 << next);
+            if (row[next] && row[next] + hybrid_tail(s, left, next, ret) ==
+                                 cost) {
+                vec_i64_set(s->solver->optimal_path, p, next);
+                city = next;
+                set = left;
+                break;
+            }
+        }
+    }
+    vec_i64_set(s->solver->optimal_path, s->nb_nodes, ret);
+    s->solver->minimum_cost = s->best_cost;
+    s->solver->nb_explored = s->explored;
+    solver_notify_incumbent(s->solver);
+}
+
+// Sums the `count` lightest edges leaving `city` towards `targets`
+static inline int64_t hybrid_lightest(hybrid_state_t const* s, size_t city,
+                                      uint64_t targets, size_t count)
+{
+    int64_t const* row = &s->weights[city * s->nb_nodes];
+    int64_t sum = 0;
+    for (size_t k = 0; k < s->nb_nodes && count; k++) {
+        size_t const j = s->order[city][k];
+        if ((targets >> j) & 1 && row[j]) {
+            sum += row[j];
+            count--;
+        }
+    }
+    return count ? HYBRID_INFINITY : sum;
+}
+
+// Lower bound of the cost of the rest of the tour, like the incremental one
+// but only counting the edges that can still be used: those between the
+// unvisited cities and the ends of the current path
+static int64_t hybrid_bound(hybrid_state_t const* s, size_t level,
+                            uint64_t unvisited)
+{
+    size_t const first = s->path[0];
+    size_t const last = s->path[level - 1];
+    uint64_t const ends = (uint64_t)1 << first | (uint64_t)1 << last;
+    size_t const degree = s->symmetric ? 2 : 1;
+
+    int64_t sum = 0;
+    for (uint64_t rest = unvisited; rest; rest &= rest - 1) {
+        size_t const v = __builtin_ctzll(rest);
+        uint64_t targets = (s->symmetric ? unvisited | ends
+                                         : unvisited | (uint64_t)1 << first) &
+                           ~((uint64_t)1 << v);
+        int64_t lightest = hybrid_lightest(s, v, targets, degree);
+        if (lightest == HYBRID_INFINITY) {
+            return HYBRID_INFINITY;
+        }
+        sum += lightest;
+    }
+
+    // The ends of the path still have an edge towards the unvisited cities
+    size_t const ends_degree = s->symmetric ? 2 : 1;
+    int64_t lightest = level == 1
+                           ? hybrid_lightest(s, last, unvisited, ends_degree)
+                           : hybrid_lightest(s, last, unvisited, 1);
+    if (lightest == HYBRID_INFINITY) {
+        return HYBRID_INFINITY;
+    }
+    sum += lightest;
+    if (s->symmetric && level > 1) {
+        lightest = hybrid_lightest(s, first, unvisited, 1);
+        if (lightest == HYBRID_INFINITY) {
+            return HYBRID_INFINITY;
+        }
+        sum += lightest;
+    }
+    return s->symmetric ? (sum + 1) / 2 : sum;
+}
+
+static void hybrid_search(hybrid_state_t* s, int64_t bound, int64_t weight,
+                          size_t level, uint64_t visited)
+{
+    size_t const n = s->nb_nodes;
+    size_t const last = s->path[level - 1];
+    s->explored++;
+
+    // Bottom of the tree: the cost of the tail is exact
+    if (n - level <= HYBRID_TAIL_SIZE) {
+        uint64_t full = n == 64 ? ~(uint64_t)0 : ((uint64_t)1 << n) - 1;
+        uint64_t set = full & ~visited;
+        int64_t tail = hybrid_tail(s, set, last, s->path[0]);
+        if (tail != HYBRID_INFINITY && weight + tail < s->best_cost) {
+            s->best_cost = weight + tail;
+            hybrid_store(s, level, set);
+        }
+        return;
+    }
+
+    uint64_t full = n == 64 ? ~(uint64_t)0 : ((uint64_t)1 << n) - 1;
+    int64_t rest = hybrid_bound(s, level, full & ~visited);
+    if (rest == HYBRID_INFINITY || weight + rest >= s->best_cost) {
+        return;
+    }
+
+    int64_t const leave = level == 1 ? s->leave_first[last] : s->leave[last];
+    int64_t const* row = &s->weights[last * n];
+    for (size_t k = 0; k < n; k++) {
+        size_t const i = s->order[last][k];
+        if (row[i] == 0 || (visited >> i) & 1) {
+            continue;
+        }
+
+        int64_t child_bound = bound - leave - s->enter[i];
+        int64_t child_weight = weight + row[i];
+        if (child_weight + (child_bound + 1) / 2 < s->best_cost) {
+            s->path[level] = i;
+            hybrid_search(s, child_bound, child_weight, level + 1,
+                          visited | (uint64_t)1 << i);
+        }
+    }
+}
+
+// Size of the memoization table: twice the number of tails of the instance,
+// rounded up to a power of 2, and at most `HYBRID_MEMO_ENTRIES`
+static size_t hybrid_memo_entries(size_t nb_nodes)
+{
+    double tails = 0.0;
+    double sets = 1.0;
+    for (size_t r = 1; r <= HYBRID_TAIL_SIZE && r < nb_nodes; r++) {
+        sets = sets * (nb_nodes - r) / r;
+        tails += sets * (nb_nodes - r);
+    }
+
+    size_t entries = 1;
+    while (entries < HYBRID_MEMO_ENTRIES && entries < 2.0 * tails) {
+        entries *= 2;
+    }
+    return entries;
+}
+
+tsp_status_t solve_hybrid(config_t const* config, solver_t* solver)
+{
+    size_t const n = config->nb_nodes;
+    if (n > HYBRID_MAX_NODES) {
+        solve_tsp(config, solver);
+        return TSP_OK;
+    }
+
+    if (!solver->bounds) {
+        solver->bounds = bounds_init(config);
+    }
+    if (!solver->candidates) {
+        solver->candidates = candidates_init(config, solver);
+    }
+    if (solver->candidates) {
+        solver->lower_bound = solver->candidates->lower_bound;
+    }
+    size_t const entries = hybrid_memo_entries(n);
+    hybrid_state_t s = {
+        .weights = malloc(n * n * sizeof(int64_t)),
+        .memo = calloc(entries, sizeof(hybrid_entry_t)),
+        .memo_mask = entries - 1,
+        .nb_nodes = n,
+        // Start from the incumbent of the solver, if any
+        .best_cost = solver->minimum_cost,
+        .explored = solver->nb_explored,
+        .solver = solver,
+    };
+    if (!solver->bounds || !s.weights || !s.memo) {
+        free(s.weights);
+        free(s.memo);
+        return TSP_ERR_ALLOC;
+    }
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            s.weights[i * n + j] = adj_matrix_get(config, i, j);
+        }
+    }
+    s.symmetric = true;
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < i; j++) {
+            s.symmetric &= s.weights[i * n + j] == s.weights[j * n + i];
+        }
+    }
+
+    // Eliminated edges are removed from the instance, as if they were missing
+    candidates_t const* candidates = solver->candidates;
+    for (size_t i = 0; i < n && candidates; i++) {
+        uint64_t kept = 0;
+        for (size_t k = candidates->offsets[i]; k < candidates->offsets[i + 1];
+             k++) {
+            kept |= (uint64_t)1 << candidates->nodes[k];
+        }
+        for (size_t j = 0; j < n; j++) {
+            if (!((kept >> j) & 1)) {
+                s.weights[i * n + j] = 0;
+            }
+        }
+    }
+
+    // Visit the nearest cities first, to find good incumbents early
+    for (size_t i = 0; i < n; i++) {
+        int64_t const* row = &s.weights[i * n];
+        for (size_t k = 0; k < n; k++) {
+            size_t p = k;
+            for (; p > 0 && row[s.order[i][p - 1]] > row[k]; p--) {
+                s.order[i][p] = s.order[i][p - 1];
+            }
+            s.order[i][p] = k;
+        }
+    }
+
+    // The bound tables hold the two lightest edges leaving each city. On a
+    // symmetric instance, every city still has to be entered and left, so
+    // both of them count until the city is entered, and the lightest one
+    // until it is left. Otherwise, only the lightest edge leaving each city
+    // not left yet counts, twice since `bound` is halved.
+    int64_t const* first = solver->bounds->first->data;
+    int64_t const* second = solver->bounds->second->data;
+    int64_t root_bound = 0;
+    for (size_t i = 0; i < n && n > HYBRID_TAIL_SIZE + 1; i++) {
+        s.leave_first[i] = s.symmetric ? second[i] : 2 * first[i];
+        s.leave[i] = s.symmetric ? first[i] : 2 * first[i];
+        s.enter[i] = s.symmetric ? second[i] : 0;
+        root_bound += s.symmetric ? first[i] + second[i] : 2 * first[i];
+    }
+
+    s.path[0] = 0;
+    hybrid_search(&s, root_bound, 0, 1, 1);
+    solver->nb_explored = s.explored;
+
+    free(s.weights);
+    free(s.memo);
+    return TSP_OK;
+}
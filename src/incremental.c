@@ -0,0 +1,255 @@
+/**
+ * @file    incremental.c
+ * @brief   Implementation of the incremental re-solve.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "incremental.h"
+#include "christofides.h"
+#include "cut.h"
+#include "genetic.h"
+#include "hybrid.h"
+#include "little.h"
+#include "lk.h"
+#include "selector.h"
+#include "spacefill.h"
+#include "utils.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const uint16_t BUFFER_LEN = 4096;
+
+static tsp_status_t tour_read(FILE* fp, size_t nb_nodes, vec_t* tour)
+{
+    char token[32];
+    while (fscanf(fp, "%31s", token) == 1) {
+        if (!strcmp(token, "->")) {
+            continue;
+        }
+        char* end;
+        size_t node = strtoull(token, &end, 10);
+        if (*end || node >= nb_nodes || tour->len > nb_nodes) {
+            return TSP_ERR_FORMAT;
+        }
+        if (!vec_push(tour, &node)) {
+            return TSP_ERR_ALLOC;
+        }
+    }
+
+    // Drop the closing node
+    size_t const* nodes = tour->data;
+    if (tour->len == nb_nodes + 1 && nodes[0] == nodes[nb_nodes]) {
+        tour->len--;
+    }
+    if (tour->len != nb_nodes) {
+        return TSP_ERR_FORMAT;
+    }
+
+    // Check that every node is visited once
+    bool* seen = calloc(nb_nodes, sizeof(bool));
+    if (!seen) {
+        return TSP_ERR_ALLOC;
+    }
+    tsp_status_t status = TSP_OK;
+    for (size_t i = 0; i < nb_nodes && status == TSP_OK; i++) {
+        if (seen[nodes[i]]) {
+            status = TSP_ERR_FORMAT;
+        }
+        seen[nodes[i]] = true;
+    }
+    free(seen);
+    return status;
+}
+
+tsp_status_t tour_load(char const* filename, size_t nb_nodes, vec_t** tour)
+{
+    *tour = NULL;
+    FILE* fp = fopen(filename, "r");
+    if (!fp) {
+        return TSP_ERR_IO;
+    }
+
+    vec_t* t = vec_with_capacity(nb_nodes + 1, sizeof(size_t));
+    tsp_status_t status = t ? tour_read(fp, nb_nodes, t) : TSP_ERR_ALLOC;
+    fclose(fp);
+
+    if (status != TSP_OK) {
+        if (t) {
+            vec_drop(t);
+        }
+        return status;
+    }
+    *tour = t;
+    return TSP_OK;
+}
+
+static tsp_status_t delta_read(FILE* fp, size_t nb_nodes, vec_t* delta)
+{
+    char buf[BUFFER_LEN];
+    while (fgets(buf, BUFFER_LEN, fp)) {
+        // Skip blank lines
+        if (!buf[strspn(buf, " \t\r\n")]) {
+            continue;
+        }
+        edge_change_t change;
+        int end = 0;
+        if (sscanf(buf, "%zu %zu %ld %n", &change.from, &change.to,
+                   &change.weight, &end) != 3 ||
+            buf[end] || change.from >= nb_nodes || change.to >= nb_nodes ||
+            change.from == change.to || change.weight < 0) {
+            return TSP_ERR_FORMAT;
+        }
+        if (!vec_push(delta, &change)) {
+            return TSP_ERR_ALLOC;
+        }
+    }
+    return TSP_OK;
+}
+
+tsp_status_t delta_load(char const* filename, size_t nb_nodes, vec_t** delta)
+{
+    *delta = NULL;
+    FILE* fp = fopen(filename, "r");
+    if (!fp) {
+        return TSP_ERR_IO;
+    }
+
+    vec_t* d = vec_new(sizeof(edge_change_t));
+    tsp_status_t status = d ? delta_read(fp, nb_nodes, d) : TSP_ERR_ALLOC;
+    fclose(fp);
+
+    if (status != TSP_OK) {
+        if (d) {
+            vec_drop(d);
+        }
+        return status;
+    }
+    *delta = d;
+    return TSP_OK;
+}
+
+tsp_status_t delta_apply(config_t* config, vec_t const* delta,
+                         vec_t** changed)
+{
+    *changed = NULL;
+    if (!config->adjacency_matrix && !config->sparse) {
+        return TSP_ERR_INVALID_ARGUMENT;
+    }
+
+    // The adjacency lists of sparse instances cannot grow, only the weights
+    // of their edges change
+    size_t const n = config->nb_nodes;
+    sparse_t* sparse = config->sparse;
+    edge_change_t const* changes = delta->data;
+    for (size_t c = 0; c < delta->len && sparse; c++) {
+        size_t from = changes[c].from;
+        size_t to = changes[c].to;
+        int64_t const* offsets = sparse->offsets->data;
+        if (sparse_find(sparse, from, to) == (size_t)offsets[from + 1] ||
+            sparse_find(sparse, to, from) == (size_t)offsets[to + 1]) {
+            return TSP_ERR_INVALID_ARGUMENT;
+        }
+    }
+
+    bool* seen = calloc(n, sizeof(bool));
+    vec_t* nodes = vec_new(sizeof(size_t));
+    if (!seen || !nodes) {
+        free(seen);
+        if (nodes) {
+            vec_drop(nodes);
+        }
+        return TSP_ERR_ALLOC;
+    }
+
+    for (size_t c = 0; c < delta->len; c++) {
+        size_t ends[2] = {changes[c].from, changes[c].to};
+        if (sparse) {
+            int64_t* weights = sparse->weights->data;
+            weights[sparse_find(sparse, ends[0], ends[1])] = changes[c].weight;
+            weights[sparse_find(sparse, ends[1], ends[0])] = changes[c].weight;
+        } else {
+            int64_t* matrix = config->adjacency_matrix->data;
+            matrix[adj_matrix_index(config, ends[0], ends[1])] =
+                changes[c].weight;
+            matrix[adj_matrix_index(config, ends[1], ends[0])] =
+                changes[c].weight;
+        }
+        for (size_t e = 0; e < 2; e++) {
+            if (!seen[ends[e]]) {
+                seen[ends[e]] = true;
+                if (!vec_push(nodes, &ends[e])) {
+                    free(seen);
+                    vec_drop(nodes);
+                    return TSP_ERR_ALLOC;
+                }
+            }
+        }
+    }
+
+    free(seen);
+    *changed = nodes;
+    return TSP_OK;
+}
+
+tsp_status_t solve_incremental(config_t const* config, solver_t* solver,
+                               options_t const* options,
+                               size_t const* previous, vec_t const* changed)
+{
+    options_t resolved = *options;
+    features_t features;
+    selection_t selection;
+    if (selector_resolve(config, &resolved, &features, &selection)) {
+        return solve_incremental(config, solver, &resolved, previous, changed);
+    }
+
+    // The bound tables the solver holds from the previous instance only
+    // differ on the changed nodes, keep them across the reset of the search
+    // buffers. A new solver has none, and the search computes them.
+    bounds_t* bounds = solver->bounds;
+    solver->bounds = NULL;
+    tsp_status_t status = solver_reset(solver, config->nb_nodes);
+    solver->bounds = bounds;
+    if (status != TSP_OK) {
+        return status;
+    }
+    if (bounds) {
+        bounds_update(bounds, config, changed->data, changed->len);
+    }
+
+    switch (options->engine) {
+    case ENGINE_EXACT:
+        // The previous tour is the incumbent, unless it goes through a
+        // removed edge
+        solver_store_tour(config, solver, previous);
+        solve_tsp(config, solver);
+        return TSP_OK;
+    case ENGINE_HYBRID:
+        solver_store_tour(config, solver, previous);
+        return solve_hybrid(config, solver);
+    case ENGINE_CUT:
+        solver_store_tour(config, solver, previous);
+        return solve_cut(config, solver);
+    case ENGINE_LITTLE:
+        solver_store_tour(config, solver, previous);
+        return solve_little(config, solver, options->time_limit);
+    case ENGINE_CHRISTOFIDES:
+        // The tour is built from scratch
+        return solve_christofides(config, solver);
+    case ENGINE_SPACEFILL:
+        return solve_spacefill(config, solver, options->time_limit);
+    case ENGINE_GENETIC:
+        return solve_genetic(config, solver, options);
+    case ENGINE_LK:
+    case ENGINE_PORTFOLIO:
+        return solve_lk_incremental(config, solver, options->time_limit,
+                                    options->seed, previous, changed->data,
+                                    changed->len);
+    case ENGINE_AUTO:
+        // Resolved above
+        break;
+    }
+    return TSP_ERR_INVALID_ARGUMENT;
+}
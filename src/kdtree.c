@@ -0,0 +1,222 @@
+/**
+ * @file    kdtree.c
+ * @brief   Implementation of `kdtree_t` structure's related functions.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "kdtree.h"
+
+#include <stdlib.h>
+
+// Ranges larger than this are split in parallel OpenMP tasks
+static const size_t KDTREE_TASK_CUTOFF = 1 << 15;
+
+static inline double kdtree_coord(double const* coords, uint32_t point,
+                                  uint8_t dim)
+{
+    return coords[2 * (size_t)point + dim];
+}
+
+// Partially sorts `index[lo, hi)` so that `index[nth]` is the point that
+// would be at this place if the range was sorted along `dim`, with smaller
+// coordinates before it and larger ones after it
+static void kdtree_select(double const* coords, uint32_t* index, size_t lo,
+                          size_t hi, size_t nth, uint8_t dim)
+{
+    while (hi - lo > 1) {
+        // Median of three pivot
+        size_t m = lo + (hi - lo) / 2;
+        double a = kdtree_coord(coords, index[lo], dim);
+        double b = kdtree_coord(coords, index[m], dim);
+        double c = kdtree_coord(coords, index[hi - 1], dim);
+        double pivot = a < b ? (b < c ? b : (a < c ? c : a))
+                             : (a < c ? a : (b < c ? c : b));
+
+        // Hoare partition
+        size_t i = lo;
+        size_t j = hi - 1;
+        while (i <= j) {
+            while (kdtree_coord(coords, index[i], dim) < pivot) {
+                i++;
+            }
+            while (kdtree_coord(coords, index[j], dim) > pivot) {
+                j--;
+            }
+            if (i <= j) {
+                uint32_t tmp = index[i];
+                index[i] = index[j];
+                index[j] = tmp;
+                i++;
+                if (j-- == 0) {
+                    break;
+                }
+            }
+        }
+
+        // Now `[lo, j]` <= pivot <= `[i, hi)`, with `(j, i)` equal to pivot
+        if (nth <= j && j != (size_t)-1) {
+            hi = j + 1;
+        } else if (nth >= i) {
+            lo = i;
+        } else {
+            return;
+        }
+    }
+}
+
+static void kdtree_build_range(kdtree_t* tree, size_t lo, size_t hi)
+{
+    if (hi - lo <= KDTREE_BUCKET) {
+        return;
+    }
+
+    uint32_t* index = tree->index->data;
+    uint8_t* dims = tree->dims->data;
+
+    // Split along the widest dimension of the bounding box
+    double min[2] = {kdtree_coord(tree->coords, index[lo], 0),
+                     kdtree_coord(tree->coords, index[lo], 1)};
+    double max[2] = {min[0], min[1]};
+    for (size_t i = lo + 1; i < hi; i++) {
+        for (uint8_t d = 0; d < 2; d++) {
+            double x = kdtree_coord(tree->coords, index[i], d);
+            min[d] = x < min[d] ? x : min[d];
+            max[d] = x > max[d] ? x : max[d];
+        }
+    }
+    uint8_t dim = (max[1] - min[1]) > (max[0] - min[0]);
+
+    size_t mid = lo + (hi - lo) / 2;
+    kdtree_select(tree->coords, index, lo, hi, mid, dim);
+    dims[mid] = dim;
+
+    if (hi - lo > KDTREE_TASK_CUTOFF) {
+#pragma omp task default(none) firstprivate(tree, lo, mid)
+        kdtree_build_range(tree, lo, mid);
+#pragma omp task default(none) firstprivate(tree, mid, hi)
+        kdtree_build_range(tree, mid, hi);
+#pragma omp taskwait
+    } else {
+        kdtree_build_range(tree, lo, mid);
+        kdtree_build_range(tree, mid, hi);
+    }
+}
+
+kdtree_t* kdtree_build(double const* coords, size_t nb_points)
+{
+    kdtree_t* tree = malloc(sizeof(kdtree_t));
+    if (!tree) {
+        return NULL;
+    }
+
+    tree->nb_points = nb_points;
+    tree->coords = coords;
+    tree->index = vec_with_capacity(nb_points, sizeof(uint32_t));
+    uint8_t initial_dim = 0;
+    tree->dims = vec_with_value(&initial_dim, nb_points, sizeof(uint8_t));
+    if (!tree->index || !tree->dims) {
+        kdtree_destroy(tree);
+        return NULL;
+    }
+
+    tree->index->len = nb_points;
+    uint32_t* index = tree->index->data;
+    for (size_t i = 0; i < nb_points; i++) {
+        index[i] = i;
+    }
+
+#pragma omp parallel
+#pragma omp single
+    kdtree_build_range(tree, 0, nb_points);
+
+    return tree;
+}
+
+void kdtree_destroy(kdtree_t* tree)
+{
+    if (tree) {
+        if (tree->index) {
+            vec_drop(tree->index);
+        }
+        if (tree->dims) {
+            vec_drop(tree->dims);
+        }
+        free(tree);
+    }
+}
+
+typedef struct kdtree_query_t {
+    kdtree_t const* tree;
+    size_t point;
+    double x[2];
+    size_t k;
+    size_t len;
+    uint32_t* nearest;
+    double* distances;
+} kdtree_query_t;
+
+static void kdtree_offer(kdtree_query_t* q, uint32_t point)
+{
+    double dx = kdtree_coord(q->tree->coords, point, 0) - q->x[0];
+    double dy = kdtree_coord(q->tree->coords, point, 1) - q->x[1];
+    double d = dx * dx + dy * dy;
+    if (point == q->point || (q->len == q->k && d >= q->distances[q->k - 1])) {
+        return;
+    }
+
+    size_t p = q->len < q->k ? q->len++ : q->k - 1;
+    while (p > 0 && q->distances[p - 1] > d) {
+        q->distances[p] = q->distances[p - 1];
+        q->nearest[p] = q->nearest[p - 1];
+        p--;
+    }
+    q->distances[p] = d;
+    q->nearest[p] = point;
+}
+
+static void kdtree_search(kdtree_query_t* q, size_t lo, size_t hi)
+{
+    uint32_t const* index = q->tree->index->data;
+    if (hi - lo <= KDTREE_BUCKET) {
+        for (size_t i = lo; i < hi; i++) {
+            kdtree_offer(q, index[i]);
+        }
+        return;
+    }
+
+    size_t mid = lo + (hi - lo) / 2;
+    uint8_t dim = ((uint8_t const*)q->tree->dims->data)[mid];
+    double diff = q->x[dim] - kdtree_coord(q->tree->coords, index[mid], dim);
+    if (diff < 0) {
+        kdtree_search(q, lo, mid);
+        if (q->len < q->k || diff * diff < q->distances[q->k - 1]) {
+            kdtree_search(q, mid, hi);
+        }
+    } else {
+        kdtree_search(q, mid, hi);
+        if (q->len < q->k || diff * diff < q->distances[q->k - 1]) {
+            kdtree_search(q, lo, mid);
+        }
+    }
+}
+
+size_t kdtree_nearest(kdtree_t const* tree, size_t point, size_t k,
+                      uint32_t* nearest, double* distances)
+{
+    if (!k) {
+        return 0;
+    }
+
+    kdtree_query_t q = {
+        .tree = tree,
+        .point = point,
+        .x = {kdtree_coord(tree->coords, point, 0),
+              kdtree_coord(tree->coords, point, 1)},
+        .k = k,
+        .len = 0,
+        .nearest = nearest,
+        .distances = distances,
+    };
+    kdtree_search(&q, 0, tree->nb_points);
+    return q.len;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file    kernel_impl.h
+ * @brief   Template of the branch-and-bound kernel for `KERNEL_N` nodes.
+ *          It is included by `kernels.c` once per specialized size.
+ * @author  Gabriel Dos Santos
+ **/
+
+#ifndef KERNEL_N
+#error "KERNEL_N must be defined before including kernel_impl.h"
+#endif
+
+#define KERNEL_CAT_(a, b) a##b
+#define KERNEL_CAT(a, b) KERNEL_CAT_(a, b)
+#define KERNEL(name) KERNEL_CAT(name, KERNEL_N)
+
+typedef struct KERNEL(kernel_state_) {
+    int64_t weights[KERNEL_N][KERNEL_N];
+    int64_t first[KERNEL_N];
+    int64_t second[KERNEL_N];
+    uint64_t candidates[KERNEL_N];
+    uint8_t path[KERNEL_N + 1];
+    int64_t best_cost;
+    uint64_t explored;
+    size_t nb_nodes;
+    solver_t* solver;
+} KERNEL(kernel_state_);
+
+__attribute__((noinline)) static void
+KERNEL(kernel_search_)(KERNEL(kernel_state_) * s, int64_t bound,
+                                   int64_t weight, size_t level,
+                                   uint64_t visited)
+{
+    PROFILE_ENTER(level);
+    s->explored++;
+    size_t const last = s->path[level - 1];
+
+    // Base case: close the tour back to node 0 and store improvements in the
+    // solver right away
+    if (level == s->nb_nodes) {
+        int64_t loop = s->weights[last][0];
+        if (loop != 0 && weight + loop < s->best_cost) {
+            s->best_cost = weight + loop;
+            for (size_t i = 0; i < level; i++) {
+                vec_i64_set(s->solver->optimal_path, i, s->path[i]);
+            }
+            vec_i64_set(s->solver->optimal_path, level, 0);
+            s->solver->minimum_cost = s->best_cost;
+            s->solver->nb_explored = s->explored;
+            solver_notify_incumbent(s->solver);
+        }
+        PROFILE_EXIT(level);
+        return;
+    }
+
+    int64_t const leave = level == 1 ? s->first[last] : s->second[last];
+    int64_t const* row = s->weights[last];
+
+    // Only the unvisited candidate successors are tried
+    for (uint64_t rest = s->candidates[last] & ~visited; rest;
+         rest &= rest - 1) {
+        size_t const i = __builtin_ctzll(rest);
+        int64_t child_bound = bound - (leave + s->first[i]) / 2;
+        int64_t child_weight = weight + row[i];
+        if (child_bound + child_weight < s->best_cost) {
+            s->path[level] = i;
+            PROFILE_PAUSE();
+            KERNEL(kernel_search_)(s, child_bound, child_weight, level + 1,
+                                   visited | (uint64_t)1 << i);
+            PROFILE_RESUME();
+        }
+    }
+    PROFILE_EXIT(level);
+}
+
+static void KERNEL(kernel_solve_)(config_t const* config, solver_t* solver,
+                                  int64_t root_bound)
+{
+    KERNEL(kernel_state_) s;
+    size_t const n = config->nb_nodes;
+
+    for (size_t i = 0; i < KERNEL_N; i++) {
+        for (size_t j = 0; j < KERNEL_N; j++) {
+            s.weights[i][j] = i < n && j < n ? adj_matrix_get(config, i, j) : 0;
+        }
+        s.first[i] = i < n ? first_min(config, i) : 0;
+        s.second[i] = i < n ? second_min(config, i) : 0;
+    }
+
+    // Successors of every node, as bit sets
+    candidates_t const* candidates = solver->candidates;
+    for (size_t i = 0; i < KERNEL_N; i++) {
+        s.candidates[i] = 0;
+        if (i >= n) {
+            continue;
+        }
+        if (candidates) {
+            for (size_t k = candidates->offsets[i];
+                 k < candidates->offsets[i + 1]; k++) {
+                s.candidates[i] |= (uint64_t)1 << candidates->nodes[k];
+            }
+        } else {
+            for (size_t j = 0; j < n; j++) {
+                if (s.weights[i][j] != 0) {
+                    s.candidates[i] |= (uint64_t)1 << j;
+                }
+            }
+        }
+    }
+
+    uint64_t visited = 1;
+    for (size_t i = n; i < KERNEL_N; i++) {
+        visited |= (uint64_t)1 << i;
+    }
+
+    s.nb_nodes = n;
+    // Start from the incumbent of the solver, if any
+    s.best_cost = solver->minimum_cost;
+    s.explored = solver->nb_explored;
+    s.solver = solver;
+    s.path[0] = 0;
+    KERNEL(kernel_search_)(&s, root_bound, 0, 1, visited);
+    solver->nb_explored = s.explored;
+}
+
+#undef KERNEL
+#undef KERNEL_CAT
+#undef KERNEL_CAT_
+#undef KERNEL_N
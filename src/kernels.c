@@ -0,0 +1,41 @@
+/**
+ * @file    kernels.c
+ * @brief   Instantiation of the branch-and-bound kernels specialized for small
+ *          instances, and their dispatcher.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "kernels.h"
+#include "profile.h"
+#include "utils.h"
+
+#include <stddef.h>
+
+#define KERNEL_N 8
+#include "kernel_impl.h"
+
+#define KERNEL_N 16
+#include "kernel_impl.h"
+
+#define KERNEL_N 32
+#include "kernel_impl.h"
+
+#define KERNEL_N 64
+#include "kernel_impl.h"
+
+bool solve_small(config_t const* config, solver_t* solver, int64_t root_bound)
+{
+    size_t const n = config->nb_nodes;
+    if (n <= 8) {
+        kernel_solve_8(config, solver, root_bound);
+    } else if (n <= 16) {
+        kernel_solve_16(config, solver, root_bound);
+    } else if (n <= 32) {
+        kernel_solve_32(config, solver, root_bound);
+    } else if (n <= KERNELS_MAX_NODES) {
+        kernel_solve_64(config, solver, root_bound);
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,477 @@
+/**
+ * @file    little.c
+ * @brief   Implementation of Little's exact engine.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "little.h"
+#include "pages.h"
+#include "utils.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Reduced cost of the missing, forbidden and excluded edges
+#define LITTLE_INFINITY INT64_MAX
+
+// Changes the search makes to its state, undone in reverse order:
+// - `LITTLE_ENTRY` overwrote entry `index` of the matrix, which was `value`;
+// - `LITTLE_ROW` and `LITTLE_COLUMN` subtracted `value` from the finite
+//   entries of row or column `index` in the active columns or rows;
+// - `LITTLE_REMOVE` removed row `index` and column `value` from the active
+//   ones;
+// - `LITTLE_FIRST` and `LITTLE_LAST` overwrote the entry `index` of `first`
+//   or `last`, which was `value`.
+typedef enum little_op_e {
+    LITTLE_ENTRY,
+    LITTLE_ROW,
+    LITTLE_COLUMN,
+    LITTLE_REMOVE,
+    LITTLE_FIRST,
+    LITTLE_LAST,
+} little_op_t;
+
+typedef struct little_undo_t {
+    little_op_t op;
+    size_t index;
+    int64_t value;
+} little_undo_t;
+
+// The active rows are `rows[0]` to `rows[active - 1]`, and row `i` sits at
+// `rows[row_position[i]]`, the same goes for the columns. The included edges
+// form paths, `first` gives the first node of the path ending at each node
+// and `last` the last node of the path starting at each node, both only
+// meaningful at the ends of the paths. `next` is the successor of each node
+// along the included edges.
+typedef struct little_t {
+    config_t const* config;
+    solver_t* solver;
+    size_t nb_nodes;
+    int64_t* cost;
+    pages_backing_t cost_backing;
+    size_t active;
+    size_t* rows;
+    size_t* columns;
+    size_t* row_position;
+    size_t* column_position;
+    size_t* first;
+    size_t* last;
+    size_t* next;
+    int64_t* row_minimums;
+    int64_t* column_minimums;
+    size_t* tour;
+    little_undo_t* log;
+    size_t log_len;
+    size_t log_capacity;
+    tsp_status_t status;
+    uint64_t explored;
+
+    // Once the deadline passes, the search stops as soon as it holds a tour
+    double deadline;
+    bool expired;
+} little_t;
+
+static int64_t little_add(int64_t a, int64_t b)
+{
+    return a == LITTLE_INFINITY || b == LITTLE_INFINITY ? LITTLE_INFINITY
+                                                        : a + b;
+}
+
+// Records a change, or flags the search as failed if the log cannot grow
+static void little_log(little_t* l, little_op_t op, size_t index,
+                       int64_t value)
+{
+    if (l->log_len == l->log_capacity) {
+        size_t const capacity = 2 * l->log_capacity;
+        little_undo_t* log = realloc(l->log, capacity * sizeof(*log));
+        if (!log) {
+            l->status = TSP_ERR_ALLOC;
+            return;
+        }
+        l->log = log;
+        l->log_capacity = capacity;
+    }
+    l->log[l->log_len++] = (little_undo_t){op, index, value};
+}
+
+static void little_set(little_t* l, size_t index, int64_t value)
+{
+    little_log(l, LITTLE_ENTRY, index, l->cost[index]);
+    l->cost[index] = value;
+}
+
+static void little_remove(little_t* l, size_t i, size_t j)
+{
+    // Swaps the row and the column to the end of the active ones, the
+    // positions of `i` and `j` are kept to swap them back
+    size_t const end = l->active - 1;
+    size_t const p = l->row_position[i];
+    size_t const q = l->column_position[j];
+    size_t const row = l->rows[end];
+    size_t const column = l->columns[end];
+    l->rows[p] = row;
+    l->row_position[row] = p;
+    l->rows[end] = i;
+    l->columns[q] = column;
+    l->column_position[column] = q;
+    l->columns[end] = j;
+    l->active = end;
+    little_log(l, LITTLE_REMOVE, i, (int64_t)j);
+}
+
+// Restores the state as it was when the log held `mark` changes
+static void little_undo(little_t* l, size_t mark)
+{
+    size_t const n = l->nb_nodes;
+    while (l->log_len > mark) {
+        little_undo_t const undo = l->log[--l->log_len];
+        switch (undo.op) {
+        case LITTLE_ENTRY:
+            l->cost[undo.index] = undo.value;
+            break;
+        case LITTLE_ROW:
+            for (size_t c = 0; c < l->active; c++) {
+                int64_t* entry = &l->cost[undo.index * n + l->columns[c]];
+                if (*entry != LITTLE_INFINITY) {
+                    *entry += undo.value;
+                }
+            }
+            break;
+        case LITTLE_COLUMN:
+            for (size_t r = 0; r < l->active; r++) {
+                int64_t* entry = &l->cost[l->rows[r] * n + undo.index];
+                if (*entry != LITTLE_INFINITY) {
+                    *entry += undo.value;
+                }
+            }
+            break;
+        case LITTLE_REMOVE: {
+            size_t const end = l->active;
+            size_t const i = undo.index;
+            size_t const j = (size_t)undo.value;
+            size_t const p = l->row_position[i];
+            size_t const q = l->column_position[j];
+            size_t const row = l->rows[p];
+            size_t const column = l->columns[q];
+            l->rows[end] = row;
+            l->row_position[row] = end;
+            l->rows[p] = i;
+            l->row_position[i] = p;
+            l->columns[end] = column;
+            l->column_position[column] = end;
+            l->columns[q] = j;
+            l->column_position[j] = q;
+            l->active = end + 1;
+            break;
+        }
+        case LITTLE_FIRST:
+            l->first[undo.index] = (size_t)undo.value;
+            break;
+        case LITTLE_LAST:
+            l->last[undo.index] = (size_t)undo.value;
+            break;
+        }
+    }
+}
+
+// Subtracts its minimum from a row, which is returned, `LITTLE_INFINITY`
+// meaning that the row has no edge left
+static int64_t little_reduce_row(little_t* l, size_t i)
+{
+    int64_t* row = &l->cost[i * l->nb_nodes];
+    int64_t minimum = LITTLE_INFINITY;
+    for (size_t c = 0; c < l->active; c++) {
+        if (row[l->columns[c]] < minimum) {
+            minimum = row[l->columns[c]];
+        }
+    }
+    if (minimum == 0 || minimum == LITTLE_INFINITY) {
+        return minimum;
+    }
+    for (size_t c = 0; c < l->active; c++) {
+        if (row[l->columns[c]] != LITTLE_INFINITY) {
+            row[l->columns[c]] -= minimum;
+        }
+    }
+    little_log(l, LITTLE_ROW, i, minimum);
+    return minimum;
+}
+
+static int64_t little_reduce_column(little_t* l, size_t j)
+{
+    size_t const n = l->nb_nodes;
+    int64_t minimum = LITTLE_INFINITY;
+    for (size_t r = 0; r < l->active; r++) {
+        if (l->cost[l->rows[r] * n + j] < minimum) {
+            minimum = l->cost[l->rows[r] * n + j];
+        }
+    }
+    if (minimum == 0 || minimum == LITTLE_INFINITY) {
+        return minimum;
+    }
+    for (size_t r = 0; r < l->active; r++) {
+        int64_t* entry = &l->cost[l->rows[r] * n + j];
+        if (*entry != LITTLE_INFINITY) {
+            *entry -= minimum;
+        }
+    }
+    little_log(l, LITTLE_COLUMN, j, minimum);
+    return minimum;
+}
+
+// Reduces every active row, then every active column, and returns the sum of
+// the amounts subtracted
+static int64_t little_reduce(little_t* l)
+{
+    int64_t total = 0;
+    for (size_t r = 0; r < l->active && total != LITTLE_INFINITY; r++) {
+        total = little_add(total, little_reduce_row(l, l->rows[r]));
+    }
+    for (size_t c = 0; c < l->active && total != LITTLE_INFINITY; c++) {
+        total = little_add(total, little_reduce_column(l, l->columns[c]));
+    }
+    return total;
+}
+
+// Finds the edge of reduced cost 0 whose exclusion raises the bound the
+// most: by the second minimum of its row plus that of its column, as its
+// own entry is the first. Returns its penalty, or -1 if there is none.
+static int64_t little_branching(little_t* l, size_t* best_i, size_t* best_j)
+{
+    size_t const n = l->nb_nodes;
+    size_t const k = l->active;
+    int64_t* row_minimums = l->row_minimums;
+    int64_t* column_minimums = l->column_minimums;
+    for (size_t a = 0; a < 2 * k; a++) {
+        row_minimums[a] = column_minimums[a] = LITTLE_INFINITY;
+    }
+    for (size_t r = 0; r < k; r++) {
+        int64_t const* row = &l->cost[l->rows[r] * n];
+        for (size_t c = 0; c < k; c++) {
+            int64_t const w = row[l->columns[c]];
+            if (w < row_minimums[2 * r + 1]) {
+                if (w < row_minimums[2 * r]) {
+                    row_minimums[2 * r + 1] = row_minimums[2 * r];
+                    row_minimums[2 * r] = w;
+                } else {
+                    row_minimums[2 * r + 1] = w;
+                }
+            }
+            if (w < column_minimums[2 * c + 1]) {
+                if (w < column_minimums[2 * c]) {
+                    column_minimums[2 * c + 1] = column_minimums[2 * c];
+                    column_minimums[2 * c] = w;
+                } else {
+                    column_minimums[2 * c + 1] = w;
+                }
+            }
+        }
+    }
+
+    int64_t best = -1;
+    for (size_t r = 0; r < k; r++) {
+        int64_t const* row = &l->cost[l->rows[r] * n];
+        for (size_t c = 0; c < k; c++) {
+            if (row[l->columns[c]] != 0) {
+                continue;
+            }
+            int64_t const penalty = little_add(row_minimums[2 * r + 1],
+                                               column_minimums[2 * c + 1]);
+            if (penalty > best) {
+                best = penalty;
+                *best_i = l->rows[r];
+                *best_j = l->columns[c];
+            }
+        }
+    }
+    return best;
+}
+
+// Stores the tour the included edges form
+static void little_store(little_t* l)
+{
+    size_t node = 0;
+    for (size_t p = 0; p < l->nb_nodes; p++) {
+        l->tour[p] = node;
+        node = l->next[node];
+    }
+    solver_store_tour(l->config, l->solver, l->tour);
+}
+
+// Stores a nearest neighbor tour from node 0 if it beats the incumbent, so
+// that a time limit reached before the search meets a tour still leaves one
+static tsp_status_t little_nearest(little_t* l)
+{
+    size_t const n = l->nb_nodes;
+    bool* visited = calloc(n, sizeof(bool));
+    if (!visited) {
+        return TSP_ERR_ALLOC;
+    }
+
+    int64_t cost = 0;
+    size_t current = 0;
+    visited[0] = true;
+    l->tour[0] = 0;
+    for (size_t p = 1; p < n && cost != LITTLE_INFINITY; p++) {
+        int64_t const* row = &l->cost[current * n];
+        size_t next = n;
+        for (size_t v = 0; v < n; v++) {
+            if (!visited[v] && (next == n || row[v] < row[next])) {
+                next = v;
+            }
+        }
+        cost = little_add(cost, row[next]);
+        visited[next] = true;
+        l->tour[p] = current = next;
+    }
+    cost = little_add(cost, l->cost[current * n]);
+
+    free(visited);
+    if (cost < l->solver->minimum_cost) {
+        solver_store_tour(l->config, l->solver, l->tour);
+    }
+    return TSP_OK;
+}
+
+static void little_search(little_t* l, int64_t bound)
+{
+    l->explored++;
+    if (l->deadline > 0.0 && !(l->explored & 15) &&
+        wall_time() >= l->deadline) {
+        l->expired = true;
+    }
+    if (l->status != TSP_OK || bound >= l->solver->minimum_cost ||
+        (l->expired && l->solver->minimum_cost != INT64_MAX)) {
+        return;
+    }
+    if (!l->active) {
+        little_store(l);
+        return;
+    }
+
+    size_t const n = l->nb_nodes;
+    size_t i = 0;
+    size_t j = 0;
+    int64_t const penalty = little_branching(l, &i, &j);
+    if (penalty < 0) {
+        return;
+    }
+    size_t const mark = l->log_len;
+
+    // Includes the edge, which joins the path ending at `i` to the one
+    // starting at `j`, and forbids closing the joined path before the others
+    size_t const head = l->first[i];
+    size_t const tail = l->last[j];
+    little_log(l, LITTLE_LAST, head, (int64_t)l->last[head]);
+    little_log(l, LITTLE_FIRST, tail, (int64_t)l->first[tail]);
+    l->last[head] = tail;
+    l->first[tail] = head;
+    l->next[i] = j;
+    little_remove(l, i, j);
+    if (l->active > 1 && l->cost[tail * n + head] != LITTLE_INFINITY) {
+        little_set(l, tail * n + head, LITTLE_INFINITY);
+    }
+    int64_t const increase = little_reduce(l);
+    if (increase != LITTLE_INFINITY) {
+        little_search(l, bound + increase);
+    }
+    little_undo(l, mark);
+
+    // Excludes the edge, which raises the bound by the penalty once its row
+    // and column are reduced again
+    if (penalty != LITTLE_INFINITY &&
+        bound + penalty < l->solver->minimum_cost) {
+        little_set(l, i * n + j, LITTLE_INFINITY);
+        little_reduce_row(l, i);
+        little_reduce_column(l, j);
+        little_search(l, bound + penalty);
+        little_undo(l, mark);
+    }
+}
+
+static void little_destroy(little_t* l)
+{
+    pages_free(l->cost, l->nb_nodes * l->nb_nodes * sizeof(int64_t),
+               l->cost_backing);
+    free(l->rows);
+    free(l->columns);
+    free(l->row_position);
+    free(l->column_position);
+    free(l->first);
+    free(l->last);
+    free(l->next);
+    free(l->row_minimums);
+    free(l->column_minimums);
+    free(l->tour);
+    free(l->log);
+}
+
+tsp_status_t solve_little(config_t const* config, solver_t* solver,
+                          double time_limit)
+{
+    size_t const n = config->nb_nodes;
+    if (n < 2) {
+        solve_tsp(config, solver);
+        return TSP_OK;
+    }
+
+    little_t l = {
+        .config = config,
+        .solver = solver,
+        .nb_nodes = n,
+        .active = n,
+        .rows = malloc(n * sizeof(size_t)),
+        .columns = malloc(n * sizeof(size_t)),
+        .row_position = malloc(n * sizeof(size_t)),
+        .column_position = malloc(n * sizeof(size_t)),
+        .first = malloc(n * sizeof(size_t)),
+        .last = malloc(n * sizeof(size_t)),
+        .next = malloc(n * sizeof(size_t)),
+        .row_minimums = malloc(2 * n * sizeof(int64_t)),
+        .column_minimums = malloc(2 * n * sizeof(int64_t)),
+        .tour = malloc(n * sizeof(size_t)),
+        .log = malloc(4 * n * sizeof(little_undo_t)),
+        .log_capacity = 4 * n,
+        .status = TSP_OK,
+        .deadline = time_limit > 0.0 ? wall_time() + time_limit : 0.0,
+    };
+    l.cost = pages_alloc(n * n * sizeof(int64_t), &l.cost_backing);
+    if (!l.cost || !l.rows || !l.columns || !l.row_position ||
+        !l.column_position || !l.first || !l.last || !l.next ||
+        !l.row_minimums || !l.column_minimums || !l.tour || !l.log) {
+        little_destroy(&l);
+        return TSP_ERR_ALLOC;
+    }
+
+    for (size_t v = 0; v < n; v++) {
+        l.rows[v] = l.columns[v] = v;
+        l.row_position[v] = l.column_position[v] = v;
+        l.first[v] = l.last[v] = v;
+    }
+    for (size_t i = 0; i < n; i++) {
+        int64_t* row = &l.cost[i * n];
+        adj_matrix_row(config, i, row);
+        for (size_t j = 0; j < n; j++) {
+            if (j == i || !row[j]) {
+                row[j] = LITTLE_INFINITY;
+            }
+        }
+    }
+
+    if (time_limit > 0.0 && little_nearest(&l) != TSP_OK) {
+        little_destroy(&l);
+        return TSP_ERR_ALLOC;
+    }
+
+    // Without any edge left in a row or a column, there is no tour
+    int64_t const bound = little_reduce(&l);
+    if (bound != LITTLE_INFINITY) {
+        solver->lower_bound = bound;
+        little_search(&l, bound);
+    }
+    solver->nb_explored = l.explored;
+    tsp_status_t const status = l.status;
+    little_destroy(&l);
+    return status;
+}
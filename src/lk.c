@@ -0,0 +1,719 @@
+/**
+ * @file    lk.c
+ * @brief   Implementation of the Lin-Kernighan-style local search engine.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "lk.h"
+#include "neighbors.h"
+#include "spacefill.h"
+#include "utils.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Weight given to pairs of nodes that are not linked by an edge, so that the
+// local search moves away from them
+static const int64_t LK_NO_EDGE = (int64_t)1 << 40;
+
+// Maximum length of the segments swapped by a kick
+static const size_t LK_KICK_LEN = 50;
+
+// A 2-opt move that replaced the edges `(a, b)` and `(c, d)` by `(a, c)` and
+// `(b, d)`
+typedef struct lk_move_t {
+    size_t a, b, c, d;
+} lk_move_t;
+
+typedef struct lk_t {
+    config_t const* config;
+    size_t n;
+    size_t const* offsets;
+    uint32_t const* neighbors;
+
+    // Array-based tour: `tour[pos[i]] == i`
+    size_t* tour;
+    size_t* pos;
+    int64_t cost;
+
+    // Don't-look bits, the active nodes are kept in a FIFO queue
+    size_t* queue;
+    size_t queue_head;
+    size_t queue_len;
+    bool* queued;
+
+    // Log of the applied moves, used to roll them back
+    lk_move_t* log;
+    size_t log_len;
+    size_t log_capacity;
+
+    // Set to `TSP_ERR_ALLOC` if the log could not grow, in which case the
+    // tour stays valid but its cost is no longer tracked and the search stops
+    tsp_status_t status;
+} lk_t;
+
+static inline int64_t lk_dist(lk_t const* lk, size_t a, size_t b)
+{
+    int64_t w = adj_matrix_get(lk->config, a, b);
+    return (w || a == b) ? w : LK_NO_EDGE;
+}
+
+static inline size_t lk_succ(lk_t const* lk, size_t t)
+{
+    size_t p = lk->pos[t] + 1;
+    return lk->tour[p == lk->n ? 0 : p];
+}
+
+static inline size_t lk_pred(lk_t const* lk, size_t t)
+{
+    size_t p = lk->pos[t];
+    return lk->tour[p == 0 ? lk->n - 1 : p - 1];
+}
+
+static void lk_activate(lk_t* lk, size_t t)
+{
+    if (!lk->queued[t]) {
+        size_t tail = lk->queue_head + lk->queue_len;
+        lk->queue[tail >= lk->n ? tail - lk->n : tail] = t;
+        lk->queue_len++;
+        lk->queued[t] = true;
+    }
+}
+
+static size_t lk_next_active(lk_t* lk)
+{
+    size_t t = lk->queue[lk->queue_head];
+    lk->queue_head = lk->queue_head + 1 == lk->n ? 0 : lk->queue_head + 1;
+    lk->queue_len--;
+    lk->queued[t] = false;
+    return t;
+}
+
+// Reverses the path going forward from position `i` to position `j`.
+// The complementary path is reversed instead when it is shorter, which yields
+// the same cycle with the opposite orientation.
+static void lk_reverse(lk_t* lk, size_t i, size_t j)
+{
+    size_t const n = lk->n;
+    size_t len = (j >= i ? j - i : j + n - i) + 1;
+    if (2 * len > n) {
+        size_t tmp = i;
+        i = j + 1 == n ? 0 : j + 1;
+        j = tmp == 0 ? n - 1 : tmp - 1;
+        len = n - len;
+    }
+
+    for (size_t s = 0; s < len / 2; s++) {
+        size_t a = lk->tour[i];
+        size_t b = lk->tour[j];
+        lk->tour[i] = b;
+        lk->pos[b] = i;
+        lk->tour[j] = a;
+        lk->pos[a] = j;
+        i = i + 1 == n ? 0 : i + 1;
+        j = j == 0 ? n - 1 : j - 1;
+    }
+}
+
+// Replaces the tour edges `(a, b)` and `(c, d)` by `(a, c)` and `(b, d)`.
+// Either `b` and `d` follow `a` and `c`, or they both precede them.
+static void lk_two_opt(lk_t* lk, size_t a, size_t b, size_t c, size_t d)
+{
+    if (b == c) {
+        return;
+    }
+
+    if (lk_succ(lk, a) == b) {
+        lk_reverse(lk, lk->pos[b], lk->pos[c]);
+    } else {
+        lk_reverse(lk, lk->pos[a], lk->pos[d]);
+    }
+}
+
+static void lk_two_opt_move(lk_t* lk, size_t a, size_t b, size_t c, size_t d)
+{
+    if (lk->log_len == lk->log_capacity) {
+        lk_move_t* log =
+            realloc(lk->log, 2 * lk->log_capacity * sizeof(lk_move_t));
+        if (!log) {
+            lk->status = TSP_ERR_ALLOC;
+            lk->log_len = 0;
+        } else {
+            lk->log = log;
+            lk->log_capacity *= 2;
+        }
+    }
+    if (lk->status == TSP_OK) {
+        lk->log[lk->log_len++] = (lk_move_t){a, b, c, d};
+    }
+    lk_two_opt(lk, a, b, c, d);
+}
+
+// Undoes the moves applied since the log had length `mark`, the cost must be
+// restored by the caller
+static void lk_rollback(lk_t* lk, size_t mark)
+{
+    while (lk->log_len > mark) {
+        lk_move_t m = lk->log[--lk->log_len];
+        lk_two_opt(lk, m.a, m.c, m.b, m.d);
+    }
+}
+
+static void lk_activate_since(lk_t* lk, size_t mark)
+{
+    for (size_t m = mark; m < lk->log_len; m++) {
+        lk_activate(lk, lk->log[m].a);
+        lk_activate(lk, lk->log[m].b);
+        lk_activate(lk, lk->log[m].c);
+        lk_activate(lk, lk->log[m].d);
+    }
+}
+
+// Extends the sequential move that removed the edge `(t1, t2)` with a 2-opt
+// step, `gain` being the gain of the move before closing it with an edge back
+// to `t1`.
+// Returns the gain of the first improving closed move, or 0 if there is none,
+// in which case the tour is left unchanged.
+static int64_t lk_step(lk_t* lk, size_t t1, size_t t2, int64_t gain,
+                       size_t depth)
+{
+    size_t const breadth = depth == 0 ? 5 : depth == 1 ? 3 : 1;
+    size_t alternatives[5];
+    int64_t alternatives_gain[5];
+    size_t nb_alternatives = 0;
+
+    bool forward = lk_succ(lk, t1) == t2;
+    for (size_t c = lk->offsets[t2]; c < lk->offsets[t2 + 1]; c++) {
+        size_t t3 = lk->neighbors[c];
+        int64_t g1 = gain - lk_dist(lk, t2, t3);
+        if (g1 <= 0) {
+            break;
+        }
+
+        size_t t4 = forward ? lk_pred(lk, t3) : lk_succ(lk, t3);
+        if (t3 == t1 || t4 == t2) {
+            continue;
+        }
+
+        // Keep the most promising alternatives sorted by decreasing gain
+        int64_t g = g1 + lk_dist(lk, t3, t4);
+        size_t p = nb_alternatives < breadth ? nb_alternatives++ : breadth;
+        while (p > 0 && alternatives_gain[p - 1] < g) {
+            if (p < breadth) {
+                alternatives[p] = alternatives[p - 1];
+                alternatives_gain[p] = alternatives_gain[p - 1];
+            }
+            p--;
+        }
+        if (p < breadth) {
+            alternatives[p] = t3;
+            alternatives_gain[p] = g;
+        }
+    }
+
+    for (size_t a = 0; a < nb_alternatives; a++) {
+        size_t t3 = alternatives[a];
+        size_t t4 = lk_succ(lk, t1) == t2 ? lk_pred(lk, t3) : lk_succ(lk, t3);
+        size_t mark = lk->log_len;
+
+        lk_two_opt_move(lk, t2, t1, t3, t4);
+        int64_t g = alternatives_gain[a];
+        int64_t closed = g - lk_dist(lk, t4, t1);
+        if (closed > 0) {
+            return closed;
+        }
+
+        if (depth + 1 < LK_MAX_DEPTH) {
+            closed = lk_step(lk, t1, t4, g, depth + 1);
+            if (closed > 0) {
+                return closed;
+            }
+        }
+        lk_rollback(lk, mark);
+    }
+
+    return 0;
+}
+
+// Tries to find an improving LK move removing one of the tour edges of `t1`
+static bool lk_improve(lk_t* lk, size_t t1)
+{
+    for (int dir = 0; dir < 2; dir++) {
+        size_t t2 = dir ? lk_pred(lk, t1) : lk_succ(lk, t1);
+        size_t mark = lk->log_len;
+        int64_t gain = lk_step(lk, t1, t2, lk_dist(lk, t1, t2), 0);
+        if (gain > 0) {
+            lk->cost -= gain;
+            lk_activate_since(lk, mark);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Checks whether `t` belongs to the path of `len` nodes starting at `s1`
+static inline bool lk_in_segment(lk_t const* lk, size_t t, size_t s1,
+                                 size_t len)
+{
+    size_t p = lk->pos[t];
+    size_t q = lk->pos[s1];
+    return (p >= q ? p - q : p + lk->n - q) < len;
+}
+
+// Tries to move a segment of 1 to 3 nodes that starts or ends with `t1`
+// between two adjacent nodes, in either orientation
+static bool lk_or_opt(lk_t* lk, size_t t1)
+{
+    for (size_t len = 1; len <= 3; len++) {
+        for (int side = 0; side < 2; side++) {
+            size_t s1 = t1;
+            size_t s2 = t1;
+            for (size_t s = 1; s < len; s++) {
+                if (side) {
+                    s1 = lk_pred(lk, s1);
+                } else {
+                    s2 = lk_succ(lk, s2);
+                }
+            }
+            size_t p = lk_pred(lk, s1);
+            size_t nx = lk_succ(lk, s2);
+            int64_t removed =
+                lk_dist(lk, p, s1) + lk_dist(lk, s2, nx) - lk_dist(lk, p, nx);
+            if (removed <= 0) {
+                continue;
+            }
+
+            for (int end = 0; end < 2; end++) {
+                size_t x = end ? s2 : s1;
+                for (size_t c = lk->offsets[x]; c < lk->offsets[x + 1]; c++) {
+                    size_t y = lk->neighbors[c];
+                    if (lk_dist(lk, x, y) >= removed) {
+                        break;
+                    }
+
+                    for (int e = 0; e < 2; e++) {
+                        size_t u = e ? lk_pred(lk, y) : y;
+                        size_t v = e ? y : lk_succ(lk, y);
+                        if (v == p || lk_in_segment(lk, u, s1, len) ||
+                            lk_in_segment(lk, v, s1, len)) {
+                            continue;
+                        }
+
+                        int64_t base = lk_dist(lk, u, v);
+                        int64_t reversed =
+                            lk_dist(lk, u, s2) + lk_dist(lk, s1, v) - base;
+                        int64_t kept =
+                            lk_dist(lk, u, s1) + lk_dist(lk, s2, v) - base;
+                        int64_t added = reversed < kept ? reversed : kept;
+                        if (added >= removed) {
+                            continue;
+                        }
+
+                        size_t mark = lk->log_len;
+                        if (u == nx) {
+                            lk_two_opt_move(lk, p, s1, nx, v);
+                        } else {
+                            lk_two_opt_move(lk, p, s1, u, v);
+                            lk_two_opt_move(lk, p, u, nx, s2);
+                        }
+                        if (kept <= reversed) {
+                            lk_two_opt_move(lk, u, s2, s1, v);
+                        }
+                        lk->cost -= removed - added;
+                        lk_activate_since(lk, mark);
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// Runs the local search until no active node can be improved anymore or the
+// deadline passes, which leaves the remaining nodes active
+static void lk_local_search(lk_t* lk, double deadline)
+{
+    size_t steps = 0;
+    while (lk->queue_len) {
+        if (deadline > 0.0 && !(++steps & 255) && wall_time() >= deadline) {
+            break;
+        }
+        size_t t = lk_next_active(lk);
+        if (!lk_improve(lk, t) && lk->n >= 8) {
+            lk_or_opt(lk, t);
+        }
+    }
+}
+
+// Applies the first improving 2-opt move that adds an edge between `a` and
+// one of its neighbors, and removes the edge after or before each of them,
+// unless it reverses more than `max_reversal` nodes either way
+static bool lk_two_opt_improve(lk_t* lk, size_t a, size_t max_reversal)
+{
+    for (int forward = 1; forward >= 0; forward--) {
+        size_t b = forward ? lk_succ(lk, a) : lk_pred(lk, a);
+        int64_t const d_ab = lk_dist(lk, a, b);
+        for (size_t k = lk->offsets[a]; k < lk->offsets[a + 1]; k++) {
+            size_t c = lk->neighbors[k];
+            int64_t const d_ac = lk_dist(lk, a, c);
+            if (d_ac >= d_ab) {
+                break;
+            }
+            size_t d = forward ? lk_succ(lk, c) : lk_pred(lk, c);
+            int64_t delta =
+                d_ac + lk_dist(lk, b, d) - d_ab - lk_dist(lk, c, d);
+            if (delta >= 0) {
+                continue;
+            }
+
+            // Forward, the path from `b` to `c` turns around; backward, the
+            // one from `a` to `d`
+            size_t const i = forward ? lk->pos[b] : lk->pos[a];
+            size_t const j = forward ? lk->pos[c] : lk->pos[d];
+            size_t const len = (j >= i ? j - i : j + lk->n - i) + 1;
+            if (len > max_reversal && lk->n - len > max_reversal) {
+                continue;
+            }
+            lk_reverse(lk, i, j);
+            lk->cost += delta;
+            lk_activate(lk, a);
+            lk_activate(lk, b);
+            lk_activate(lk, c);
+            lk_activate(lk, d);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Swaps two short adjacent segments at a random place of the tour (a
+// double-bridge move), then activates the nodes around the new edges
+static void lk_kick(lk_t* lk, uint64_t* rng)
+{
+    size_t const n = lk->n;
+    size_t max_len = n / 4 < LK_KICK_LEN ? n / 4 : LK_KICK_LEN;
+    size_t l1 = 1 + rng_next(rng) % max_len;
+    size_t l2 = 1 + rng_next(rng) % max_len;
+    size_t p0 = rng_next(rng) % n;
+
+    size_t a = lk->tour[p0];
+    size_t b1 = lk->tour[(p0 + 1) % n];
+    size_t b2 = lk->tour[(p0 + l1) % n];
+    size_t c1 = lk->tour[(p0 + l1 + 1) % n];
+    size_t c2 = lk->tour[(p0 + l1 + l2) % n];
+    size_t d = lk->tour[(p0 + l1 + l2 + 1) % n];
+
+    lk->cost += lk_dist(lk, a, c1) + lk_dist(lk, c2, b1) + lk_dist(lk, b2, d) -
+                lk_dist(lk, a, b1) - lk_dist(lk, b2, c1) - lk_dist(lk, c2, d);
+
+    // a B C d -> a C^r B^r d -> a C B^r d -> a C B d
+    lk_two_opt_move(lk, a, b1, c2, d);
+    lk_two_opt_move(lk, a, c2, c1, b2);
+    lk_two_opt_move(lk, c2, b2, b1, d);
+
+    size_t const touched[] = {a, b1, b2, c1, c2, d};
+    for (size_t t = 0; t < sizeof(touched) / sizeof(*touched); t++) {
+        lk_activate(lk, touched[t]);
+    }
+}
+
+lk_t* lk_init(config_t const* config, neighbors_t const* neighbors)
+{
+    size_t const n = config->nb_nodes;
+    lk_t* lk = malloc(sizeof(lk_t));
+    if (!lk) {
+        return NULL;
+    }
+
+    *lk = (lk_t){
+        .config = config,
+        .n = n,
+        .offsets = neighbors->offsets->data,
+        .neighbors = neighbors->nodes->data,
+        .tour = malloc(n * sizeof(size_t)),
+        .pos = malloc(n * sizeof(size_t)),
+        .queue = malloc(n * sizeof(size_t)),
+        .queued = calloc(n, sizeof(bool)),
+        .log_capacity = 1024,
+        .log = malloc(1024 * sizeof(lk_move_t)),
+        .status = TSP_OK,
+    };
+    if (!lk->tour || !lk->pos || !lk->queue || !lk->queued || !lk->log) {
+        lk_destroy(lk);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        lk->tour[i] = i;
+        lk->pos[i] = i;
+    }
+
+    return lk;
+}
+
+void lk_destroy(lk_t* lk)
+{
+    if (lk) {
+        free(lk->log);
+        free(lk->queued);
+        free(lk->queue);
+        free(lk->pos);
+        free(lk->tour);
+        free(lk);
+    }
+}
+
+static void lk_update_cost(lk_t* lk)
+{
+    lk->cost = 0;
+    for (size_t p = 0; p < lk->n; p++) {
+        lk->cost += lk_dist(lk, lk->tour[p], lk->tour[(p + 1) % lk->n]);
+    }
+}
+
+void lk_nearest_neighbor(lk_t* lk, size_t start, uint64_t* rng)
+{
+    size_t const n = lk->n;
+    size_t* unvisited = lk->queue;
+    size_t* index = lk->pos;
+    for (size_t i = 0; i < n; i++) {
+        unvisited[i] = i;
+        index[i] = i;
+    }
+
+    size_t remaining = n;
+    size_t current = start;
+    for (size_t p = 0; p < n; p++) {
+        lk->tour[p] = current;
+
+        // Remove `current` from the unvisited nodes by swapping it with the
+        // last one
+        size_t last = unvisited[--remaining];
+        unvisited[index[current]] = last;
+        index[last] = index[current];
+        index[current] = SIZE_MAX;
+        if (!remaining) {
+            break;
+        }
+
+        // Pick the nearest unvisited candidate, or sometimes the second
+        // nearest one when randomized
+        size_t next = SIZE_MAX;
+        bool skip = rng && (rng_next(rng) & 3) == 0;
+        for (size_t c = lk->offsets[current]; c < lk->offsets[current + 1];
+             c++) {
+            if (index[lk->neighbors[c]] != SIZE_MAX) {
+                next = lk->neighbors[c];
+                if (!skip) {
+                    break;
+                }
+                skip = false;
+            }
+        }
+        if (next == SIZE_MAX) {
+            int64_t min = INT64_MAX;
+            for (size_t u = 0; u < remaining; u++) {
+                int64_t w = lk_dist(lk, current, unvisited[u]);
+                if (w < min) {
+                    min = w;
+                    next = unvisited[u];
+                }
+            }
+        }
+        current = next;
+    }
+
+    for (size_t p = 0; p < n; p++) {
+        lk->pos[lk->tour[p]] = p;
+    }
+    lk_update_cost(lk);
+}
+
+void lk_set_tour(lk_t* lk, size_t const* tour)
+{
+    for (size_t p = 0; p < lk->n; p++) {
+        lk->tour[p] = tour[p];
+        lk->pos[tour[p]] = p;
+    }
+    lk_update_cost(lk);
+}
+
+void lk_get_tour(lk_t const* lk, size_t* tour)
+{
+    memcpy(tour, lk->tour, lk->n * sizeof(size_t));
+}
+
+int64_t lk_cost(lk_t const* lk)
+{
+    return lk->cost;
+}
+
+tsp_status_t lk_status(lk_t const* lk)
+{
+    return lk->status;
+}
+
+void lk_optimize(lk_t* lk, double deadline)
+{
+    if (lk->n < 5) {
+        return;
+    }
+
+    for (size_t i = 0; i < lk->n; i++) {
+        lk_activate(lk, lk->tour[i]);
+    }
+    lk_local_search(lk, deadline);
+    lk->log_len = 0;
+}
+
+void lk_optimize_nodes(lk_t* lk, size_t const* nodes, size_t nb_nodes,
+                       double deadline)
+{
+    if (lk->n < 5) {
+        return;
+    }
+
+    for (size_t i = 0; i < nb_nodes; i++) {
+        lk_activate(lk, nodes[i]);
+    }
+    lk_local_search(lk, deadline);
+    lk->log_len = 0;
+}
+
+uint64_t lk_two_opt_pass(lk_t* lk, size_t max_reversal, double deadline)
+{
+    if (lk->n < 5) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < lk->n; i++) {
+        lk_activate(lk, lk->tour[i]);
+    }
+    uint64_t steps = 0;
+    while (lk->queue_len) {
+        if (deadline > 0.0 && !(++steps & 255) && wall_time() >= deadline) {
+            break;
+        }
+        size_t a = lk_next_active(lk);
+        while (lk_two_opt_improve(lk, a, max_reversal)) {
+        }
+    }
+    return steps;
+}
+
+size_t lk_perturb(lk_t* lk, size_t kicks, double deadline, uint64_t* rng)
+{
+    if (lk->n < 8) {
+        return 0;
+    }
+
+    // Iterated local search: perturb the local optimum and keep the result
+    // only if it is shorter
+    size_t kick = 0;
+    for (; kick < kicks && lk->status == TSP_OK; kick++) {
+        if (deadline > 0.0 && !(kick & 63) && wall_time() >= deadline) {
+            break;
+        }
+
+        int64_t before = lk->cost;
+        lk_kick(lk, rng);
+        lk_local_search(lk, deadline);
+        if (lk->cost >= before) {
+            lk_rollback(lk, 0);
+            lk->cost = before;
+        }
+        lk->log_len = 0;
+    }
+    return kick;
+}
+
+// Optimizes either a nearest neighbor tour, or a previous tour whose changed
+// nodes only are activated, then perturbs it
+static tsp_status_t lk_solve(config_t const* config, solver_t* solver,
+                             double time_limit, uint64_t seed,
+                             size_t const* previous, size_t const* changed,
+                             size_t nb_changed)
+{
+    // The gains of the moves assume that reversing a path keeps its cost
+    if (!adj_matrix_symmetric(config)) {
+        return TSP_ERR_INVALID_ARGUMENT;
+    }
+
+    neighbors_t* neighbors = neighbors_build(config, LK_NEIGHBORS);
+    lk_t* lk = neighbors ? lk_init(config, neighbors) : NULL;
+    size_t* tour = malloc(config->nb_nodes * sizeof(size_t));
+    if (!lk || !tour) {
+        free(tour);
+        lk_destroy(lk);
+        neighbors_destroy(neighbors);
+        return TSP_ERR_ALLOC;
+    }
+
+    uint64_t rng = seed ? seed : 1;
+    double deadline = time_limit > 0.0 ? wall_time() + time_limit : 0.0;
+    tsp_status_t status = TSP_OK;
+    if (previous) {
+        lk_set_tour(lk, previous);
+        lk_optimize_nodes(lk, changed, nb_changed, deadline);
+    } else if (config->coordinates) {
+        // The nearest neighbor heuristic scans the unvisited nodes whenever
+        // the candidates of a node are all visited, which dominates on large
+        // instances, while sorting along a space-filling curve stays O(n log n)
+        status = spacefill_order(config, tour);
+        lk_set_tour(lk, tour);
+        lk_optimize(lk, deadline);
+    } else {
+        lk_nearest_neighbor(lk, 0, NULL);
+        lk_optimize(lk, deadline);
+    }
+    if (status != TSP_OK) {
+        free(tour);
+        lk_destroy(lk);
+        neighbors_destroy(neighbors);
+        return status;
+    }
+    lk_get_tour(lk, tour);
+    solver_store_tour(config, solver, tour);
+
+    // Perturb by rounds so that improvements are stored as they are found
+    size_t kicks = time_limit > 0.0 ? SIZE_MAX
+                   : previous       ? LK_KICKS_PER_NODE * nb_changed
+                                    : LK_KICKS_PER_NODE * lk->n;
+    while (kicks) {
+        int64_t before = lk_cost(lk);
+        size_t round = kicks < LK_KICKS_PER_ROUND ? kicks : LK_KICKS_PER_ROUND;
+        size_t done = lk_perturb(lk, round, deadline, &rng);
+        solver->nb_explored += done;
+        if (lk_cost(lk) < before) {
+            lk_get_tour(lk, tour);
+            solver_store_tour(config, solver, tour);
+        }
+        if (done < round) {
+            break;
+        }
+        kicks -= round;
+    }
+    status = lk_status(lk);
+
+    free(tour);
+    lk_destroy(lk);
+    neighbors_destroy(neighbors);
+    return status;
+}
+
+tsp_status_t solve_lk(config_t const* config, solver_t* solver,
+                      double time_limit, uint64_t seed)
+{
+    return lk_solve(config, solver, time_limit, seed, NULL, NULL, 0);
+}
+
+tsp_status_t solve_lk_incremental(config_t const* config, solver_t* solver,
+                                  double time_limit, uint64_t seed,
+                                  size_t const* previous,
+                                  size_t const* changed, size_t nb_changed)
+{
+    return lk_solve(config, solver, time_limit, seed, previous, changed,
+                    nb_changed);
+}
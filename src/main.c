@@ -4,38 +4,305 @@
  * @author  Gabriel Dos Santos
  **/
 
+#include "cache.h"
 #include "config.h"
+#include "events.h"
+#include "incremental.h"
+#include "options.h"
+#include "pages.h"
+#include "perf.h"
+#include "reorder.h"
+#include "selector.h"
+#include "server.h"
 #include "solver.h"
+#include "status.h"
+#include "tsp.h"
 
 #include <limits.h>
+#include <signal.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
 
+// Phases measured by the hardware performance counters
+typedef enum phase_t {
+    PHASE_LOAD,
+    PHASE_BOUNDS,
+    PHASE_SEARCH,
+    NB_PHASES,
+} phase_t;
+
+static char const* const PHASE_NAMES[NB_PHASES] = {
+    [PHASE_LOAD] = "load",
+    [PHASE_BOUNDS] = "bounds",
+    [PHASE_SEARCH] = "search",
+};
+
 int main(int argc, char* argv[argc + 1])
 {
-    if (argc < 2) {
-        return printf("Usage: %s <CONFIG_FILE>\n", argv[0]), 1;
+    options_t options;
+    if (!options_parse(&options, argc, argv)) {
+        return options_usage(argv[0]), 1;
+    }
+
+    if (options.socket_path) {
+        tsp_status_t status = server_run(&options);
+        if (status != TSP_OK) {
+            fprintf(stderr,
+                    "\033[1;31merror:\033[0m failed to serve on `%s`: %s\n",
+                    options.socket_path, tsp_strerror(status));
+            return 1;
+        }
+        return 0;
+    }
+
+    perf_t perf;
+    bool counting = options.perf_counters && perf_open(&perf);
+    if (options.perf_counters && !counting) {
+        fprintf(stderr, "\033[1;33mwarning:\033[0m hardware performance "
+                        "counters are not available\n");
+    }
+    perf_counts_t counts[NB_PHASES];
+    bool measured[NB_PHASES] = {false};
+
+    if (counting) {
+        perf_start(&perf);
+    }
+    config_t* config;
+    tsp_status_t status = config_load(options.config_file, &config);
+    if (status != TSP_OK) {
+        fprintf(stderr, "\033[1;31merror:\033[0m failed to load `%s`: %s\n",
+                options.config_file, tsp_strerror(status));
+        if (counting) {
+            perf_close(&perf);
+        }
+        return 1;
+    }
+
+    // Incremental re-solve: apply the changed edges to the instance
+    vec_t* previous = NULL;
+    vec_t* changed = NULL;
+    if (options.delta_file) {
+        vec_t* delta = NULL;
+        char const* file = options.delta_file;
+        status = delta_load(file, config->nb_nodes, &delta);
+        if (status == TSP_OK) {
+            status = delta_apply(config, delta, &changed);
+            vec_drop(delta);
+        }
+        if (status == TSP_OK) {
+            file = options.previous_file;
+            status = tour_load(file, config->nb_nodes, &previous);
+        }
+        if (status != TSP_OK) {
+            fprintf(stderr,
+                    "\033[1;31merror:\033[0m failed to load `%s`: %s\n",
+                    file, tsp_strerror(status));
+            if (changed) {
+                vec_drop(changed);
+            }
+            if (counting) {
+                perf_close(&perf);
+            }
+            config_destroy(config);
+            return 1;
+        }
+    }
+
+    // Renumber large instances so that nearby nodes have nearby rows, along
+    // with the previous tour and changed nodes of an incremental re-solve
+    status = reorder_config(config);
+    if (status == TSP_OK && previous) {
+        status = reorder_rename(config, previous->data, previous->len);
+    }
+    if (status == TSP_OK && changed) {
+        status = reorder_rename(config, changed->data, changed->len);
+    }
+    if (status != TSP_OK) {
+        fprintf(stderr, "\033[1;31merror:\033[0m failed to renumber `%s`: %s\n",
+                options.config_file, tsp_strerror(status));
+        if (previous) {
+            vec_drop(previous);
+            vec_drop(changed);
+        }
+        if (counting) {
+            perf_close(&perf);
+        }
+        config_destroy(config);
+        return 1;
+    }
+    if (counting) {
+        perf_stop(&perf, &counts[PHASE_LOAD]);
+        measured[PHASE_LOAD] = true;
     }
 
-    config_t* config = config_load(argv[1]);
     config_print(config);
+
+    // The automatic engine is picked once the instance is loaded, so that the
+    // cache and the bound tables see the engine that actually runs
+    features_t features;
+    selection_t selection;
+    if (selector_resolve(config, &options, &features, &selection)) {
+        selector_print(&features, &selection);
+    }
+
     solver_t* solver = solver_init(config->nb_nodes);
+    if (!solver) {
+        fprintf(stderr, "\033[1;31merror:\033[0m %s\n",
+                tsp_strerror(TSP_ERR_ALLOC));
+        if (counting) {
+            perf_close(&perf);
+        }
+        config_destroy(config);
+        return 1;
+    }
+    solver->labels = config->labels;
+
+    // Improvements are streamed by the writer thread of the event stream. A
+    // reader leaving the pipe makes the writes fail instead of killing the
+    // process.
+    events_t* events = NULL;
+    if (options.events_file) {
+        signal(SIGPIPE, SIG_IGN);
+        events = events_open(options.events_file, config->nb_nodes);
+        if (!events) {
+            fprintf(stderr,
+                    "\033[1;31merror:\033[0m cannot write events to `%s`\n",
+                    options.events_file);
+            if (counting) {
+                perf_close(&perf);
+            }
+            solver_destroy(solver);
+            config_destroy(config);
+            return 1;
+        }
+        solver->on_incumbent = events_on_incumbent;
+        solver->incumbent_data = events;
+    }
+
+    cache_t* cache = NULL;
+    if (options.cache_dir) {
+        cache = cache_open(options.cache_dir, options.cache_limit);
+        if (!cache) {
+            fprintf(stderr,
+                    "\033[1;33mwarning:\033[0m cannot use the cache `%s`\n",
+                    options.cache_dir);
+        }
+    }
 
     struct timespec before, after;
     clock_gettime(CLOCK_MONOTONIC_RAW, &before);
-    solve_tsp(config, solver);
+    bool cached = cache && cache_lookup(cache, config, &options, solver);
+
+    // The exact engines keep the bound tables and candidate edges they are
+    // given, compute them as a phase of their own. An incremental re-solve
+    // owns them instead: it only updates the tables the solver already holds,
+    // and eliminates edges with the previous tour as its incumbent.
+    if (!cached && !previous &&
+        (options.engine == ENGINE_EXACT || options.engine == ENGINE_HYBRID)) {
+        if (counting) {
+            perf_start(&perf);
+        }
+        solver->bounds = bounds_init(config);
+        solver->candidates = candidates_init(config, solver);
+        if (counting) {
+            perf_stop(&perf, &counts[PHASE_BOUNDS]);
+            measured[PHASE_BOUNDS] = true;
+        }
+    }
+
+    if (counting && !cached) {
+        perf_start(&perf);
+    }
+    if (!cached && previous) {
+        status = solve_incremental(config, solver, &options, previous->data,
+                                   changed);
+    } else if (!cached) {
+        status = tsp_dispatch(config, solver, &options);
+    }
+    if (counting && !cached) {
+        perf_stop(&perf, &counts[PHASE_SEARCH]);
+        measured[PHASE_SEARCH] = true;
+    }
     clock_gettime(CLOCK_MONOTONIC_RAW, &after);
+    if (!events_close(events)) {
+        fprintf(stderr,
+                "\033[1;33mwarning:\033[0m cannot write events to `%s`\n",
+                options.events_file);
+    }
+    if (status != TSP_OK) {
+        fprintf(stderr, "\033[1;31merror:\033[0m %s engine failed: %s\n",
+                engine_name(options.engine), tsp_strerror(status));
+        if (previous) {
+            vec_drop(previous);
+            vec_drop(changed);
+        }
+        if (counting) {
+            perf_close(&perf);
+        }
+        cache_close(cache);
+        solver_destroy(solver);
+        config_destroy(config);
+        return 1;
+    }
+    if (cache && !cached && cache_store(cache, config, &options, solver)) {
+        fprintf(stderr,
+                "\033[1;33mwarning:\033[0m cannot store the result in `%s`\n",
+                options.cache_dir);
+    }
 
     solver_print(solver);
+    if (solver->candidates) {
+        printf("Eliminated %zu of %zu edges before the search, the others "
+               "are kept on %s\n",
+               solver->candidates->nb_eliminated,
+               solver->candidates->nb_edges,
+               pages_name(solver->candidates->backing));
+    }
+    if (options.engine == ENGINE_CHRISTOFIDES && !cached &&
+        solver->lower_bound > 0) {
+        printf("Lower bound: %ld (the tour costs at most %.3f times the "
+               "optimum)\n",
+               solver->lower_bound,
+               (double)solver->minimum_cost / solver->lower_bound);
+    }
+    if ((options.engine == ENGINE_CUT || options.engine == ENGINE_LITTLE) &&
+        !cached && solver->lower_bound > 0) {
+        // A time limit may stop `little` before it proves its tour optimal
+        bool const proven =
+            options.engine == ENGINE_CUT || options.time_limit <= 0.0;
+        printf("Lower bound at the root: %ld (%.2f%% below the %s)\n",
+               solver->lower_bound,
+               100.0 * (solver->minimum_cost - solver->lower_bound) /
+                   solver->minimum_cost,
+               proven ? "optimum" : "tour");
+    }
+    if (cached) {
+        printf("Result read from the cache `%s`\n", options.cache_dir);
+    }
     double elapsed = after.tv_sec - before.tv_sec + (after.tv_nsec - before.tv_nsec) / 1e9;
     if (elapsed < 0.001) {
         printf("Finished in %.3lfµs\n", elapsed * 1000000);
     } else {
         printf("Finished in %.3lfs\n", elapsed);
     }
+    if (counting) {
+        printf("\n");
+        perf_print_header();
+        for (size_t p = 0; p < NB_PHASES; p++) {
+            if (measured[p]) {
+                perf_print(PHASE_NAMES[p], &counts[p]);
+            }
+        }
+        perf_close(&perf);
+    }
 
+    if (previous) {
+        vec_drop(previous);
+        vec_drop(changed);
+    }
+    cache_close(cache);
     solver_destroy(solver);
     config_destroy(config);
     return 0;
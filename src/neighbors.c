@@ -0,0 +1,171 @@
+/**
+ * @file    neighbors.c
+ * @brief   Implementation of `neighbors_t` structure's related functions.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "neighbors.h"
+#include "kdtree.h"
+#include "utils.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Fills `lists[i * k]` with the neighbors of every node using the k-d tree,
+// all the pairs of nodes being linked in Euclidean instances
+static bool neighbors_from_kdtree(config_t const* config, size_t k,
+                                  uint32_t* lists, size_t* counts)
+{
+    size_t const n = config->nb_nodes;
+    kdtree_t* tree = kdtree_build(config->coordinates->data, n);
+    if (!tree) {
+        return false;
+    }
+
+    bool ok = true;
+#pragma omp parallel
+    {
+        double* distances = malloc(k * sizeof(double));
+        if (!distances) {
+#pragma omp atomic write
+            ok = false;
+        }
+#pragma omp for schedule(dynamic, 1024)
+        for (size_t i = 0; i < n; i++) {
+            if (distances) {
+                counts[i] =
+                    kdtree_nearest(tree, i, k, lists + i * k, distances);
+            }
+        }
+        free(distances);
+    }
+
+    kdtree_destroy(tree);
+    return ok;
+}
+
+// Fills `lists[i * k]` with the neighbors of every node by scanning its row of
+// the adjacency matrix, or its adjacency list
+static bool neighbors_from_matrix(config_t const* config, size_t k,
+                                  uint32_t* lists, size_t* counts)
+{
+    size_t const n = config->nb_nodes;
+
+    bool ok = true;
+#pragma omp parallel
+    {
+        int64_t* weights = malloc(k * sizeof(int64_t));
+        if (!weights) {
+#pragma omp atomic write
+            ok = false;
+        }
+#pragma omp for schedule(dynamic, 64)
+        for (size_t i = 0; i < n; i++) {
+            if (!weights) {
+                continue;
+            }
+
+            uint32_t* list = lists + i * k;
+            size_t len = 0;
+
+            // Keep the `k` best candidates sorted with an insertion sort, most
+            // nodes are rejected by the first comparison. Sparse instances
+            // only go through their adjacency lists.
+            sparse_t const* sparse = config->sparse;
+            size_t begin = 0;
+            size_t end = n;
+            if (sparse) {
+                begin = sparse->offsets->data[i];
+                end = sparse->offsets->data[i + 1];
+            }
+            for (size_t e = begin; e < end; e++) {
+                size_t const j = sparse ? (size_t)sparse->targets->data[e] : e;
+                int64_t w = sparse ? sparse->weights->data[e]
+                                   : adj_matrix_get(config, i, j);
+                if (i == j || w == 0 || (len == k && w >= weights[k - 1])) {
+                    continue;
+                }
+
+                size_t p = len < k ? len++ : k - 1;
+                while (p > 0 && weights[p - 1] > w) {
+                    weights[p] = weights[p - 1];
+                    list[p] = list[p - 1];
+                    p--;
+                }
+                weights[p] = w;
+                list[p] = j;
+            }
+            counts[i] = len;
+        }
+        free(weights);
+    }
+
+    return ok;
+}
+
+neighbors_t* neighbors_build(config_t const* config, size_t k)
+{
+    neighbors_t* neighbors = malloc(sizeof(neighbors_t));
+    if (!neighbors) {
+        return NULL;
+    }
+
+    size_t const n = config->nb_nodes;
+    if (k > n - 1) {
+        k = n - 1;
+    }
+    neighbors->nb_nodes = n;
+    neighbors->offsets = vec_with_capacity(n + 1, sizeof(size_t));
+    neighbors->nodes = vec_with_capacity(n * k, sizeof(uint32_t));
+    size_t* counts = malloc(n * sizeof(size_t));
+    if (!neighbors->offsets || (k && !neighbors->nodes) || !counts) {
+        free(counts);
+        neighbors_destroy(neighbors);
+        return NULL;
+    }
+
+    uint32_t* lists = neighbors->nodes->data;
+    bool ok = true;
+    if (!k) {
+        for (size_t i = 0; i < n; i++) {
+            counts[i] = 0;
+        }
+    } else if (config->coordinates) {
+        ok = neighbors_from_kdtree(config, k, lists, counts);
+    } else {
+        ok = neighbors_from_matrix(config, k, lists, counts);
+    }
+    if (!ok) {
+        free(counts);
+        neighbors_destroy(neighbors);
+        return NULL;
+    }
+
+    // Compact the lists in place, they only move towards the front
+    size_t* offsets = neighbors->offsets->data;
+    offsets[0] = 0;
+    for (size_t i = 0; i < n; i++) {
+        for (size_t c = 0; c < counts[i]; c++) {
+            lists[offsets[i] + c] = lists[i * k + c];
+        }
+        offsets[i + 1] = offsets[i] + counts[i];
+    }
+    neighbors->offsets->len = n + 1;
+    neighbors->nodes->len = offsets[n];
+
+    free(counts);
+    return neighbors;
+}
+
+void neighbors_destroy(neighbors_t* neighbors)
+{
+    if (neighbors) {
+        if (neighbors->offsets) {
+            vec_drop(neighbors->offsets);
+        }
+        if (neighbors->nodes) {
+            vec_drop(neighbors->nodes);
+        }
+        free(neighbors);
+    }
+}
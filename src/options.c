@@ -0,0 +1,225 @@
+/**
+ * @file    options.c
+ * @brief   Implementation of `options_t` structure's related functions.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "options.h"
+#include "cache.h"
+#include "server.h"
+
+#include <ctype.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char const* const ENGINE_NAMES[] = {
+    [ENGINE_EXACT] = "exact",
+    [ENGINE_LK] = "lk",
+    [ENGINE_PORTFOLIO] = "portfolio",
+    [ENGINE_HYBRID] = "hybrid",
+    [ENGINE_CHRISTOFIDES] = "christofides",
+    [ENGINE_SPACEFILL] = "spacefill",
+    [ENGINE_GENETIC] = "genetic",
+    [ENGINE_CUT] = "cut",
+    [ENGINE_LITTLE] = "little",
+    [ENGINE_AUTO] = "auto",
+};
+
+static const size_t NB_ENGINES = sizeof(ENGINE_NAMES) / sizeof(*ENGINE_NAMES);
+
+char const* engine_name(engine_t engine)
+{
+    return ENGINE_NAMES[engine];
+}
+
+bool engine_parse(char const* name, engine_t* engine)
+{
+    for (size_t e = 0; e < NB_ENGINES; e++) {
+        if (!strcmp(name, ENGINE_NAMES[e])) {
+            *engine = (engine_t)e;
+            return true;
+        }
+    }
+    return false;
+}
+
+void options_usage(char const* program)
+{
+    printf("Usage: %s [OPTIONS] <CONFIG_FILE>\n"
+           "       %s [OPTIONS] --serve <SOCKET>\n"
+           "\n"
+           "Options:\n"
+           "  -e, --engine <ENGINE>      Solving engine: exact (default), lk,\n"
+           "                             portfolio, hybrid, christofides,\n"
+           "                             spacefill, genetic, cut, little,\n"
+           "                             auto (picked from the instance)\n"
+           "  -t, --time-limit <SECS>    Time limit of heuristic engines\n"
+           "  -s, --seed <SEED>          Seed of heuristic engines\n"
+           "  -j, --threads <N>          Threads of parallel engines\n"
+           "  -c, --target-cost <COST>   Stop parallel engines at this cost\n"
+           "  -S, --serve <SOCKET>       Serve requests on a Unix socket\n"
+           "  -w, --workers <N>          Worker threads of the server\n"
+           "  -C, --cache <DIR>          Reuse and store results in DIR\n"
+           "  -L, --cache-limit <N>      Maximum number of cached results\n"
+           "  -P, --previous <FILE>      Previous tour to re-solve from\n"
+           "  -D, --delta <FILE>         Edges changed since previous tour\n"
+           "  -p, --perf-counters        Print hardware counters per phase\n"
+           "  -E, --events <FILE>        Write improvements as JSON lines\n"
+           "  -h, --help                 Print this message\n",
+           program, program);
+}
+
+bool options_parse(options_t* options, int argc, char* argv[argc + 1])
+{
+    static struct option const long_options[] = {
+        {"engine", required_argument, NULL, 'e'},
+        {"time-limit", required_argument, NULL, 't'},
+        {"seed", required_argument, NULL, 's'},
+        {"threads", required_argument, NULL, 'j'},
+        {"target-cost", required_argument, NULL, 'c'},
+        {"serve", required_argument, NULL, 'S'},
+        {"workers", required_argument, NULL, 'w'},
+        {"cache", required_argument, NULL, 'C'},
+        {"cache-limit", required_argument, NULL, 'L'},
+        {"previous", required_argument, NULL, 'P'},
+        {"delta", required_argument, NULL, 'D'},
+        {"perf-counters", no_argument, NULL, 'p'},
+        {"events", required_argument, NULL, 'E'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    options->config_file = NULL;
+    options->socket_path = NULL;
+    options->workers = SERVER_DEFAULT_WORKERS;
+    options->cache_dir = NULL;
+    options->cache_limit = CACHE_DEFAULT_ENTRIES;
+    options->previous_file = NULL;
+    options->delta_file = NULL;
+    options->engine = ENGINE_EXACT;
+    options->time_limit = 0.0;
+    options->seed = 1;
+    options->threads = 0;
+    options->target_cost = INT64_MIN;
+    options->perf_counters = false;
+    options->events_file = NULL;
+
+    int opt;
+    char* end;
+    while ((opt = getopt_long(argc, argv, "e:t:s:j:c:S:w:C:L:P:D:pE:h",
+                              long_options, NULL)) != -1) {
+        switch (opt) {
+        case 'e':
+            if (!engine_parse(optarg, &options->engine)) {
+                fprintf(stderr,
+                        "\033[1;31merror:\033[0m unknown engine `%s`\n",
+                        optarg);
+                return false;
+            }
+            break;
+        case 't':
+            options->time_limit = strtod(optarg, &end);
+            if (end == optarg || *end || !(options->time_limit >= 0.0)) {
+                fprintf(stderr,
+                        "\033[1;31merror:\033[0m invalid time limit `%s`\n",
+                        optarg);
+                return false;
+            }
+            break;
+        case 's':
+            options->seed = strtoull(optarg, &end, 10);
+            if (end == optarg || *end) {
+                fprintf(stderr, "\033[1;31merror:\033[0m invalid seed `%s`\n",
+                        optarg);
+                return false;
+            }
+            break;
+        case 'j':
+            // `strtoull` would wrap negative numbers around to huge counts
+            end = optarg;
+            if (isdigit((unsigned char)*optarg)) {
+                options->threads = strtoull(optarg, &end, 10);
+            }
+            if (end == optarg || *end) {
+                fprintf(stderr,
+                        "\033[1;31merror:\033[0m invalid number of threads "
+                        "`%s`\n",
+                        optarg);
+                return false;
+            }
+            break;
+        case 'c':
+            options->target_cost = strtoll(optarg, &end, 10);
+            if (end == optarg || *end) {
+                fprintf(stderr,
+                        "\033[1;31merror:\033[0m invalid target cost `%s`\n",
+                        optarg);
+                return false;
+            }
+            break;
+        case 'S':
+            options->socket_path = optarg;
+            break;
+        case 'w':
+            end = optarg;
+            if (isdigit((unsigned char)*optarg)) {
+                options->workers = strtoull(optarg, &end, 10);
+            }
+            if (end == optarg || *end || !options->workers) {
+                fprintf(stderr,
+                        "\033[1;31merror:\033[0m invalid number of workers "
+                        "`%s`\n",
+                        optarg);
+                return false;
+            }
+            break;
+        case 'C':
+            options->cache_dir = optarg;
+            break;
+        case 'L':
+            end = optarg;
+            if (isdigit((unsigned char)*optarg)) {
+                options->cache_limit = strtoull(optarg, &end, 10);
+            }
+            if (end == optarg || *end || !options->cache_limit) {
+                fprintf(stderr,
+                        "\033[1;31merror:\033[0m invalid cache limit `%s`\n",
+                        optarg);
+                return false;
+            }
+            break;
+        case 'P':
+            options->previous_file = optarg;
+            break;
+        case 'D':
+            options->delta_file = optarg;
+            break;
+        case 'p':
+            options->perf_counters = true;
+            break;
+        case 'E':
+            options->events_file = optarg;
+            break;
+        default:
+            return false;
+        }
+    }
+
+    if (!options->previous_file != !options->delta_file) {
+        fprintf(stderr, "\033[1;31merror:\033[0m --previous and --delta must "
+                        "be given together\n");
+        return false;
+    }
+    if (options->socket_path) {
+        return optind == argc;
+    }
+    if (optind != argc - 1) {
+        return false;
+    }
+    options->config_file = argv[optind];
+
+    return true;
+}
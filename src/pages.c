@@ -0,0 +1,116 @@
+/**
+ * @file    pages.c
+ * @brief   Implementation of the huge page allocator.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "pages.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// Whether the kernel hands out transparent huge pages to the buffers advised
+// to use them, according to its `enabled` setting (`always` or `madvise`)
+static bool pages_transparent_enabled(void)
+{
+    FILE* fp = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+    if (!fp) {
+        return false;
+    }
+    char buf[64] = "";
+    bool const read = fgets(buf, sizeof(buf), fp) != NULL;
+    fclose(fp);
+    return read && !strstr(buf, "[never]");
+}
+
+void* pages_alloc(size_t size, pages_backing_t* backing)
+{
+    *backing = PAGES_HEAP;
+    if (size < PAGES_HUGE_SIZE) {
+        return malloc(size ? size : 1);
+    }
+    size_t const rounded =
+        (size + PAGES_HUGE_SIZE - 1) & ~(PAGES_HUGE_SIZE - 1);
+
+#if defined(__linux__) && defined(MAP_HUGETLB)
+    // Fails right away when no huge page is reserved in the pool
+    void* mapped = mmap(NULL, rounded, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mapped != MAP_FAILED) {
+        *backing = PAGES_HUGETLB;
+        return mapped;
+    }
+#endif
+
+    void* data = aligned_alloc(PAGES_HUGE_SIZE, rounded);
+    if (!data) {
+        return NULL;
+    }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (!madvise(data, rounded, MADV_HUGEPAGE) &&
+        pages_transparent_enabled()) {
+        *backing = PAGES_TRANSPARENT;
+    }
+#endif
+    return data;
+}
+
+void pages_free(void* data, size_t size, pages_backing_t backing)
+{
+    if (!data) {
+        return;
+    }
+#if defined(__linux__) && defined(MAP_HUGETLB)
+    if (backing == PAGES_HUGETLB) {
+        munmap(data, (size + PAGES_HUGE_SIZE - 1) & ~(PAGES_HUGE_SIZE - 1));
+        return;
+    }
+#else
+    (void)size;
+    (void)backing;
+#endif
+    free(data);
+}
+
+vec_i64_t* pages_vec_i64(size_t capacity, pages_backing_t* backing)
+{
+    *backing = PAGES_HEAP;
+    vec_i64_t* vec = malloc(sizeof(vec_i64_t));
+    if (!vec) {
+        return NULL;
+    }
+    vec->len = 0;
+    vec->capacity = capacity;
+    vec->data = pages_alloc(capacity * sizeof(int64_t), backing);
+    if (!vec->data) {
+        free(vec);
+        return NULL;
+    }
+    return vec;
+}
+
+void pages_vec_i64_drop(vec_i64_t* vec, pages_backing_t backing)
+{
+    if (vec) {
+        pages_free(vec->data, vec->capacity * sizeof(int64_t), backing);
+        free(vec);
+    }
+}
+
+char const* pages_name(pages_backing_t backing)
+{
+    switch (backing) {
+    case PAGES_HUGETLB:
+        return "explicit huge pages";
+    case PAGES_TRANSPARENT:
+        return "transparent huge pages";
+    default:
+        return "ordinary pages";
+    }
+}
@@ -0,0 +1,149 @@
+/**
+ * @file    perf.c
+ * @brief   Implementation of the hardware performance counters.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "perf.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} PERF_EVENTS[PERF_NB_COUNTERS] = {
+    [PERF_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    [PERF_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    [PERF_L1D_MISSES] = {PERF_TYPE_HW_CACHE,
+                         PERF_COUNT_HW_CACHE_L1D |
+                             PERF_COUNT_HW_CACHE_OP_READ << 8 |
+                             PERF_COUNT_HW_CACHE_RESULT_MISS << 16},
+    [PERF_LLC_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    [PERF_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+#endif
+
+static char const* const PERF_NAMES[PERF_NB_COUNTERS] = {
+    [PERF_CYCLES] = "cycles",
+    [PERF_INSTRUCTIONS] = "instructions",
+    [PERF_L1D_MISSES] = "L1D misses",
+    [PERF_LLC_MISSES] = "LLC misses",
+    [PERF_BRANCH_MISSES] = "branch misses",
+};
+
+bool perf_open(perf_t* perf)
+{
+    bool available = false;
+    for (size_t c = 0; c < PERF_NB_COUNTERS; c++) {
+        perf->fds[c] = -1;
+#ifdef __linux__
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_EVENTS[c].type;
+        attr.config = PERF_EVENTS[c].config;
+        attr.disabled = 1;
+        // Only the calling thread is counted: inherited counters only add the
+        // counts of a thread once it exits, which the threads of the OpenMP
+        // pool never do before the phases are read
+        attr.inherit = 0;
+        // Only user space can be counted by unprivileged users
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format =
+            PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        perf->fds[c] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        available |= perf->fds[c] >= 0;
+#endif
+    }
+    return available;
+}
+
+void perf_start(perf_t const* perf)
+{
+#ifdef __linux__
+    for (size_t c = 0; c < PERF_NB_COUNTERS; c++) {
+        if (perf->fds[c] >= 0) {
+            ioctl(perf->fds[c], PERF_EVENT_IOC_RESET, 0);
+            ioctl(perf->fds[c], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#else
+    (void)perf;
+#endif
+}
+
+void perf_stop(perf_t const* perf, perf_counts_t* counts)
+{
+    for (size_t c = 0; c < PERF_NB_COUNTERS; c++) {
+        counts->valid[c] = false;
+        counts->values[c] = 0;
+#ifdef __linux__
+        if (perf->fds[c] < 0) {
+            continue;
+        }
+        ioctl(perf->fds[c], PERF_EVENT_IOC_DISABLE, 0);
+
+        // Value, time enabled and time running
+        uint64_t data[3];
+        if (read(perf->fds[c], data, sizeof(data)) != sizeof(data) ||
+            !data[2]) {
+            continue;
+        }
+        counts->valid[c] = true;
+        counts->values[c] =
+            data[2] < data[1]
+                ? (uint64_t)((double)data[0] * data[1] / data[2])
+                : data[0];
+#else
+        (void)perf;
+#endif
+    }
+}
+
+void perf_close(perf_t* perf)
+{
+    for (size_t c = 0; c < PERF_NB_COUNTERS; c++) {
+#ifdef __linux__
+        if (perf->fds[c] >= 0) {
+            close(perf->fds[c]);
+        }
+#endif
+        perf->fds[c] = -1;
+    }
+}
+
+void perf_print_header(void)
+{
+    printf("%-8s", "phase");
+    for (size_t c = 0; c < PERF_NB_COUNTERS; c++) {
+        printf(" %14s", PERF_NAMES[c]);
+    }
+    printf(" %6s\n", "IPC");
+}
+
+void perf_print(char const* phase, perf_counts_t const* counts)
+{
+    printf("%-8s", phase);
+    for (size_t c = 0; c < PERF_NB_COUNTERS; c++) {
+        if (counts->valid[c]) {
+            printf(" %14lu", counts->values[c]);
+        } else {
+            printf(" %14s", "n/a");
+        }
+    }
+    if (counts->valid[PERF_CYCLES] && counts->valid[PERF_INSTRUCTIONS] &&
+        counts->values[PERF_CYCLES]) {
+        printf(" %6.2f\n", (double)counts->values[PERF_INSTRUCTIONS] /
+                               counts->values[PERF_CYCLES]);
+    } else {
+        printf(" %6s\n", "n/a");
+    }
+}
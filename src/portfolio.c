@@ -0,0 +1,187 @@
+/**
+ * @file    portfolio.c
+ * @brief   Implementation of the multi-start heuristic portfolio.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "portfolio.h"
+#include "lk.h"
+#include "neighbors.h"
+#include "spacefill.h"
+#include "utils.h"
+
+#include <omp.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct portfolio_t {
+    config_t const* config;
+    solver_t* solver;
+    neighbors_t const* neighbors;
+    options_t const* options;
+    double deadline;
+    size_t max_runs;
+
+    // Shared best tour, written under the `portfolio` critical section
+    size_t* best_tour;
+    _Atomic int64_t best_cost;
+
+    atomic_size_t next_run;
+    _Atomic uint64_t explored;
+    atomic_bool stop;
+    _Atomic tsp_status_t status;
+} portfolio_t;
+
+// Replaces the shared best tour by the current tour of `lk` if it is shorter,
+// and stores it in the solver
+static void portfolio_publish(portfolio_t* portfolio, lk_t const* lk)
+{
+    int64_t cost = lk_cost(lk);
+    if (lk_status(lk) != TSP_OK ||
+        cost >= atomic_load(&portfolio->best_cost)) {
+        return;
+    }
+
+#pragma omp critical(portfolio)
+    if (cost < atomic_load(&portfolio->best_cost)) {
+        lk_get_tour(lk, portfolio->best_tour);
+        atomic_store(&portfolio->best_cost, cost);
+        portfolio->solver->nb_explored = atomic_load(&portfolio->explored);
+        solver_store_tour(portfolio->config, portfolio->solver,
+                          portfolio->best_tour);
+        if (cost <= portfolio->options->target_cost) {
+            atomic_store(&portfolio->stop, true);
+        }
+    }
+}
+
+static bool portfolio_should_stop(portfolio_t* portfolio)
+{
+    if (portfolio->deadline > 0.0 && wall_time() >= portfolio->deadline) {
+        atomic_store(&portfolio->stop, true);
+    }
+    return atomic_load(&portfolio->stop);
+}
+
+static void portfolio_run(portfolio_t* portfolio, lk_t* lk, size_t* tour,
+                          size_t run)
+{
+    size_t const n = portfolio->config->nb_nodes;
+    uint64_t rng = (portfolio->options->seed + run + 1) * 0x9E3779B97F4A7C15ULL;
+    rng = rng ? rng : 1;
+
+    // Even runs explore from a new tour, odd runs intensify around the best one
+    bool from_best = false;
+    if (run & 1) {
+#pragma omp critical(portfolio)
+        if (atomic_load(&portfolio->best_cost) != INT64_MAX) {
+            memcpy(tour, portfolio->best_tour, n * sizeof(size_t));
+            from_best = true;
+        }
+    }
+    if (from_best) {
+        lk_set_tour(lk, tour);
+    } else if (portfolio->config->coordinates &&
+               spacefill_order(portfolio->config, tour) == TSP_OK) {
+        // Like `solve_lk`, which avoids the scans of the nearest neighbor
+        // heuristic on large instances, the runs then differ by their kicks
+        lk_set_tour(lk, tour);
+    } else {
+        lk_nearest_neighbor(lk, rng_next(&rng) % n, &rng);
+    }
+
+    lk_optimize(lk, portfolio->deadline);
+    portfolio_publish(portfolio, lk);
+
+    size_t kicks = LK_KICKS_PER_NODE * n;
+    while (kicks && !portfolio_should_stop(portfolio)) {
+        size_t round = kicks < LK_KICKS_PER_ROUND ? kicks : LK_KICKS_PER_ROUND;
+        size_t done = lk_perturb(lk, round, portfolio->deadline, &rng);
+        atomic_fetch_add(&portfolio->explored, done);
+        portfolio_publish(portfolio, lk);
+        // No kick at all means that the deadline passed or that the instance
+        // is too small to be kicked, in which case new runs cannot do better
+        if (!done) {
+            atomic_store(&portfolio->stop, true);
+        }
+        if (done < round) {
+            break;
+        }
+        kicks -= round;
+    }
+
+    if (lk_status(lk) != TSP_OK) {
+        atomic_store(&portfolio->status, lk_status(lk));
+    }
+}
+
+tsp_status_t solve_portfolio(config_t const* config, solver_t* solver,
+                             options_t const* options)
+{
+    if (!adj_matrix_symmetric(config)) {
+        return TSP_ERR_INVALID_ARGUMENT;
+    }
+
+    size_t threads =
+        options->threads ? options->threads : (size_t)omp_get_max_threads();
+    bool limited =
+        options->time_limit > 0.0 || options->target_cost != INT64_MIN;
+
+    portfolio_t portfolio = {
+        .config = config,
+        .solver = solver,
+        .neighbors = neighbors_build(config, LK_NEIGHBORS),
+        .options = options,
+        .deadline = options->time_limit > 0.0
+                        ? wall_time() + options->time_limit
+                        : 0.0,
+        .max_runs = limited ? SIZE_MAX : PORTFOLIO_RUNS_PER_THREAD * threads,
+        .best_tour = malloc(config->nb_nodes * sizeof(size_t)),
+    };
+    atomic_init(&portfolio.best_cost, INT64_MAX);
+    atomic_init(&portfolio.next_run, 0);
+    atomic_init(&portfolio.explored, 0);
+    atomic_init(&portfolio.stop, false);
+    atomic_init(&portfolio.status, TSP_OK);
+    if (!portfolio.neighbors || !portfolio.best_tour) {
+        free(portfolio.best_tour);
+        neighbors_destroy((neighbors_t*)portfolio.neighbors);
+        return TSP_ERR_ALLOC;
+    }
+
+#pragma omp parallel num_threads(threads)
+    {
+        lk_t* lk = lk_init(config, portfolio.neighbors);
+        size_t* tour = malloc(config->nb_nodes * sizeof(size_t));
+        if (!lk || !tour) {
+            atomic_store(&portfolio.status, TSP_ERR_ALLOC);
+        }
+
+        // The first run always builds a tour, the others only start before
+        // the portfolio stops
+        while (lk && tour) {
+            size_t run = atomic_fetch_add(&portfolio.next_run, 1);
+            if (run >= portfolio.max_runs ||
+                (run && portfolio_should_stop(&portfolio))) {
+                break;
+            }
+            portfolio_run(&portfolio, lk, tour, run);
+        }
+
+        free(tour);
+        lk_destroy(lk);
+    }
+
+    solver->nb_explored = atomic_load(&portfolio.explored);
+
+    // Failed threads do not matter as long as some tour was found
+    tsp_status_t status = atomic_load(&portfolio.best_cost) == INT64_MAX
+                              ? atomic_load(&portfolio.status)
+                              : TSP_OK;
+
+    free(portfolio.best_tour);
+    neighbors_destroy((neighbors_t*)portfolio.neighbors);
+    return status;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file    profile.c
+ * @brief   Implementation of the per-level latency histograms of the
+ *          branch-and-bound search.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "profile.h"
+
+#ifdef TSP_PROFILE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+_Thread_local profile_t* profile_current
+    __attribute__((tls_model("initial-exec"))) = NULL;
+
+uint64_t profile_ticks_slow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void profile_begin(void)
+{
+    free(profile_current);
+    profile_current = calloc(1, sizeof(profile_t));
+}
+
+// Estimated number of ticks spent in the child loops of a level
+static double profile_level_ticks(profile_level_t const* level)
+{
+    return level->sampled
+               ? (double)level->ticks / level->sampled * level->nodes
+               : 0.0;
+}
+
+void profile_end(char const* title)
+{
+    profile_t* profile = profile_current;
+    profile_current = NULL;
+    if (!profile) {
+        return;
+    }
+
+    double total = 0.0;
+    for (size_t l = 0; l < PROFILE_MAX_LEVELS; l++) {
+        total += profile_level_ticks(&profile->levels[l]);
+    }
+
+    fprintf(stderr,
+            "\nProfile of %s (ticks per node without its children, 1 in %d "
+            "nodes timed):\n",
+            title, PROFILE_SAMPLE_PERIOD);
+    fprintf(stderr, "%6s %14s %10s %12s %7s  %s\n", "level", "nodes",
+            "timed", "mean", "share", "histogram (log2 ticks: nodes)");
+    for (size_t l = 0; l < PROFILE_MAX_LEVELS; l++) {
+        profile_level_t const* level = &profile->levels[l];
+        if (!level->nodes) {
+            continue;
+        }
+
+        double ticks = profile_level_ticks(level);
+        fprintf(stderr, "%5zu%c %14lu %10lu %12.1f %6.2f%% ", l,
+                l == PROFILE_MAX_LEVELS - 1 ? '+' : ' ', level->nodes,
+                level->sampled,
+                level->sampled ? (double)level->ticks / level->sampled : 0.0,
+                total > 0.0 ? 100.0 * ticks / total : 0.0);
+        for (size_t b = 0; b < PROFILE_BUCKETS; b++) {
+            if (level->buckets[b]) {
+                fprintf(stderr, " %zu:%lu", b, level->buckets[b]);
+            }
+        }
+        fprintf(stderr, "\n");
+    }
+    free(profile);
+}
+
+#endif
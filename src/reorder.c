@@ -0,0 +1,193 @@
+/**
+ * @file    reorder.c
+ * @brief   Implementation of the load-time renumbering of the nodes.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "reorder.h"
+#include "spacefill.h"
+#include "utils.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Chains the nodes from node 0, each followed by its nearest node not yet in
+// the chain. Missing edges are only followed when no other edge is left.
+static tsp_status_t reorder_chain(config_t const* config, size_t* order)
+{
+    size_t const n = config->nb_nodes;
+    size_t* rest = malloc(n * sizeof(size_t));
+    int64_t* row = malloc(n * sizeof(int64_t));
+    if (!rest || !row) {
+        free(rest);
+        free(row);
+        return TSP_ERR_ALLOC;
+    }
+    for (size_t i = 0; i + 1 < n; i++) {
+        rest[i] = i + 1;
+    }
+
+    order[0] = 0;
+    size_t remaining = n - 1;
+    for (size_t p = 1; p < n; p++) {
+        adj_matrix_row(config, order[p - 1], row);
+        size_t best = 0;
+        uint64_t best_weight = UINT64_MAX;
+        for (size_t r = 0; r < remaining; r++) {
+            // A missing edge wraps around to the largest weight
+            uint64_t weight = (uint64_t)row[rest[r]] - 1;
+            if (weight < best_weight) {
+                best_weight = weight;
+                best = r;
+            }
+        }
+        order[p] = rest[best];
+        rest[best] = rest[--remaining];
+    }
+
+    free(rest);
+    free(row);
+    return TSP_OK;
+}
+
+// Replaces the matrix and coordinates by those of the nodes in `order`
+static tsp_status_t reorder_permute(config_t* config, size_t const* order)
+{
+    size_t const n = config->nb_nodes;
+    pages_backing_t backing = PAGES_HEAP;
+    vec_i64_t* labels = vec_i64_with_capacity(n);
+    vec_i64_t* matrix =
+        config->adjacency_matrix
+            ? pages_vec_i64(config->adjacency_matrix->len, &backing)
+            : NULL;
+    vec_f64_t* coordinates = config->coordinates
+                                 ? vec_f64_with_capacity(2 * n)
+                                 : NULL;
+    if (!labels || (config->adjacency_matrix && !matrix) ||
+        (config->coordinates && !coordinates)) {
+        vec_i64_drop(labels);
+        pages_vec_i64_drop(matrix, backing);
+        vec_f64_drop(coordinates);
+        return TSP_ERR_ALLOC;
+    }
+
+    if (coordinates) {
+        double const* from = config->coordinates->data;
+        for (size_t i = 0; i < n; i++) {
+            coordinates->data[2 * i] = from[2 * order[i]];
+            coordinates->data[2 * i + 1] = from[2 * order[i] + 1];
+        }
+        coordinates->len = 2 * n;
+    }
+
+    if (matrix) {
+        // Both matrices share the layout of the configuration, triangular
+        // ones only fill the entries past their diagonal. Each new row is
+        // gathered from a copy of the old one, rather than entry by entry
+        // from all over a triangular matrix. Euclidean weights are copied
+        // too rather than computed again from the coordinates, as a delta
+        // may have changed some of them (see `delta_apply`).
+        bool const triangular = config->triangular;
+        bool failed = false;
+#pragma omp parallel reduction(|| : failed)
+        {
+            int64_t* row = malloc(n * sizeof(int64_t));
+            failed = !row;
+#pragma omp for schedule(dynamic, 64)
+            for (size_t i = 0; i < n; i++) {
+                if (!row) {
+                    continue;
+                }
+                adj_matrix_row(config, order[i], row);
+                for (size_t j = triangular ? i : 0; j < n; j++) {
+                    matrix->data[adj_matrix_index(config, i, j)] =
+                        row[order[j]];
+                }
+            }
+            free(row);
+        }
+        if (failed) {
+            vec_i64_drop(labels);
+            pages_vec_i64_drop(matrix, backing);
+            vec_f64_drop(coordinates);
+            return TSP_ERR_ALLOC;
+        }
+        matrix->len = config->adjacency_matrix->len;
+        pages_vec_i64_drop(config->adjacency_matrix, config->matrix_backing);
+        config->adjacency_matrix = matrix;
+        config->matrix_backing = backing;
+    }
+
+    if (coordinates) {
+        vec_f64_drop(config->coordinates);
+        config->coordinates = coordinates;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        labels->data[i] = order[i];
+    }
+    labels->len = n;
+    config->labels = labels;
+    return TSP_OK;
+}
+
+tsp_status_t reorder_config(config_t* config)
+{
+    size_t const n = config->nb_nodes;
+    if (config->labels || config->sparse || n < REORDER_MIN_NODES) {
+        return TSP_OK;
+    }
+
+    size_t* order = malloc(2 * n * sizeof(size_t));
+    if (!order) {
+        return TSP_ERR_ALLOC;
+    }
+
+    tsp_status_t status;
+    if (config->coordinates) {
+        // Rotate the order to keep node 0 first, which tours start from. The
+        // Hilbert curve is open, so this adds one jump between its two ends,
+        // which only costs the locality of one pair of rows.
+        status = spacefill_order(config, &order[n]);
+        if (status == TSP_OK) {
+            size_t start = 0;
+            while (order[n + start] != 0) {
+                start++;
+            }
+            for (size_t i = 0; i < n; i++) {
+                order[i] = order[n + (start + i) % n];
+            }
+        }
+    } else {
+        status = reorder_chain(config, order);
+    }
+
+    if (status == TSP_OK) {
+        status = reorder_permute(config, order);
+    }
+    free(order);
+    return status;
+}
+
+tsp_status_t reorder_rename(config_t const* config, size_t* nodes,
+                            size_t nb_nodes)
+{
+    if (!config->labels) {
+        return TSP_OK;
+    }
+
+    size_t const n = config->nb_nodes;
+    size_t* renamed = malloc(n * sizeof(size_t));
+    if (!renamed) {
+        return TSP_ERR_ALLOC;
+    }
+    for (size_t i = 0; i < n; i++) {
+        renamed[config->labels->data[i]] = i;
+    }
+    for (size_t i = 0; i < nb_nodes; i++) {
+        nodes[i] = renamed[nodes[i]];
+    }
+    free(renamed);
+    return TSP_OK;
+}
@@ -0,0 +1,258 @@
+/**
+ * @file    selector.c
+ * @brief   Implementation of the instance features and of the automatic
+ *          engine selection.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "selector.h"
+#include "utils.h"
+
+#include <math.h>
+#include <omp.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// A rule matches the instances that have the given symmetry, are Euclidean
+// if it requires it, and whose features lie within its limits. The limits
+// come from runs of the engines on random instances of each kind, on one
+// core: `cut` solves 100 Euclidean cities in under a second and 250 cities
+// with random (non-metric) or nearly uniform weights in 2 s, where its root
+// bound is within 0.2% of the optimum, and 400 nodes of degree 8 in 9 s.
+// `genetic` beats `lk` by about 1% in 12 s at 5000 cities, `lk` takes 136 s
+// at 100000 and `portfolio` twice as long, for two runs per thread. `lk`,
+// `portfolio` and `genetic` refuse asymmetric weights, which leaves `little`
+// for the asymmetric instances: it solves 80 random cities in 4 s, and
+// beyond that is only given until the time limit to improve its tour.
+typedef struct selector_rule_t {
+    bool symmetric;
+    bool euclidean;
+    size_t min_nodes;
+    size_t max_nodes;
+    double min_violations;
+    double max_spread;
+    double max_density;
+    size_t min_threads;
+    engine_t engine;
+    bool parallel;
+    bool limited;
+    char const* bound;
+    char const* reason;
+} selector_rule_t;
+
+static selector_rule_t const SELECTOR_RULES[] = {
+    {false, false, 0, 80, 0.0, INFINITY, 1.0, 1, ENGINE_LITTLE, false, false,
+     "reduced cost matrix",
+     "small asymmetric instance, which only `little` solves exactly"},
+    {false, false, 81, SIZE_MAX, 0.0, INFINITY, 1.0, 1, ENGINE_LITTLE, false,
+     true, "reduced cost matrix",
+     "asymmetric instance too large to be solved exactly, `little` returns "
+     "its best tour at the time limit, without proving it optimal"},
+    {true, false, 0, 100, 0.0, INFINITY, 1.0, 1, ENGINE_CUT, false, false,
+     "linear relaxation with subtour elimination cuts",
+     "small symmetric instance, solved exactly in about a second"},
+    {true, false, 0, 250, 0.05, INFINITY, 1.0, 1, ENGINE_CUT, false, false,
+     "linear relaxation with subtour elimination cuts",
+     "non-metric weights, whose relaxation is nearly integral"},
+    {true, false, 0, 250, 0.0, 0.1, 1.0, 1, ENGINE_CUT, false, false,
+     "linear relaxation with subtour elimination cuts",
+     "nearly uniform weights, whose relaxation is nearly integral"},
+    {true, false, 0, 400, 0.0, INFINITY, 0.05, 1, ENGINE_CUT, false, false,
+     "linear relaxation with subtour elimination cuts",
+     "few edges, which keep the relaxation small"},
+    {true, true, 200001, SIZE_MAX, 0.0, INFINITY, 1.0, 1, ENGINE_SPACEFILL,
+     false, false, NULL,
+     "very large Euclidean instance, toured in O(n log n)"},
+    {true, false, 0, 5000, 0.0, INFINITY, 1.0, 1, ENGINE_GENETIC, true, false,
+     NULL, "mid-sized symmetric instance, where crossovers beat local search"},
+    {true, false, 0, 20000, 0.0, INFINITY, 1.0, 2, ENGINE_PORTFOLIO, true,
+     false, NULL, "large symmetric instance, searched on every thread"},
+    {true, false, 0, SIZE_MAX, 0.0, INFINITY, 1.0, 1, ENGINE_LK, false, false,
+     NULL, "large symmetric instance, searched once"},
+};
+
+static size_t const NB_RULES =
+    sizeof(SELECTOR_RULES) / sizeof(*SELECTOR_RULES);
+
+// Scans the stored weights for the symmetry and the density
+static void selector_scan(config_t const* config, features_t* features)
+{
+    size_t const n = config->nb_nodes;
+    sparse_t const* sparse = config->sparse;
+    if (n < 2) {
+        return;
+    }
+
+    if (sparse) {
+        int64_t const* offsets = sparse->offsets->data;
+        int64_t const* targets = sparse->targets->data;
+        int64_t const* weights = sparse->weights->data;
+        for (size_t i = 0; i < n && features->symmetric; i++) {
+            for (int64_t e = offsets[i]; e < offsets[i + 1]; e++) {
+                size_t const j = (size_t)targets[e];
+                size_t const f = sparse_find(sparse, j, i);
+                if (f == (size_t)offsets[j + 1] || weights[f] != weights[e]) {
+                    features->symmetric = false;
+                    break;
+                }
+            }
+        }
+        features->density = (double)offsets[n] / ((double)n * (n - 1));
+        return;
+    }
+    if (!config->adjacency_matrix) {
+        return;
+    }
+
+    size_t missing = 0;
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i + 1; j < n; j++) {
+            int64_t const forward = adj_matrix_get(config, i, j);
+            int64_t const backward =
+                config->triangular ? forward : adj_matrix_get(config, j, i);
+            features->symmetric &= forward == backward;
+            missing += !forward + !backward;
+        }
+    }
+    features->density = 1.0 - (double)missing / ((double)n * (n - 1));
+}
+
+// Draws a node other than `a` and `b`, which may be equal
+static size_t selector_node(uint64_t* rng, size_t n, size_t a, size_t b)
+{
+    size_t v;
+    do {
+        v = rng_next(rng) % n;
+    } while (v == a || v == b);
+    return v;
+}
+
+void selector_features(config_t const* config, features_t* features)
+{
+    size_t const n = config->nb_nodes;
+    *features = (features_t){
+        .nb_nodes = n,
+        .euclidean = config->coordinates != NULL,
+        .symmetric = true,
+        .density = 1.0,
+        .violations = 0.0,
+        .spread = 0.0,
+    };
+    selector_scan(config, features);
+    if (n < 3) {
+        return;
+    }
+
+    // Only the triangles whose three sides exist are counted, and the
+    // weights of the sides give the spread
+    uint64_t rng = HASH_SEED;
+    size_t triangles = 0;
+    size_t violated = 0;
+    size_t sides = 0;
+    double mean = 0.0;
+    double squares = 0.0;
+    for (size_t s = 0; s < SELECTOR_SAMPLES; s++) {
+        size_t const i = selector_node(&rng, n, n, n);
+        size_t const j = selector_node(&rng, n, i, i);
+        size_t const k = selector_node(&rng, n, i, j);
+        int64_t const ij = adj_matrix_get(config, i, j);
+        int64_t const jk = adj_matrix_get(config, j, k);
+        int64_t const ik = adj_matrix_get(config, i, k);
+        int64_t const weights[] = {ij, jk, ik};
+        for (size_t w = 0; w < 3; w++) {
+            if (!weights[w]) {
+                continue;
+            }
+            // Welford's update of the mean and the sum of squared deviations
+            double const delta = (double)weights[w] - mean;
+            mean += delta / (double)++sides;
+            squares += delta * ((double)weights[w] - mean);
+        }
+        if (ij && jk && ik) {
+            triangles++;
+            violated += ik > ij + jk;
+        }
+    }
+    if (triangles) {
+        features->violations = (double)violated / (double)triangles;
+    }
+    if (sides && mean > 0.0) {
+        features->spread = sqrt(squares / (double)sides) / mean;
+    }
+}
+
+static bool selector_match(selector_rule_t const* rule,
+                           features_t const* features, size_t threads)
+{
+    return features->symmetric == rule->symmetric &&
+           (features->euclidean || !rule->euclidean) &&
+           features->nb_nodes >= rule->min_nodes &&
+           features->nb_nodes <= rule->max_nodes &&
+           features->violations >= rule->min_violations &&
+           features->spread <= rule->max_spread &&
+           features->density <= rule->max_density &&
+           threads >= rule->min_threads;
+}
+
+void selector_pick(features_t const* features, options_t const* options,
+                   selection_t* selection)
+{
+    size_t const threads =
+        options->threads ? options->threads : (size_t)omp_get_max_threads();
+
+    // The first two rules match every asymmetric instance, and the last
+    // every symmetric one
+    selector_rule_t const* rule = &SELECTOR_RULES[NB_RULES - 1];
+    for (size_t r = 0; r < NB_RULES; r++) {
+        if (selector_match(&SELECTOR_RULES[r], features, threads)) {
+            rule = &SELECTOR_RULES[r];
+            break;
+        }
+    }
+    *selection = (selection_t){
+        .engine = rule->engine,
+        .threads = rule->parallel ? threads : 1,
+        .time_limit = !rule->limited           ? options->time_limit
+                      : options->time_limit > 0.0 ? options->time_limit
+                                                  : SELECTOR_TIME_LIMIT,
+        .bound = rule->bound,
+        .reason = rule->reason,
+    };
+}
+
+bool selector_resolve(config_t const* config, options_t* options,
+                      features_t* features, selection_t* selection)
+{
+    if (options->engine != ENGINE_AUTO) {
+        return false;
+    }
+    selector_features(config, features);
+    selector_pick(features, options, selection);
+    options->engine = selection->engine;
+    options->threads = selection->threads;
+    options->time_limit = selection->time_limit;
+    return true;
+}
+
+void selector_print(features_t const* features, selection_t const* selection)
+{
+    printf("Automatic engine selection:\n"
+           "  Instance: %zu nodes, %s, %s\n"
+           "  Edges: %.1f%% present, weight spread %.3f\n"
+           "  Triangle inequality: violated by %.1f%% of the sampled "
+           "triangles\n"
+           "  Engine: %s on %zu thread%s\n"
+           "  Reason: %s\n"
+           "  Lower bound: %s\n",
+           features->nb_nodes,
+           features->symmetric ? "symmetric" : "asymmetric",
+           features->euclidean ? "Euclidean" : "explicit weights",
+           100.0 * features->density, features->spread,
+           100.0 * features->violations, engine_name(selection->engine),
+           selection->threads, selection->threads > 1 ? "s" : "",
+           selection->reason,
+           selection->bound ? selection->bound : "none (heuristic engine)");
+    if (selection->time_limit > 0.0) {
+        printf("  Time limit: %g s\n", selection->time_limit);
+    }
+}
@@ -0,0 +1,643 @@
+/**
+ * @file    server.c
+ * @brief   Implementation of the solver daemon.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "server.h"
+#include "cache.h"
+#include "config.h"
+#include "solver.h"
+#include "tsp.h"
+#include "utils.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Interval at which the accepting thread checks for a stop request
+static const int SERVER_POLL_MS = 200;
+
+// Upper bounds of the latency histogram buckets, in seconds
+#define SERVER_NB_BUCKETS 6
+static const double SERVER_LATENCY_BUCKETS[SERVER_NB_BUCKETS] = {
+    0.001, 0.01, 0.1, 1.0, 10.0, INFINITY,
+};
+
+// Cached instance, shared by the workers solving it
+typedef struct server_entry_t {
+    uint64_t hash;
+    bool binary;
+    char* payload;
+    size_t size;
+    config_t* config;
+    size_t refs;
+    uint64_t last_use;
+} server_entry_t;
+
+typedef struct server_metrics_t {
+    _Atomic uint64_t connections;
+    _Atomic uint64_t requests;
+    _Atomic uint64_t solves;
+    _Atomic uint64_t errors;
+    _Atomic uint64_t cache_hits;
+    _Atomic uint64_t cache_misses;
+    _Atomic uint64_t result_cache_hits;
+    _Atomic uint64_t latency_sum_us;
+    _Atomic uint64_t latency_max_us;
+    _Atomic uint64_t latency_buckets[SERVER_NB_BUCKETS];
+} server_metrics_t;
+
+typedef struct server_t {
+    options_t const* options;
+    cache_t* results;
+    double start_time;
+
+    // Accepted connections waiting for a worker, and the connection served by
+    // each worker (-1 if none)
+    pthread_mutex_t queue_lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    int queue[SERVER_QUEUE_SIZE];
+    size_t queue_head;
+    size_t queue_len;
+    int* active;
+    bool stopping;
+
+    // Least recently used cache of parsed instances
+    pthread_mutex_t cache_lock;
+    server_entry_t* cache[SERVER_CACHE_SIZE];
+    uint64_t clock;
+
+    server_metrics_t metrics;
+} server_t;
+
+typedef struct server_worker_t {
+    server_t* server;
+    size_t id;
+    solver_t* solver;
+    pthread_t thread;
+} server_worker_t;
+
+static volatile sig_atomic_t server_stop_requested = 0;
+
+static void server_on_signal(int signal)
+{
+    (void)signal;
+    server_stop_requested = 1;
+}
+
+static tsp_status_t server_parse_text(char* payload, size_t size,
+                                      config_t** config)
+{
+    FILE* fp = fmemopen(payload, size, "r");
+    if (!fp) {
+        return TSP_ERR_ALLOC;
+    }
+    tsp_status_t status = config_read(fp, config);
+    fclose(fp);
+    return status;
+}
+
+static tsp_status_t server_parse_binary(char const* payload, size_t size,
+                                        config_t** config)
+{
+    uint64_t n;
+    if (size < sizeof(n)) {
+        return TSP_ERR_FORMAT;
+    }
+    memcpy(&n, payload, sizeof(n));
+
+    size_t cells = (size - sizeof(n)) / sizeof(int64_t);
+    if (!n || (size - sizeof(n)) % sizeof(int64_t) || cells % n ||
+        cells / n != n) {
+        return TSP_ERR_FORMAT;
+    }
+    return config_from_matrix((int64_t const*)(payload + sizeof(n)), n,
+                              config);
+}
+
+static void server_entry_release(server_t* server, server_entry_t* entry)
+{
+    pthread_mutex_lock(&server->cache_lock);
+    bool last = --entry->refs == 0;
+    pthread_mutex_unlock(&server->cache_lock);
+
+    if (last) {
+        config_destroy(entry->config);
+        free(entry->payload);
+        free(entry);
+    }
+}
+
+// Returns the instance described by a payload, which is only parsed if it is
+// not cached yet. Takes ownership of the payload.
+static tsp_status_t server_cache_acquire(server_t* server, bool binary,
+                                         char* payload, size_t size,
+                                         server_entry_t** entry)
+{
+    uint64_t hash = hash_bytes(payload, size, HASH_SEED);
+
+    pthread_mutex_lock(&server->cache_lock);
+    for (size_t i = 0; i < SERVER_CACHE_SIZE; i++) {
+        server_entry_t* e = server->cache[i];
+        if (e && e->hash == hash && e->binary == binary && e->size == size &&
+            !memcmp(e->payload, payload, size)) {
+            e->refs++;
+            e->last_use = ++server->clock;
+            pthread_mutex_unlock(&server->cache_lock);
+
+            atomic_fetch_add(&server->metrics.cache_hits, 1);
+            free(payload);
+            *entry = e;
+            return TSP_OK;
+        }
+    }
+    pthread_mutex_unlock(&server->cache_lock);
+    atomic_fetch_add(&server->metrics.cache_misses, 1);
+
+    // Parse outside of the lock, other workers keep using the cache
+    server_entry_t* e = malloc(sizeof(server_entry_t));
+    if (!e) {
+        free(payload);
+        return TSP_ERR_ALLOC;
+    }
+    *e = (server_entry_t){
+        .hash = hash,
+        .binary = binary,
+        .payload = payload,
+        .size = size,
+        .config = NULL,
+        .refs = 2, // One for the cache, one for the caller
+    };
+    tsp_status_t status = binary
+                              ? server_parse_binary(payload, size, &e->config)
+                              : server_parse_text(payload, size, &e->config);
+    if (status != TSP_OK) {
+        free(payload);
+        free(e);
+        return status;
+    }
+
+    // Replace an empty slot, or else the least recently used entry
+    pthread_mutex_lock(&server->cache_lock);
+    e->last_use = ++server->clock;
+    size_t victim = 0;
+    for (size_t i = 0; i < SERVER_CACHE_SIZE; i++) {
+        if (!server->cache[i]) {
+            victim = i;
+            break;
+        }
+        if (server->cache[i]->last_use < server->cache[victim]->last_use) {
+            victim = i;
+        }
+    }
+    server_entry_t* evicted = server->cache[victim];
+    server->cache[victim] = e;
+    pthread_mutex_unlock(&server->cache_lock);
+
+    if (evicted) {
+        server_entry_release(server, evicted);
+    }
+    *entry = e;
+    return TSP_OK;
+}
+
+static void server_record_latency(server_metrics_t* metrics, double seconds)
+{
+    uint64_t us = seconds * 1e6;
+    atomic_fetch_add(&metrics->latency_sum_us, us);
+
+    uint64_t max = atomic_load(&metrics->latency_max_us);
+    while (us > max &&
+           !atomic_compare_exchange_weak(&metrics->latency_max_us, &max, us)) {
+    }
+
+    size_t b = 0;
+    while (seconds > SERVER_LATENCY_BUCKETS[b]) {
+        b++;
+    }
+    atomic_fetch_add(&metrics->latency_buckets[b], 1);
+}
+
+static void server_write_metrics(server_t* server, FILE* out)
+{
+    server_metrics_t* metrics = &server->metrics;
+    double uptime = wall_time() - server->start_time;
+    uint64_t solves = atomic_load(&metrics->solves);
+
+    fprintf(out,
+            "uptime_seconds %.3lf\n"
+            "connections_total %lu\n"
+            "requests_total %lu\n"
+            "solves_total %lu\n"
+            "errors_total %lu\n"
+            "cache_hits_total %lu\n"
+            "cache_misses_total %lu\n"
+            "result_cache_hits_total %lu\n"
+            "throughput_solves_per_second %.3lf\n"
+            "latency_seconds_sum %.6lf\n"
+            "latency_seconds_max %.6lf\n",
+            uptime, atomic_load(&metrics->connections),
+            atomic_load(&metrics->requests), solves,
+            atomic_load(&metrics->errors), atomic_load(&metrics->cache_hits),
+            atomic_load(&metrics->cache_misses),
+            atomic_load(&metrics->result_cache_hits), solves / uptime,
+            atomic_load(&metrics->latency_sum_us) / 1e6,
+            atomic_load(&metrics->latency_max_us) / 1e6);
+
+    // Cumulative histogram
+    uint64_t count = 0;
+    for (size_t b = 0; b < SERVER_NB_BUCKETS; b++) {
+        count += atomic_load(&metrics->latency_buckets[b]);
+        if (b + 1 < SERVER_NB_BUCKETS) {
+            fprintf(out, "latency_seconds_bucket{le=\"%g\"} %lu\n",
+                    SERVER_LATENCY_BUCKETS[b], count);
+        } else {
+            fprintf(out, "latency_seconds_bucket{le=\"+Inf\"} %lu\n", count);
+        }
+    }
+    fprintf(out, "END\n");
+}
+
+static void server_error(server_t* server, FILE* out, char const* message)
+{
+    atomic_fetch_add(&server->metrics.errors, 1);
+    fprintf(out, "ERR %s\n", message);
+}
+
+// Applies the `key=value` options of a request
+static bool server_parse_options(char* args, options_t* options)
+{
+    char* save;
+    for (char* arg = strtok_r(args, " \t\r\n", &save); arg;
+         arg = strtok_r(NULL, " \t\r\n", &save)) {
+        char* value = strchr(arg, '=');
+        if (!value) {
+            return false;
+        }
+        *value++ = '\0';
+
+        char* end = value;
+        if (!strcmp(arg, "engine")) {
+            if (!engine_parse(value, &options->engine)) {
+                return false;
+            }
+            continue;
+        } else if (!strcmp(arg, "time")) {
+            options->time_limit = strtod(value, &end);
+            if (!(options->time_limit >= 0.0)) {
+                return false;
+            }
+        } else if (!strcmp(arg, "seed")) {
+            options->seed = strtoull(value, &end, 10);
+        } else if (!strcmp(arg, "threads")) {
+            if (!isdigit((unsigned char)*value)) {
+                return false;
+            }
+            options->threads = strtoull(value, &end, 10);
+        } else if (!strcmp(arg, "target")) {
+            options->target_cost = strtoll(value, &end, 10);
+        } else {
+            return false;
+        }
+        if (end == value || *end) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Answers a `SOLVE` request, returning `false` if the rest of the connection
+// cannot be read anymore
+static bool server_solve(server_worker_t* worker, char* args, FILE* in,
+                         FILE* out)
+{
+    server_t* server = worker->server;
+
+    char* save;
+    char* format = strtok_r(args, " \t\r\n", &save);
+    char* size_arg = strtok_r(NULL, " \t\r\n", &save);
+    char* end = NULL;
+    size_t size = size_arg ? strtoull(size_arg, &end, 10) : 0;
+    bool binary = format && !strcmp(format, "BINARY");
+    if (!format || (!binary && strcmp(format, "TEXT")) || !size || *end ||
+        size > SERVER_MAX_PAYLOAD) {
+        server_error(server, out, "malformed request");
+        return false;
+    }
+
+    char* payload = malloc(size);
+    if (!payload) {
+        server_error(server, out, tsp_strerror(TSP_ERR_ALLOC));
+        return false;
+    }
+    if (fread(payload, 1, size, in) != size) {
+        free(payload);
+        return false;
+    }
+
+    options_t options = *server->options;
+    if (!server_parse_options(save, &options)) {
+        free(payload);
+        server_error(server, out, "invalid option");
+        return true;
+    }
+
+    server_entry_t* entry;
+    tsp_status_t status =
+        server_cache_acquire(server, binary, payload, size, &entry);
+    if (status != TSP_OK) {
+        server_error(server, out, tsp_strerror(status));
+        return true;
+    }
+
+    solver_t* solver = worker->solver;
+    size_t const n = entry->config->nb_nodes;
+    status = solver_reset(solver, n);
+    if (status == TSP_OK && server->results &&
+        cache_lookup(server->results, entry->config, &options, solver)) {
+        atomic_fetch_add(&server->metrics.result_cache_hits, 1);
+    } else if (status == TSP_OK) {
+        status = tsp_dispatch(entry->config, solver, &options);
+        if (status == TSP_OK && server->results) {
+            cache_store(server->results, entry->config, &options, solver);
+        }
+    }
+    if (status == TSP_OK && solver->minimum_cost == INT64_MAX) {
+        status = TSP_ERR_NO_TOUR;
+    }
+    server_entry_release(server, entry);
+
+    if (status != TSP_OK) {
+        server_error(server, out, tsp_strerror(status));
+        return true;
+    }
+
+    int64_t const* tour = solver->optimal_path->data;
+    fprintf(out, "OK %ld", solver->minimum_cost);
+    for (size_t i = 0; i <= n; i++) {
+        fprintf(out, " %ld", tour[i]);
+    }
+    fprintf(out, "\n");
+    atomic_fetch_add(&server->metrics.solves, 1);
+    return true;
+}
+
+// Serves the requests of a connection until it is closed
+static void server_serve(server_worker_t* worker, int fd)
+{
+    server_t* server = worker->server;
+    FILE* in = fdopen(fd, "r");
+    int out_fd = in ? dup(fd) : -1;
+    FILE* out = out_fd >= 0 ? fdopen(out_fd, "w") : NULL;
+
+    char* line = NULL;
+    size_t capacity = 0;
+    while (in && out && getline(&line, &capacity, in) > 0) {
+        char* save;
+        char* command = strtok_r(line, " \t\r\n", &save);
+        if (!command) {
+            continue;
+        }
+
+        atomic_fetch_add(&server->metrics.requests, 1);
+        bool open = true;
+        if (!strcmp(command, "METRICS")) {
+            server_write_metrics(server, out);
+        } else if (!strcmp(command, "SOLVE")) {
+            double start = wall_time();
+            open = server_solve(worker, save, in, out);
+            server_record_latency(&server->metrics, wall_time() - start);
+        } else {
+            server_error(server, out, "unknown command");
+        }
+        if (fflush(out) == EOF || !open) {
+            break;
+        }
+    }
+    free(line);
+
+    pthread_mutex_lock(&server->queue_lock);
+    server->active[worker->id] = -1;
+    pthread_mutex_unlock(&server->queue_lock);
+
+    if (out) {
+        fclose(out);
+    } else if (out_fd >= 0) {
+        close(out_fd);
+    }
+    if (in) {
+        fclose(in);
+    } else {
+        close(fd);
+    }
+}
+
+static void* server_worker(void* arg)
+{
+    server_worker_t* worker = arg;
+    server_t* server = worker->server;
+
+    for (;;) {
+        pthread_mutex_lock(&server->queue_lock);
+        while (!server->queue_len && !server->stopping) {
+            pthread_cond_wait(&server->not_empty, &server->queue_lock);
+        }
+        if (server->stopping) {
+            pthread_mutex_unlock(&server->queue_lock);
+            return NULL;
+        }
+        int fd = server->queue[server->queue_head];
+        server->queue_head = (server->queue_head + 1) % SERVER_QUEUE_SIZE;
+        server->queue_len--;
+        server->active[worker->id] = fd;
+        pthread_cond_signal(&server->not_full);
+        pthread_mutex_unlock(&server->queue_lock);
+
+        server_serve(worker, fd);
+    }
+}
+
+// Binds the listening socket, replacing the one left by a previous server
+static int server_listen(char const* path)
+{
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    struct stat st;
+    if (!lstat(path, &st) && S_ISSOCK(st.st_mode)) {
+        unlink(path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) ||
+        listen(fd, SOMAXCONN)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+tsp_status_t server_run(options_t const* options)
+{
+    if (!options->socket_path || !options->workers) {
+        return TSP_ERR_INVALID_ARGUMENT;
+    }
+    int listen_fd = server_listen(options->socket_path);
+    if (listen_fd < 0) {
+        return TSP_ERR_IO;
+    }
+
+    server_t* server = calloc(1, sizeof(server_t));
+    server_worker_t* workers =
+        calloc(options->workers, sizeof(server_worker_t));
+    int* active = malloc(options->workers * sizeof(int));
+    if (!server || !workers || !active) {
+        free(server);
+        free(workers);
+        free(active);
+        close(listen_fd);
+        unlink(options->socket_path);
+        return TSP_ERR_ALLOC;
+    }
+    server->options = options;
+    server->results = options->cache_dir ? cache_open(options->cache_dir,
+                                                      options->cache_limit)
+                                         : NULL;
+    server->start_time = wall_time();
+    server->active = active;
+    pthread_mutex_init(&server->queue_lock, NULL);
+    pthread_cond_init(&server->not_empty, NULL);
+    pthread_cond_init(&server->not_full, NULL);
+    pthread_mutex_init(&server->cache_lock, NULL);
+
+    // Stop requests interrupt `poll`, and writes to closed connections fail
+    // instead of killing the process
+    struct sigaction action = {.sa_handler = server_on_signal};
+    struct sigaction old_int, old_term, old_pipe;
+    sigemptyset(&action.sa_mask);
+    server_stop_requested = 0;
+    sigaction(SIGINT, &action, &old_int);
+    sigaction(SIGTERM, &action, &old_term);
+    action.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &action, &old_pipe);
+
+    // Workers (and their OpenMP threads) never handle the stop signals
+    sigset_t stop_signals, old_mask;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &old_mask);
+
+    tsp_status_t status = TSP_OK;
+    size_t nb_started = 0;
+    for (; nb_started < options->workers; nb_started++) {
+        server_worker_t* worker = &workers[nb_started];
+        worker->server = server;
+        worker->id = nb_started;
+        worker->solver = solver_init(SERVER_PREALLOC_NODES);
+        active[nb_started] = -1;
+        if (!worker->solver ||
+            pthread_create(&worker->thread, NULL, server_worker, worker)) {
+            solver_destroy(worker->solver);
+            status = TSP_ERR_ALLOC;
+            break;
+        }
+    }
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+
+    if (status == TSP_OK) {
+        printf("Listening on `%s` with %zu workers\n", options->socket_path,
+               options->workers);
+        fflush(stdout);
+    }
+
+    while (status == TSP_OK && !server_stop_requested) {
+        struct pollfd pfd = {.fd = listen_fd, .events = POLLIN};
+        if (poll(&pfd, 1, SERVER_POLL_MS) <= 0) {
+            continue;
+        }
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+        // Reads and writes fail once the connection stays idle for too long,
+        // which ends its serving loop
+        struct timeval timeout = {.tv_sec = SERVER_IDLE_TIMEOUT};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        atomic_fetch_add(&server->metrics.connections, 1);
+
+        pthread_mutex_lock(&server->queue_lock);
+        while (server->queue_len == SERVER_QUEUE_SIZE) {
+            pthread_cond_wait(&server->not_full, &server->queue_lock);
+        }
+        size_t tail =
+            (server->queue_head + server->queue_len) % SERVER_QUEUE_SIZE;
+        server->queue[tail] = fd;
+        server->queue_len++;
+        pthread_cond_signal(&server->not_empty);
+        pthread_mutex_unlock(&server->queue_lock);
+    }
+
+    // Drop the waiting connections and interrupt the ones being served
+    pthread_mutex_lock(&server->queue_lock);
+    server->stopping = true;
+    for (; server->queue_len; server->queue_len--) {
+        close(server->queue[server->queue_head]);
+        server->queue_head = (server->queue_head + 1) % SERVER_QUEUE_SIZE;
+    }
+    for (size_t i = 0; i < nb_started; i++) {
+        if (active[i] >= 0) {
+            shutdown(active[i], SHUT_RDWR);
+        }
+    }
+    pthread_cond_broadcast(&server->not_empty);
+    pthread_mutex_unlock(&server->queue_lock);
+
+    for (size_t i = 0; i < nb_started; i++) {
+        pthread_join(workers[i].thread, NULL);
+        solver_destroy(workers[i].solver);
+    }
+    for (size_t i = 0; i < SERVER_CACHE_SIZE; i++) {
+        if (server->cache[i]) {
+            server_entry_release(server, server->cache[i]);
+        }
+    }
+
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+    sigaction(SIGPIPE, &old_pipe, NULL);
+    close(listen_fd);
+    unlink(options->socket_path);
+
+    pthread_mutex_destroy(&server->queue_lock);
+    pthread_cond_destroy(&server->not_empty);
+    pthread_cond_destroy(&server->not_full);
+    pthread_mutex_destroy(&server->cache_lock);
+    cache_close(server->results);
+    free(active);
+    free(workers);
+    free(server);
+    return status;
+}
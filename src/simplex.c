@@ -0,0 +1,598 @@
+/**
+ * @file    simplex.c
+ * @brief   Implementation of the bounded dual simplex.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "simplex.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Smallest pivot accepted by the ratio test and the inverse
+#define SIMPLEX_PIVOT_TOLERANCE 1e-9
+
+// Number of rows allocated at first, doubled when full
+#define SIMPLEX_INITIAL_ROWS 64
+
+// Variables are the columns, then the slacks of the rows: row `i` reads
+// `A_i.x - s_i = 0` with `lower_row_i <= s_i <= upper_row_i`, so the column of
+// its slack in `[A -I]` is `-e_i`. `position` holds the row of the basis of
+// each basic variable, -1 for the others, which lie at one of their bounds.
+// `inverse` is the inverse of the basis, one row of `capacity` entries per
+// row of the basis.
+struct simplex_t {
+    size_t nb_columns;
+    size_t nb_rows;
+    size_t capacity;
+    double* costs;
+    double* lower;
+    double* upper;
+    double* values;
+    double* reduced;
+    int64_t* position;
+    size_t* basis;
+    double* inverse;
+    size_t* starts;
+    size_t* entries;
+    double* coefficients;
+    size_t nb_entries;
+    size_t entries_capacity;
+    double* alpha;
+    double* column;
+    double* dense;
+    size_t pivots;
+};
+
+static inline double simplex_cost(simplex_t const* lp, size_t var)
+{
+    return var < lp->nb_columns ? lp->costs[var] : 0.0;
+}
+
+// Value of a nonbasic variable whose reduced cost is `reduced`: its lower
+// bound if the cost of raising it is nonnegative, its upper bound otherwise
+static inline double simplex_resting(simplex_t const* lp, size_t var,
+                                     double reduced)
+{
+    if (lp->lower[var] == lp->upper[var] || !isfinite(lp->upper[var])) {
+        return lp->lower[var];
+    }
+    if (!isfinite(lp->lower[var])) {
+        return lp->upper[var];
+    }
+    return reduced >= 0.0 ? lp->lower[var] : lp->upper[var];
+}
+
+simplex_t* simplex_init(size_t nb_columns, double const* costs,
+                        double const* lower, double const* upper)
+{
+    simplex_t* lp = calloc(1, sizeof(simplex_t));
+    if (!lp) {
+        return NULL;
+    }
+    size_t const capacity = SIMPLEX_INITIAL_ROWS;
+    size_t const nb_vars = nb_columns + capacity;
+    lp->nb_columns = nb_columns;
+    lp->capacity = capacity;
+    lp->costs = malloc(nb_columns * sizeof(double));
+    lp->lower = malloc(nb_vars * sizeof(double));
+    lp->upper = malloc(nb_vars * sizeof(double));
+    lp->values = malloc(nb_vars * sizeof(double));
+    lp->reduced = malloc(nb_vars * sizeof(double));
+    lp->position = malloc(nb_vars * sizeof(int64_t));
+    lp->alpha = malloc(nb_vars * sizeof(double));
+    lp->basis = malloc(capacity * sizeof(size_t));
+    lp->column = malloc(capacity * sizeof(double));
+    lp->inverse = malloc(capacity * capacity * sizeof(double));
+    lp->dense = malloc(capacity * capacity * sizeof(double));
+    lp->starts = malloc((capacity + 1) * sizeof(size_t));
+    lp->entries_capacity = nb_columns ? 4 * nb_columns : 1;
+    lp->entries = malloc(lp->entries_capacity * sizeof(size_t));
+    lp->coefficients = malloc(lp->entries_capacity * sizeof(double));
+    if (!lp->costs || !lp->lower || !lp->upper || !lp->values ||
+        !lp->reduced || !lp->position || !lp->alpha || !lp->basis ||
+        !lp->column || !lp->inverse || !lp->dense || !lp->starts ||
+        !lp->entries || !lp->coefficients) {
+        simplex_destroy(lp);
+        return NULL;
+    }
+
+    // Without rows, the basis is empty and every column rests at the bound
+    // its cost prefers, which is dual feasible
+    lp->starts[0] = 0;
+    for (size_t j = 0; j < nb_columns; j++) {
+        lp->costs[j] = costs[j];
+        lp->lower[j] = lower[j];
+        lp->upper[j] = upper[j];
+        lp->reduced[j] = costs[j];
+        lp->position[j] = -1;
+        lp->values[j] = simplex_resting(lp, j, costs[j]);
+    }
+    return lp;
+}
+
+void simplex_destroy(simplex_t* lp)
+{
+    if (lp) {
+        free(lp->costs);
+        free(lp->lower);
+        free(lp->upper);
+        free(lp->values);
+        free(lp->reduced);
+        free(lp->position);
+        free(lp->alpha);
+        free(lp->basis);
+        free(lp->column);
+        free(lp->inverse);
+        free(lp->dense);
+        free(lp->starts);
+        free(lp->entries);
+        free(lp->coefficients);
+        free(lp);
+    }
+}
+
+// Reallocates `*array` to `count` elements of `size` bytes
+static bool simplex_resize(void* array, size_t count, size_t size)
+{
+    void** pointer = array;
+    void* resized = realloc(*pointer, count * size);
+    if (!resized) {
+        return false;
+    }
+    *pointer = resized;
+    return true;
+}
+
+// Doubles the number of rows the program can hold
+static tsp_status_t simplex_grow(simplex_t* lp)
+{
+    size_t const capacity = 2 * lp->capacity;
+    size_t const nb_vars = lp->nb_columns + capacity;
+    double* inverse = malloc(capacity * capacity * sizeof(double));
+    if (!inverse || !simplex_resize(&lp->lower, nb_vars, sizeof(double)) ||
+        !simplex_resize(&lp->upper, nb_vars, sizeof(double)) ||
+        !simplex_resize(&lp->values, nb_vars, sizeof(double)) ||
+        !simplex_resize(&lp->reduced, nb_vars, sizeof(double)) ||
+        !simplex_resize(&lp->position, nb_vars, sizeof(int64_t)) ||
+        !simplex_resize(&lp->alpha, nb_vars, sizeof(double)) ||
+        !simplex_resize(&lp->basis, capacity, sizeof(size_t)) ||
+        !simplex_resize(&lp->column, capacity, sizeof(double)) ||
+        !simplex_resize(&lp->dense, capacity * capacity, sizeof(double)) ||
+        !simplex_resize(&lp->starts, capacity + 1, sizeof(size_t))) {
+        free(inverse);
+        return TSP_ERR_ALLOC;
+    }
+    for (size_t i = 0; i < lp->nb_rows; i++) {
+        memcpy(&inverse[i * capacity], &lp->inverse[i * lp->capacity],
+               lp->nb_rows * sizeof(double));
+    }
+    free(lp->inverse);
+    lp->inverse = inverse;
+    lp->capacity = capacity;
+    return TSP_OK;
+}
+
+// Coefficient of column `j` in row `i`, by binary search in the row
+static double simplex_coefficient(simplex_t const* lp, size_t i, size_t j)
+{
+    size_t low = lp->starts[i];
+    size_t high = lp->starts[i + 1];
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (lp->entries[mid] < j) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low < lp->starts[i + 1] && lp->entries[low] == j
+               ? lp->coefficients[low]
+               : 0.0;
+}
+
+// Column of variable `var` in the basis: `column = B^-1 [A -I]_var`
+static void simplex_ftran(simplex_t* lp, size_t var)
+{
+    size_t const m = lp->nb_rows;
+    size_t const stride = lp->capacity;
+    double* column = lp->column;
+    memset(column, 0, m * sizeof(double));
+    if (var >= lp->nb_columns) {
+        size_t const i = var - lp->nb_columns;
+        for (size_t k = 0; k < m; k++) {
+            column[k] = -lp->inverse[k * stride + i];
+        }
+        return;
+    }
+    for (size_t i = 0; i < m; i++) {
+        double const a = simplex_coefficient(lp, i, var);
+        if (a != 0.0) {
+            for (size_t k = 0; k < m; k++) {
+                column[k] += a * lp->inverse[k * stride + i];
+            }
+        }
+    }
+}
+
+// Row `r` of the tableau: `alpha = (B^-1)_r [A -I]`, for every variable
+static void simplex_btran(simplex_t* lp, size_t r)
+{
+    size_t const n = lp->nb_columns;
+    double const* rho = &lp->inverse[r * lp->capacity];
+    memset(lp->alpha, 0, n * sizeof(double));
+    for (size_t i = 0; i < lp->nb_rows; i++) {
+        double const weight = rho[i];
+        lp->alpha[n + i] = -weight;
+        if (fabs(weight) < 1e-14) {
+            continue;
+        }
+        for (size_t e = lp->starts[i]; e < lp->starts[i + 1]; e++) {
+            lp->alpha[lp->entries[e]] += weight * lp->coefficients[e];
+        }
+    }
+}
+
+// Inverts the basis from scratch by Gauss-Jordan elimination with partial
+// pivoting, returns false if it is singular
+static bool simplex_invert(simplex_t* lp)
+{
+    size_t const m = lp->nb_rows;
+    size_t const stride = lp->capacity;
+    double* dense = lp->dense;
+    double* inverse = lp->inverse;
+    for (size_t i = 0; i < m; i++) {
+        for (size_t k = 0; k < m; k++) {
+            size_t const var = lp->basis[k];
+            dense[i * stride + k] =
+                var < lp->nb_columns ? simplex_coefficient(lp, i, var)
+                                     : -(double)(var - lp->nb_columns == i);
+            inverse[i * stride + k] = i == k;
+        }
+    }
+
+    for (size_t c = 0; c < m; c++) {
+        size_t pivot = c;
+        for (size_t i = c + 1; i < m; i++) {
+            if (fabs(dense[i * stride + c]) > fabs(dense[pivot * stride + c])) {
+                pivot = i;
+            }
+        }
+        if (fabs(dense[pivot * stride + c]) < SIMPLEX_PIVOT_TOLERANCE) {
+            return false;
+        }
+        if (pivot != c) {
+            for (size_t k = 0; k < m; k++) {
+                double t = dense[c * stride + k];
+                dense[c * stride + k] = dense[pivot * stride + k];
+                dense[pivot * stride + k] = t;
+                t = inverse[c * stride + k];
+                inverse[c * stride + k] = inverse[pivot * stride + k];
+                inverse[pivot * stride + k] = t;
+            }
+        }
+        double const scale = 1.0 / dense[c * stride + c];
+        for (size_t k = 0; k < m; k++) {
+            dense[c * stride + k] *= scale;
+            inverse[c * stride + k] *= scale;
+        }
+        for (size_t i = 0; i < m; i++) {
+            double const factor = dense[i * stride + c];
+            if (i == c || factor == 0.0) {
+                continue;
+            }
+            for (size_t k = 0; k < m; k++) {
+                dense[i * stride + k] -= factor * dense[c * stride + k];
+                inverse[i * stride + k] -= factor * inverse[c * stride + k];
+            }
+        }
+    }
+    return true;
+}
+
+// Recomputes the inverse, the values of the basic variables and the reduced
+// costs from scratch. A singular basis is replaced by the slacks, the columns
+// resting at the bound their cost prefers, which is again dual feasible.
+static void simplex_refactor(simplex_t* lp)
+{
+    size_t const n = lp->nb_columns;
+    size_t const m = lp->nb_rows;
+    size_t const stride = lp->capacity;
+    lp->pivots = 0;
+    if (!simplex_invert(lp)) {
+        for (size_t j = 0; j < n; j++) {
+            lp->position[j] = -1;
+            lp->values[j] = simplex_resting(lp, j, lp->costs[j]);
+        }
+        for (size_t i = 0; i < m; i++) {
+            lp->basis[i] = n + i;
+            lp->position[n + i] = (int64_t)i;
+        }
+        simplex_invert(lp);
+    }
+
+    // Duals `y = c_B B^-1`, stored in `column`
+    double* y = lp->column;
+    memset(y, 0, m * sizeof(double));
+    for (size_t i = 0; i < m; i++) {
+        double const cost = simplex_cost(lp, lp->basis[i]);
+        if (cost != 0.0) {
+            for (size_t k = 0; k < m; k++) {
+                y[k] += cost * lp->inverse[i * stride + k];
+            }
+        }
+    }
+    for (size_t j = 0; j < n; j++) {
+        lp->reduced[j] = lp->costs[j];
+    }
+    for (size_t i = 0; i < m; i++) {
+        lp->reduced[n + i] = y[i];
+        for (size_t e = lp->starts[i]; e < lp->starts[i + 1]; e++) {
+            lp->reduced[lp->entries[e]] -= y[i] * lp->coefficients[e];
+        }
+    }
+
+    // `x_B = -B^-1 N x_N`, with `N x_N` stored in `alpha`
+    double* activity = lp->alpha;
+    for (size_t i = 0; i < m; i++) {
+        size_t const slack = n + i;
+        activity[i] = lp->position[slack] < 0 ? -lp->values[slack] : 0.0;
+        for (size_t e = lp->starts[i]; e < lp->starts[i + 1]; e++) {
+            size_t const j = lp->entries[e];
+            if (lp->position[j] < 0) {
+                activity[i] += lp->coefficients[e] * lp->values[j];
+            }
+        }
+    }
+    for (size_t k = 0; k < m; k++) {
+        double value = 0.0;
+        for (size_t i = 0; i < m; i++) {
+            value -= lp->inverse[k * stride + i] * activity[i];
+        }
+        lp->values[lp->basis[k]] = value;
+        lp->reduced[lp->basis[k]] = 0.0;
+    }
+}
+
+tsp_status_t simplex_add_row(simplex_t* lp, size_t nb_entries,
+                             size_t const* columns, double const* values,
+                             double lower, double upper)
+{
+    if (lp->nb_rows == lp->capacity && simplex_grow(lp) != TSP_OK) {
+        return TSP_ERR_ALLOC;
+    }
+    if (lp->nb_entries + nb_entries > lp->entries_capacity) {
+        size_t capacity = 2 * lp->entries_capacity;
+        while (capacity < lp->nb_entries + nb_entries) {
+            capacity *= 2;
+        }
+        if (!simplex_resize(&lp->entries, capacity, sizeof(size_t)) ||
+            !simplex_resize(&lp->coefficients, capacity, sizeof(double))) {
+            return TSP_ERR_ALLOC;
+        }
+        lp->entries_capacity = capacity;
+    }
+
+    size_t const m = lp->nb_rows;
+    size_t const stride = lp->capacity;
+    size_t const slack = lp->nb_columns + m;
+    memcpy(&lp->entries[lp->nb_entries], columns, nb_entries * sizeof(size_t));
+    memcpy(&lp->coefficients[lp->nb_entries], values,
+           nb_entries * sizeof(double));
+    lp->nb_entries += nb_entries;
+    lp->starts[m + 1] = lp->nb_entries;
+
+    // The inverse of the basis bordered by the new row and its slack is the
+    // old one bordered by `a_B B^-1` and -1
+    double* border = &lp->inverse[m * stride];
+    memset(border, 0, (m + 1) * sizeof(double));
+    double activity = 0.0;
+    for (size_t e = 0; e < nb_entries; e++) {
+        int64_t const p = lp->position[columns[e]];
+        activity += values[e] * lp->values[columns[e]];
+        if (p >= 0) {
+            for (size_t k = 0; k < m; k++) {
+                border[k] += values[e] * lp->inverse[p * stride + k];
+            }
+        }
+    }
+    border[m] = -1.0;
+    for (size_t i = 0; i < m; i++) {
+        lp->inverse[i * stride + m] = 0.0;
+    }
+
+    lp->lower[slack] = lower;
+    lp->upper[slack] = upper;
+    lp->values[slack] = activity;
+    lp->reduced[slack] = 0.0;
+    lp->position[slack] = (int64_t)m;
+    lp->basis[m] = slack;
+    lp->nb_rows++;
+    return TSP_OK;
+}
+
+void simplex_set_bounds(simplex_t* lp, size_t column, double lower,
+                        double upper)
+{
+    lp->lower[column] = lower;
+    lp->upper[column] = upper;
+    if (lp->position[column] >= 0) {
+        return;
+    }
+
+    // Moving a nonbasic column moves the basic variables along its column
+    double const value = simplex_resting(lp, column, lp->reduced[column]);
+    double const delta = value - lp->values[column];
+    if (delta != 0.0) {
+        simplex_ftran(lp, column);
+        for (size_t k = 0; k < lp->nb_rows; k++) {
+            lp->values[lp->basis[k]] -= delta * lp->column[k];
+        }
+        lp->values[column] = value;
+    }
+}
+
+// Basic variable farthest out of its bounds, `nb_rows` if there is none
+static size_t simplex_leaving(simplex_t const* lp)
+{
+    size_t leaving = lp->nb_rows;
+    double worst = SIMPLEX_TOLERANCE;
+    for (size_t k = 0; k < lp->nb_rows; k++) {
+        size_t const var = lp->basis[k];
+        double const value = lp->values[var];
+        double const violation = value < lp->lower[var]
+                                     ? lp->lower[var] - value
+                                     : value - lp->upper[var];
+        if (violation > worst) {
+            worst = violation;
+            leaving = k;
+        }
+    }
+    return leaving;
+}
+
+// Harris' two-pass ratio test: the entering variable keeps every reduced
+// cost of the right sign, up to the tolerance, and has the largest pivot
+// among those that do. Returns `SIZE_MAX` if there is none.
+static size_t simplex_entering(simplex_t const* lp, bool to_lower)
+{
+    size_t const nb_vars = lp->nb_columns + lp->nb_rows;
+    double bound = INFINITY;
+    for (int pass = 0; pass < 2; pass++) {
+        size_t entering = SIZE_MAX;
+        double largest = 0.0;
+        for (size_t j = 0; j < nb_vars; j++) {
+            if (lp->position[j] >= 0 || lp->lower[j] == lp->upper[j]) {
+                continue;
+            }
+            double const a = to_lower ? -lp->alpha[j] : lp->alpha[j];
+            bool const at_upper = lp->values[j] == lp->upper[j] &&
+                                  lp->values[j] != lp->lower[j];
+            if (at_upper ? a > -SIMPLEX_PIVOT_TOLERANCE
+                         : a < SIMPLEX_PIVOT_TOLERANCE) {
+                continue;
+            }
+            double const slack = fmax(at_upper ? -lp->reduced[j]
+                                               : lp->reduced[j],
+                                      0.0);
+            if (pass == 0) {
+                bound = fmin(bound, (slack + SIMPLEX_TOLERANCE) / fabs(a));
+            } else if (slack / fabs(a) <= bound && fabs(a) > largest) {
+                largest = fabs(a);
+                entering = j;
+            }
+        }
+        if (pass == 1 || bound == INFINITY) {
+            return entering;
+        }
+    }
+    return SIZE_MAX;
+}
+
+simplex_status_t simplex_solve(simplex_t* lp)
+{
+    size_t const m = lp->nb_rows;
+    size_t const stride = lp->capacity;
+    for (size_t iteration = 0; iteration < SIMPLEX_MAX_ITERATIONS;
+         iteration++) {
+        if (lp->pivots >= SIMPLEX_REFACTOR_INTERVAL) {
+            simplex_refactor(lp);
+        }
+        size_t const r = simplex_leaving(lp);
+        if (r == m) {
+            return SIMPLEX_OPTIMAL;
+        }
+        size_t const leaving = lp->basis[r];
+        bool const to_lower = lp->values[leaving] < lp->lower[leaving];
+        double const target =
+            to_lower ? lp->lower[leaving] : lp->upper[leaving];
+
+        simplex_btran(lp, r);
+        size_t const entering = simplex_entering(lp, to_lower);
+        if (entering == SIZE_MAX) {
+            // The dual is unbounded, unless rounding errors made it look so
+            if (lp->pivots) {
+                simplex_refactor(lp);
+                continue;
+            }
+            return SIMPLEX_INFEASIBLE;
+        }
+        simplex_ftran(lp, entering);
+        double const pivot = lp->column[r];
+        if (fabs(pivot) < SIMPLEX_PIVOT_TOLERANCE ||
+            fabs(pivot - lp->alpha[entering]) >
+                1e-6 * (1.0 + fabs(pivot))) {
+            if (lp->pivots) {
+                simplex_refactor(lp);
+                continue;
+            }
+            return SIMPLEX_STALLED;
+        }
+
+        // The leaving variable reaches its bound, the entering one takes its
+        // place in the basis, and the reduced costs follow the dual step
+        double const primal = (lp->values[leaving] - target) / pivot;
+        for (size_t k = 0; k < m; k++) {
+            lp->values[lp->basis[k]] -= primal * lp->column[k];
+        }
+        lp->values[entering] += primal;
+        lp->values[leaving] = target;
+
+        double const dual = lp->reduced[entering] / lp->alpha[entering];
+        size_t const nb_vars = lp->nb_columns + m;
+        for (size_t j = 0; j < nb_vars; j++) {
+            if (lp->position[j] < 0) {
+                lp->reduced[j] -= dual * lp->alpha[j];
+            }
+        }
+        lp->reduced[entering] = 0.0;
+        lp->reduced[leaving] = -dual;
+
+        lp->position[leaving] = -1;
+        lp->position[entering] = (int64_t)r;
+        lp->basis[r] = entering;
+
+        double* pivot_row = &lp->inverse[r * stride];
+        for (size_t k = 0; k < m; k++) {
+            pivot_row[k] /= pivot;
+        }
+        for (size_t i = 0; i < m; i++) {
+            double const factor = lp->column[i];
+            if (i == r || factor == 0.0) {
+                continue;
+            }
+            double* row = &lp->inverse[i * stride];
+            for (size_t k = 0; k < m; k++) {
+                row[k] -= factor * pivot_row[k];
+            }
+        }
+        lp->pivots++;
+    }
+    return SIMPLEX_STALLED;
+}
+
+double simplex_objective(simplex_t const* lp)
+{
+    double objective = 0.0;
+    for (size_t j = 0; j < lp->nb_columns; j++) {
+        objective += lp->costs[j] * lp->values[j];
+    }
+    return objective;
+}
+
+double const* simplex_values(simplex_t const* lp)
+{
+    return lp->values;
+}
+
+double const* simplex_reduced_costs(simplex_t const* lp)
+{
+    return lp->reduced;
+}
+
+size_t simplex_nb_rows(simplex_t const* lp)
+{
+    return lp->nb_rows;
+}
@@ -1,106 +1,202 @@
 #include "solver.h"
+#include "kernels.h"
+#include "profile.h"
 #include "utils.h"
 
 #include <stdbool.h>
+#include <string.h>
 
 solver_t* solver_init(size_t const nb_nodes)
 {
     solver_t* solver = malloc(sizeof(solver_t));
     if (!solver) {
-        fprintf(stderr,
-                "\033[1;31merror:\033[0m failed to allocate `solver`\n");
-        exit(EXIT_FAILURE);
+        return NULL;
     }
 
-    // Allocate vector of visited nodes, all set to false by default
-    bool initial_visited_value = false;
-    solver->visited_nodes =
-        vec_with_value(&initial_visited_value, nb_nodes, sizeof(bool));
-    if (!solver->visited_nodes) {
-        fprintf(stderr, "\033[1;31merror:\033[0m failed to allocate "
-                        "`solver.visited_nodes`\n");
+    solver->visited_nodes = NULL;
+    solver->path_taken = NULL;
+    solver->optimal_path = NULL;
+    solver->bounds = NULL;
+    solver->candidates = NULL;
+    solver->on_incumbent = NULL;
+    solver->incumbent_data = NULL;
+    solver->labels = NULL;
+    if (solver_reset(solver, nb_nodes) != TSP_OK) {
         solver_destroy(solver);
-        exit(EXIT_FAILURE);
+        return NULL;
     }
 
-    // Allocate vector of the taken path, set to -1 by default
-    int64_t initial_path_value = -1;
-    solver->path_taken =
-        vec_with_value(&initial_path_value, nb_nodes + 1, sizeof(int64_t));
+    return solver;
+}
+
+tsp_status_t solver_reset(solver_t* solver, size_t const nb_nodes)
+{
+    if (!solver->visited_nodes) {
+        solver->visited_nodes = vec_bool_with_capacity(nb_nodes);
+    }
     if (!solver->path_taken) {
-        fprintf(
-            stderr,
-            "\033[1;31merror:\033[0m failed to allocate `solver.path_taken`\n");
-        solver_destroy(solver);
-        exit(EXIT_FAILURE);
+        solver->path_taken = vec_i64_with_capacity(nb_nodes + 1);
     }
-
-    // Allocate vector for optimal path
-    solver->optimal_path =
-        vec_with_value(&initial_path_value, nb_nodes + 1, sizeof(int64_t));
     if (!solver->optimal_path) {
-        fprintf(
-            stderr,
-            "\033[1;31merror:\033[0m failed to allocate `solver.optimal_path`\n");
-        solver_destroy(solver);
-        exit(EXIT_FAILURE);
+        solver->optimal_path = vec_i64_with_capacity(nb_nodes + 1);
+    }
+
+    // Vector of visited nodes, all set to false by default, and vectors of the
+    // taken and optimal paths, set to -1 by default. Their memory is reused
+    // when it is large enough.
+    if (!solver->visited_nodes || !solver->path_taken ||
+        !solver->optimal_path ||
+        !vec_bool_fill(solver->visited_nodes, false, nb_nodes) ||
+        !vec_i64_fill(solver->path_taken, -1, nb_nodes + 1) ||
+        !vec_i64_fill(solver->optimal_path, -1, nb_nodes + 1)) {
+        return TSP_ERR_ALLOC;
     }
 
     // Starting at vertex #1 so the first vertex visited vertex in `path_taken`
     // is #0
-    *(bool*)(vec_peek(solver->visited_nodes, 0)) = true;
-    *(int64_t*)(vec_peek(solver->path_taken, 0)) = 0;
+    vec_bool_set(solver->visited_nodes, 0, true);
+    vec_i64_set(solver->path_taken, 0, 0);
 
     // Set cost to infinity at the start
     solver->minimum_cost = INT64_MAX;
+    solver->nb_explored = 0;
+    solver->lower_bound = INT64_MIN;
 
-    return solver;
+    bounds_destroy(solver->bounds);
+    solver->bounds = NULL;
+    candidates_destroy(solver->candidates);
+    solver->candidates = NULL;
+
+    return TSP_OK;
+}
+
+bounds_t* bounds_init(config_t const* config)
+{
+    bounds_t* bounds = malloc(sizeof(bounds_t));
+    if (!bounds) {
+        return NULL;
+    }
+
+    bounds->first = vec_i64_with_value(0, config->nb_nodes);
+    bounds->second = vec_i64_with_value(0, config->nb_nodes);
+    if (!bounds->first || !bounds->second) {
+        bounds_destroy(bounds);
+        return NULL;
+    }
+
+    int64_t* first = bounds->first->data;
+    int64_t* second = bounds->second->data;
+    for (size_t i = 0; i < config->nb_nodes; i++) {
+        first[i] = first_min(config, i);
+        second[i] = second_min(config, i);
+    }
+    return bounds;
+}
+
+void bounds_update(bounds_t* bounds, config_t const* config,
+                   size_t const* nodes, size_t nb_nodes)
+{
+    int64_t* first = bounds->first->data;
+    int64_t* second = bounds->second->data;
+    for (size_t i = 0; i < nb_nodes; i++) {
+        first[nodes[i]] = first_min(config, nodes[i]);
+        second[nodes[i]] = second_min(config, nodes[i]);
+    }
+}
+
+void bounds_destroy(bounds_t* bounds)
+{
+    if (bounds) {
+        vec_i64_drop(bounds->first);
+        vec_i64_drop(bounds->second);
+        free(bounds);
+    }
+}
+
+// Reads the bound tables, or computes the bounds if they could not be
+// allocated
+static inline int64_t solver_first_min(config_t const* config,
+                                       solver_t const* solver, size_t i)
+{
+    return solver->bounds ? vec_i64_get(solver->bounds->first, i)
+                          : first_min(config, i);
+}
+
+static inline int64_t solver_second_min(config_t const* config,
+                                        solver_t const* solver, size_t i)
+{
+    return solver->bounds ? vec_i64_get(solver->bounds->second, i)
+                          : second_min(config, i);
+}
+
+void solver_notify_incumbent(solver_t const* solver)
+{
+    if (solver->on_incumbent) {
+        solver->on_incumbent(solver, solver->incumbent_data);
+    }
 }
 
 void solver_destroy(solver_t* solver)
 {
     // Deallocate only if needed
     if (solver) {
-        if (solver->visited_nodes) {
-            vec_drop(solver->visited_nodes);
-        }
-        if (solver->path_taken) {
-            vec_drop(solver->path_taken);
-        }
-        if (solver->optimal_path) {
-            vec_drop(solver->optimal_path);
-        }
+        vec_bool_drop(solver->visited_nodes);
+        vec_i64_drop(solver->path_taken);
+        vec_i64_drop(solver->optimal_path);
+        bounds_destroy(solver->bounds);
+        candidates_destroy(solver->candidates);
         free(solver);
     }
 }
 
 void solve_tsp(config_t const* config, solver_t* solver)
 {
+    if (!solver->bounds) {
+        solver->bounds = bounds_init(config);
+    }
+    if (!solver->candidates) {
+        solver->candidates = candidates_init(config, solver);
+    }
+    if (solver->candidates) {
+        solver->lower_bound = solver->candidates->lower_bound;
+    }
+
     // Compute the initial lower bound at the root node using the following
     // formula:
     //     1/2 * (sum of first minimum + second minimum)
     int64_t current_bound = 0;
     for (size_t i = 0; i < config->nb_nodes; i++) {
-        current_bound += (first_min(config, i) + second_min(config, i));
+        current_bound += (solver_first_min(config, solver, i) +
+                          solver_second_min(config, solver, i));
     }
 
     // Divide by two and round the lower bound to an integer
     current_bound =
         (current_bound & 1) ? current_bound / 2 + 1 : current_bound / 2;
 
+    // Small instances are solved by a kernel specialized for their size
+    PROFILE_BEGIN();
+    if (solve_small(config, solver, current_bound)) {
+        PROFILE_END("the small instance kernel");
+        return;
+    }
+
     // Call to `branch_and_bound` for `current_weight` equal to 0 and level 1
     int64_t current_weight = 0;
     size_t level = 1;
     solve_branch_and_bound(config, solver, current_bound, current_weight,
                            level);
+    PROFILE_END("the branch-and-bound");
 }
 
 void solve_branch_and_bound(config_t const* config, solver_t* solver,
                             int64_t current_bound, int64_t current_weight,
                             size_t const level)
 {
-    int64_t base_node = *(int64_t*)(vec_peek(solver->path_taken, 0));
-    int64_t last_node = *(int64_t*)(vec_peek(solver->path_taken, level - 1));
+    PROFILE_ENTER(level);
+    solver->nb_explored++;
+    int64_t base_node = vec_i64_get(solver->path_taken, 0);
+    int64_t last_node = vec_i64_get(solver->path_taken, level - 1);
 
     // Base case: we reached the last level and have covered all the nodes
     if (level == config->nb_nodes) {
@@ -114,18 +210,27 @@ void solve_branch_and_bound(config_t const* config, solver_t* solver,
             if (final_weight < solver->minimum_cost) {
                 copy_optimal(solver);
                 solver->minimum_cost = final_weight;
+                solver_notify_incumbent(solver);
             }
         }
+        PROFILE_EXIT(level);
         return;
     }
 
-    // For any other level than the last, iterate on all vertices to build the
-    // search space tree recursively
-    for (size_t i = 0; i < config->nb_nodes; i++) {
+    // For any other level than the last, iterate on the candidate successors
+    // of the last vertex, or all vertices, to build the search space tree
+    // recursively
+    candidates_t const* candidates = solver->candidates;
+    size_t const begin = candidates ? candidates->offsets[last_node] : 0;
+    size_t const end =
+        candidates ? candidates->offsets[last_node + 1] : config->nb_nodes;
+    for (size_t k = begin; k < end; k++) {
+        size_t const i = candidates ? candidates->nodes[k] : k;
         // Consider next vertex if it is not same (diagonal entry in adjacency
         // matrix and not already visited)
-        int64_t new_weight = adj_matrix_get(config, last_node, i);
-        bool new_state = *(bool*)(vec_peek(solver->visited_nodes, i));
+        int64_t new_weight = candidates ? candidates->weights[k]
+                                        : adj_matrix_get(config, last_node, i);
+        bool new_state = vec_bool_get(solver->visited_nodes, i);
         if (new_weight != 0 && new_state == false) {
             int64_t tmp = current_bound;
             current_weight += new_weight;
@@ -133,11 +238,13 @@ void solve_branch_and_bound(config_t const* config, solver_t* solver,
             // Different computation of `curr_bound` for level 1 than for the
             // other levels
             if (level == 1) {
-                current_bound -=
-                    (first_min(config, last_node) + first_min(config, i)) / 2;
+                current_bound -= (solver_first_min(config, solver, last_node) +
+                                  solver_first_min(config, solver, i)) /
+                                 2;
             } else {
-                current_bound -=
-                    (second_min(config, last_node) + first_min(config, i)) / 2;
+                current_bound -= (solver_second_min(config, solver, last_node) +
+                                  solver_first_min(config, solver, i)) /
+                                 2;
             }
 
             // `current_bound + current_weight` is the actual lower bound for
@@ -145,12 +252,14 @@ void solve_branch_and_bound(config_t const* config, solver_t* solver,
             // If `actual_bound < final_res`, we need to explore the node
             // further
             if (current_bound + current_weight < solver->minimum_cost) {
-                *(int64_t*)(vec_peek(solver->path_taken, level)) = i;
-                *(bool*)(vec_peek(solver->visited_nodes, i)) = true;
+                vec_i64_set(solver->path_taken, level, i);
+                vec_bool_set(solver->visited_nodes, i, true);
 
                 // Call recursively for the next level
+                PROFILE_PAUSE();
                 solve_branch_and_bound(config, solver, current_bound,
                                        current_weight, level + 1);
+                PROFILE_RESUME();
             }
 
             // Else, we have to prune the node by resetting all changes to
@@ -158,26 +267,50 @@ void solve_branch_and_bound(config_t const* config, solver_t* solver,
             current_weight -= new_weight;
             current_bound = tmp;
 
-            // Also reset the visited array
-            for (size_t j = 0; j < solver->visited_nodes->len; j++) {
-                *(bool*)(vec_peek(solver->visited_nodes, j)) = false;
-            }
-            for (size_t j = 0; j <= level - 1; j++) {
-                *(bool*)(vec_peek(
-                    solver->visited_nodes,
-                    *(int64_t*)(vec_peek(solver->path_taken, j)))) = true;
-            }
+            // Also reset the visited array, the deeper levels having already
+            // reset their own nodes
+            vec_bool_set(solver->visited_nodes, i, false);
         }
     }
+    PROFILE_EXIT(level);
+}
+
+void solver_store_tour(config_t const* config, solver_t* solver,
+                       size_t const* tour)
+{
+    size_t const n = config->nb_nodes;
+    size_t start = 0;
+    while (tour[start] != 0) {
+        start++;
+    }
+
+    int64_t cost = 0;
+    for (size_t p = 0; p < n; p++) {
+        size_t from = tour[(start + p) % n];
+        size_t to = tour[(start + p + 1) % n];
+        vec_i64_set(solver->optimal_path, p, from);
+        int64_t w = adj_matrix_get(config, from, to);
+        if (w == 0 && n > 1) {
+            cost = INT64_MAX;
+        } else if (cost != INT64_MAX) {
+            cost += w;
+        }
+    }
+    vec_i64_set(solver->optimal_path, n, 0);
+    solver->minimum_cost = cost;
+    solver_notify_incumbent(solver);
 }
 
 void solver_print(solver_t const* solver)
 {
     printf("\nMinimum cost: %ld\n", solver->minimum_cost);
     printf("Path taken: ");
-    printf("%ld", *(int64_t*)(vec_peek(solver->optimal_path, 0)));
-    for (size_t i = 1; i <= solver->visited_nodes->len; i++) {
-        printf(" -> %ld", *(int64_t*)(vec_peek(solver->optimal_path, i)));
+    for (size_t i = 0; i <= solver->visited_nodes->len; i++) {
+        int64_t node = vec_i64_get(solver->optimal_path, i);
+        if (solver->labels && node >= 0) {
+            node = vec_i64_get(solver->labels, node);
+        }
+        printf(i ? " -> %ld" : "%ld", node);
     }
     printf("\n");
 }
@@ -0,0 +1,214 @@
+/**
+ * @file    spacefill.c
+ * @brief   Implementation of the space-filling curve engine.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "spacefill.h"
+#include "lk.h"
+#include "neighbors.h"
+#include "utils.h"
+
+#include <float.h>
+#include <omp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Spreads the 16 low bits of `x` to the even bits of the result
+static inline uint32_t spacefill_spread(uint32_t x)
+{
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    return x;
+}
+
+// Index of the cell `(x, y)` along a Hilbert curve over a 2^16 square grid.
+// Rather than descending the curve one level at a time, which branches on
+// every bit, the orientation of each level is computed for all the levels at
+// once by a parallel prefix scan over the bits of both coordinates.
+static inline uint32_t spacefill_hilbert(uint32_t x, uint32_t y)
+{
+    uint32_t a = x ^ y;
+    uint32_t b = 0xFFFF ^ a;
+    uint32_t c = 0xFFFF ^ (x | y);
+    uint32_t d = x & (y ^ 0xFFFF);
+    uint32_t A = a | (b >> 1);
+    uint32_t B = (a >> 1) ^ a;
+    uint32_t C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+    uint32_t D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+
+    for (uint32_t shift = 2; shift <= 8; shift *= 2) {
+        a = A;
+        b = B;
+        c = C;
+        d = D;
+        A = (a & (a >> shift)) ^ (b & (b >> shift));
+        B = (a & (b >> shift)) ^ (b & ((a ^ b) >> shift));
+        C ^= (a & (c >> shift)) ^ (b & (d >> shift));
+        D ^= (b & (c >> shift)) ^ ((a ^ b) & (d >> shift));
+    }
+
+    a = C ^ (C >> 1);
+    b = D ^ (D >> 1);
+    uint32_t const i0 = x ^ y;
+    uint32_t const i1 = b | (0xFFFF ^ (i0 | a));
+    return (spacefill_spread(i1) << 1) | spacefill_spread(i0);
+}
+
+// Fills `keys` with the Hilbert index of every node in the high 32 bits and
+// the node in the low ones
+static void spacefill_keys(config_t const* config, uint64_t* keys)
+{
+    size_t const n = config->nb_nodes;
+    double const* coords = config->coordinates->data;
+    double min_x = DBL_MAX, min_y = DBL_MAX;
+    double max_x = -DBL_MAX, max_y = -DBL_MAX;
+#pragma omp parallel for reduction(min : min_x, min_y) \
+    reduction(max : max_x, max_y)
+    for (size_t i = 0; i < n; i++) {
+        min_x = coords[2 * i] < min_x ? coords[2 * i] : min_x;
+        max_x = coords[2 * i] > max_x ? coords[2 * i] : max_x;
+        min_y = coords[2 * i + 1] < min_y ? coords[2 * i + 1] : min_y;
+        max_y = coords[2 * i + 1] > max_y ? coords[2 * i + 1] : max_y;
+    }
+
+    // The same scale on both axes keeps the curve's cells square
+    double const extent =
+        max_x - min_x > max_y - min_y ? max_x - min_x : max_y - min_y;
+    double const scale =
+        extent > 0.0 ? ((1u << SPACEFILL_BITS) - 1) / extent : 0.0;
+
+#pragma omp parallel for simd
+    for (size_t i = 0; i < n; i++) {
+        uint32_t x = (uint32_t)((coords[2 * i] - min_x) * scale);
+        uint32_t y = (uint32_t)((coords[2 * i + 1] - min_y) * scale);
+        keys[i] = (uint64_t)spacefill_hilbert(x, y) << 32 | i;
+    }
+}
+
+// Sorts the keys by their high 32 bits with a parallel least significant
+// digit radix sort, one byte per pass. Each thread counts the digits of its
+// own slice of the keys, then scatters the slice at the offsets that the
+// counts of all the threads give it, which keeps the sort stable.
+static bool spacefill_sort(uint64_t* keys, size_t n)
+{
+    size_t const max_threads = (size_t)omp_get_max_threads();
+    uint64_t* tmp = malloc(n * sizeof(uint64_t));
+    size_t* counts = malloc(max_threads * 256 * sizeof(size_t));
+    if (!tmp || !counts) {
+        free(tmp);
+        free(counts);
+        return false;
+    }
+
+    uint64_t* from = keys;
+    uint64_t* to = tmp;
+    for (unsigned shift = 32; shift < 64; shift += 8) {
+#pragma omp parallel
+        {
+            size_t const t = (size_t)omp_get_thread_num();
+            size_t const nb_threads = (size_t)omp_get_num_threads();
+            size_t const begin = n * t / nb_threads;
+            size_t const end = n * (t + 1) / nb_threads;
+            size_t* count = &counts[t * 256];
+            for (size_t digit = 0; digit < 256; digit++) {
+                count[digit] = 0;
+            }
+            for (size_t i = begin; i < end; i++) {
+                count[(from[i] >> shift) & 0xFF]++;
+            }
+
+#pragma omp barrier
+#pragma omp single
+            {
+                size_t offset = 0;
+                for (size_t digit = 0; digit < 256; digit++) {
+                    for (size_t u = 0; u < nb_threads; u++) {
+                        size_t c = counts[u * 256 + digit];
+                        counts[u * 256 + digit] = offset;
+                        offset += c;
+                    }
+                }
+            }
+
+            for (size_t i = begin; i < end; i++) {
+                to[count[(from[i] >> shift) & 0xFF]++] = from[i];
+            }
+        }
+        uint64_t* swap = from;
+        from = to;
+        to = swap;
+    }
+
+    // An even number of passes leaves the sorted keys in `keys`
+    free(tmp);
+    free(counts);
+    return true;
+}
+
+tsp_status_t spacefill_order(config_t const* config, size_t* tour)
+{
+    size_t const n = config->nb_nodes;
+    if (!config->coordinates) {
+        return TSP_ERR_INVALID_ARGUMENT;
+    }
+
+    uint64_t* keys = malloc(n * sizeof(uint64_t));
+    if (!keys) {
+        return TSP_ERR_ALLOC;
+    }
+    spacefill_keys(config, keys);
+    bool sorted = spacefill_sort(keys, n);
+#pragma omp parallel for simd
+    for (size_t i = 0; i < n; i++) {
+        tour[i] = keys[i] & UINT32_MAX;
+    }
+    free(keys);
+    return sorted ? TSP_OK : TSP_ERR_ALLOC;
+}
+
+tsp_status_t solve_spacefill(config_t const* config, solver_t* solver,
+                             double time_limit)
+{
+    size_t const n = config->nb_nodes;
+    if (!config->coordinates) {
+        return TSP_ERR_INVALID_ARGUMENT;
+    }
+    double const deadline = wall_time() + time_limit;
+    size_t* tour = malloc(n * sizeof(size_t));
+    if (!tour) {
+        return TSP_ERR_ALLOC;
+    }
+    tsp_status_t status = spacefill_order(config, tour);
+    if (status != TSP_OK) {
+        free(tour);
+        return status;
+    }
+    solver_store_tour(config, solver, tour);
+    if (time_limit <= 0.0 || n < 5) {
+        free(tour);
+        return TSP_OK;
+    }
+
+    neighbors_t* neighbors = neighbors_build(config, SPACEFILL_NEIGHBORS);
+    lk_t* lk = neighbors ? lk_init(config, neighbors) : NULL;
+    status = TSP_ERR_ALLOC;
+    if (lk) {
+        lk_set_tour(lk, tour);
+        solver->nb_explored +=
+            lk_two_opt_pass(lk, SPACEFILL_MAX_REVERSAL, deadline);
+        lk_get_tour(lk, tour);
+        solver_store_tour(config, solver, tour);
+        lk_destroy(lk);
+        status = TSP_OK;
+    }
+
+    if (neighbors) {
+        neighbors_destroy(neighbors);
+    }
+    free(tour);
+    return status;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file    status.c
+ * @brief   Implementation of the status codes related functions.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "status.h"
+
+char const* tsp_strerror(tsp_status_t status)
+{
+    switch (status) {
+    case TSP_OK:
+        return "success";
+    case TSP_ERR_INVALID_ARGUMENT:
+        return "invalid argument";
+    case TSP_ERR_ALLOC:
+        return "memory allocation failed";
+    case TSP_ERR_IO:
+        return "failed to read the configuration file";
+    case TSP_ERR_FORMAT:
+        return "malformed configuration file";
+    case TSP_ERR_NO_TOUR:
+        return "the graph has no tour";
+    }
+    return "unknown error";
+}
@@ -0,0 +1,176 @@
+/**
+ * @file    tsp.c
+ * @brief   Implementation of the public API of the `libtsp` library.
+ * @author  Gabriel Dos Santos
+ **/
+
+#include "tsp.h"
+#include "christofides.h"
+#include "config.h"
+#include "cut.h"
+#include "genetic.h"
+#include "hybrid.h"
+#include "little.h"
+#include "lk.h"
+#include "options.h"
+#include "portfolio.h"
+#include "selector.h"
+#include "solver.h"
+#include "spacefill.h"
+
+#include <stdlib.h>
+
+struct tsp_workspace_t {
+    solver_t* solver;
+};
+
+void tsp_options_default(tsp_options_t* options)
+{
+    *options = (tsp_options_t){
+        .engine = ENGINE_EXACT,
+        .time_limit = 0.0,
+        .seed = 1,
+        .threads = 0,
+        .target_cost = INT64_MIN,
+        .on_incumbent = NULL,
+        .user_data = NULL,
+        .workspace = NULL,
+    };
+}
+
+tsp_workspace_t* tsp_workspace_create(void)
+{
+    tsp_workspace_t* workspace = malloc(sizeof(tsp_workspace_t));
+    if (!workspace) {
+        return NULL;
+    }
+
+    workspace->solver = solver_init(1);
+    if (!workspace->solver) {
+        free(workspace);
+        return NULL;
+    }
+    return workspace;
+}
+
+void tsp_workspace_destroy(tsp_workspace_t* workspace)
+{
+    if (workspace) {
+        solver_destroy(workspace->solver);
+        free(workspace);
+    }
+}
+
+tsp_status_t tsp_dispatch(config_t const* config, solver_t* solver,
+                          options_t const* options)
+{
+    switch (options->engine) {
+    case ENGINE_EXACT:
+        solve_tsp(config, solver);
+        return TSP_OK;
+    case ENGINE_LK:
+        return solve_lk(config, solver, options->time_limit, options->seed);
+    case ENGINE_PORTFOLIO:
+        return solve_portfolio(config, solver, options);
+    case ENGINE_HYBRID:
+        return solve_hybrid(config, solver);
+    case ENGINE_CHRISTOFIDES:
+        return solve_christofides(config, solver);
+    case ENGINE_SPACEFILL:
+        return solve_spacefill(config, solver, options->time_limit);
+    case ENGINE_GENETIC:
+        return solve_genetic(config, solver, options);
+    case ENGINE_CUT:
+        return solve_cut(config, solver);
+    case ENGINE_LITTLE:
+        return solve_little(config, solver, options->time_limit);
+    case ENGINE_AUTO: {
+        features_t features;
+        selection_t selection;
+        options_t resolved = *options;
+        selector_resolve(config, &resolved, &features, &selection);
+        return tsp_dispatch(config, solver, &resolved);
+    }
+    }
+    return TSP_ERR_INVALID_ARGUMENT;
+}
+
+// Forwards the incumbents of the solver to the callback of the options
+static void tsp_notify(solver_t const* solver, void* data)
+{
+    tsp_options_t const* options = data;
+    options->on_incumbent(solver->minimum_cost, solver->optimal_path->data,
+                          solver->visited_nodes->len, options->user_data);
+}
+
+tsp_status_t tsp_solve(int64_t const* matrix, size_t nb_nodes,
+                       tsp_options_t const* options, tsp_result_t* result)
+{
+    tsp_options_t defaults;
+    if (!options) {
+        tsp_options_default(&defaults);
+        options = &defaults;
+    }
+    if (!matrix || !nb_nodes || !result || !result->tour ||
+        options->engine > ENGINE_AUTO) {
+        return TSP_ERR_INVALID_ARGUMENT;
+    }
+
+    // Wrap the caller's matrix without copying it
+    vec_i64_t adjacency_matrix = {
+        .len = nb_nodes * nb_nodes,
+        .capacity = nb_nodes * nb_nodes,
+        .data = (int64_t*)matrix,
+    };
+    config_t config = {
+        .nb_nodes = nb_nodes,
+        .adjacency_matrix = &adjacency_matrix,
+        .coordinates = NULL,
+        .sparse = NULL,
+        .labels = NULL,
+        .matrix_backing = PAGES_HEAP,
+        .triangular = false,
+    };
+
+    solver_t* solver;
+    if (options->workspace) {
+        solver = options->workspace->solver;
+        if (solver_reset(solver, nb_nodes) != TSP_OK) {
+            return TSP_ERR_ALLOC;
+        }
+    } else {
+        solver = solver_init(nb_nodes);
+        if (!solver) {
+            return TSP_ERR_ALLOC;
+        }
+    }
+    solver->on_incumbent = options->on_incumbent ? tsp_notify : NULL;
+    solver->incumbent_data = (void*)options;
+
+    options_t solver_options = {
+        .config_file = NULL,
+        .engine = options->engine,
+        .time_limit = options->time_limit,
+        .seed = options->seed,
+        .threads = options->threads,
+        .target_cost = options->target_cost,
+    };
+    tsp_status_t status = tsp_dispatch(&config, solver, &solver_options);
+
+    if (status == TSP_OK && solver->minimum_cost == INT64_MAX) {
+        status = TSP_ERR_NO_TOUR;
+    }
+    if (status == TSP_OK) {
+        result->cost = solver->minimum_cost;
+        for (size_t i = 0; i <= nb_nodes; i++) {
+            result->tour[i] = solver->optimal_path->data[i];
+        }
+    }
+
+    solver->on_incumbent = NULL;
+    solver->incumbent_data = NULL;
+    if (!options->workspace) {
+        solver_destroy(solver);
+    }
+    return status;
+}
@@ -7,50 +7,183 @@
 
 #include "utils.h"
 
-inline int64_t adj_matrix_get(config_t const* config, size_t i, size_t j)
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+int64_t coord_distance(config_t const* config, size_t i, size_t j)
 {
-    return *(
-        int64_t*)(vec_peek(config->adjacency_matrix, i * config->nb_nodes + j));
+    if (i == j) {
+        return 0;
+    }
+
+    double const* coords = config->coordinates->data;
+    double dx = coords[2 * i] - coords[2 * j];
+    double dy = coords[2 * i + 1] - coords[2 * j + 1];
+    int64_t d = (int64_t)(sqrt(dx * dx + dy * dy) + 0.5);
+    return d ? d : 1;
 }
 
-int64_t first_min(config_t const* config, size_t const i)
+void adj_matrix_row(config_t const* config, size_t i, int64_t* row)
 {
-    int64_t min = INT64_MAX;
-    for (size_t j = 0; j < config->nb_nodes; j++) {
-        int64_t current = adj_matrix_get(config, i, j);
-        if (current < min && i != j) {
-            min = current;
+    size_t const n = config->nb_nodes;
+    if (!config->adjacency_matrix) {
+        for (size_t j = 0; j < n; j++) {
+            row[j] = adj_matrix_get(config, i, j);
         }
+        return;
+    }
+
+    int64_t const* matrix = config->adjacency_matrix->data;
+    if (!config->triangular) {
+        memcpy(row, &matrix[i * n], n * sizeof(int64_t));
+        return;
     }
-    return min;
+    // Entry (j, i) of the rows above is `n - j - 1` entries after (j - 1, i)
+    size_t index = i;
+    for (size_t j = 0; j < i; j++) {
+        row[j] = matrix[index];
+        index += n - j - 1;
+    }
+    memcpy(&row[i], &matrix[index], (n - i) * sizeof(int64_t));
 }
 
-int64_t second_min(config_t const* config, size_t const i)
+bool adj_matrix_symmetric(config_t const* config)
 {
-    int64_t first = INT64_MAX;
-    int64_t second = INT64_MAX;
-    for (size_t j = 0; j < config->nb_nodes; j++) {
-        if (i == j) {
-            continue;
+    size_t const n = config->nb_nodes;
+    if (config->coordinates || config->triangular) {
+        return true;
+    }
+    if (config->sparse) {
+        sparse_t const* sparse = config->sparse;
+        int64_t const* offsets = sparse->offsets->data;
+        int64_t const* targets = sparse->targets->data;
+        int64_t const* weights = sparse->weights->data;
+        for (size_t u = 0; u < n; u++) {
+            for (int64_t e = offsets[u]; e < offsets[u + 1]; e++) {
+                size_t v = targets[e];
+                size_t f = sparse_find(sparse, v, u);
+                if (f == (size_t)offsets[v + 1] || weights[f] != weights[e]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < i; j++) {
+            if (adj_matrix_get(config, i, j) != adj_matrix_get(config, j, i)) {
+                return false;
+            }
         }
+    }
+    return true;
+}
+
+static inline void row_minimums_push(int64_t current, int64_t* first,
+                                     int64_t* second)
+{
+    if (current <= *first) {
+        *second = *first;
+        *first = current;
+    } else if (current < *second) {
+        *second = current;
+    }
+}
 
-        int64_t current = adj_matrix_get(config, i, j);
-        if (current <= first) {
-            second = first;
-            first = current;
-        } else if (current <= second && current != first) {
-            second = current;
+// Scans the weights of the edges leaving `i` for their minimum and second
+// minimum. Missing edges weigh 0, but sparse instances only store the others,
+// so (at most two of) their missing edges are added after their lists.
+static void row_minimums(config_t const* config, size_t i, int64_t* first,
+                         int64_t* second)
+{
+    *first = INT64_MAX;
+    *second = INT64_MAX;
+    if (config->triangular) {
+        // Down the column of `i`, then along its row past the diagonal
+        int64_t const* matrix = config->adjacency_matrix->data;
+        size_t const n = config->nb_nodes;
+        size_t index = i;
+        for (size_t j = 0; j < i; j++) {
+            row_minimums_push(matrix[index], first, second);
+            index += n - j - 1;
+        }
+        for (size_t j = i + 1; j < n; j++) {
+            row_minimums_push(matrix[++index], first, second);
+        }
+        return;
+    }
+    if (!config->sparse) {
+        for (size_t j = 0; j < config->nb_nodes; j++) {
+            if (i != j) {
+                row_minimums_push(adj_matrix_get(config, i, j), first, second);
+            }
         }
+        return;
     }
+
+    sparse_t const* sparse = config->sparse;
+    size_t const begin = sparse->offsets->data[i];
+    size_t const end = sparse->offsets->data[i + 1];
+    for (size_t e = begin; e < end; e++) {
+        row_minimums_push(sparse->weights->data[e], first, second);
+    }
+    size_t const degree = end - begin;
+    for (size_t m = degree; m < config->nb_nodes - 1 && m < degree + 2; m++) {
+        row_minimums_push(0, first, second);
+    }
+}
+
+int64_t first_min(config_t const* config, size_t const i)
+{
+    int64_t first, second;
+    row_minimums(config, i, &first, &second);
+    return first;
+}
+
+int64_t second_min(config_t const* config, size_t const i)
+{
+    int64_t first, second;
+    row_minimums(config, i, &first, &second);
     return second;
 }
 
 void copy_optimal(solver_t* solver)
 {
-    for (size_t i = 0; i < solver->path_taken->len - 1; i++) {
-        *(int64_t*)(vec_peek(solver->optimal_path, i)) =
-            *(int64_t*)(vec_peek(solver->path_taken, i));
+    size_t const len = solver->path_taken->len;
+    for (size_t i = 0; i < len - 1; i++) {
+        vec_i64_set(solver->optimal_path, i,
+                    vec_i64_get(solver->path_taken, i));
+    }
+    vec_i64_set(solver->optimal_path, len - 1,
+                vec_i64_get(solver->path_taken, 0));
+}
+
+uint64_t rng_next(uint64_t* state)
+{
+    // xorshift64* generator, the state must never be 0
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+double wall_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+uint64_t hash_bytes(void const* data, size_t len, uint64_t seed)
+{
+    unsigned char const* bytes = data;
+    uint64_t hash = seed;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
     }
-    *(int64_t*)(vec_peek(solver->optimal_path, solver->path_taken->len - 1)) =
-        *(int64_t*)(vec_peek(solver->path_taken, 0));
+    return hash;
 }
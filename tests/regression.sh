@@ -0,0 +1,182 @@
+#!/bin/sh
+#
+# Regression tests of the `tsp` binary, run by `make check`.
+# Each case runs the solver under a time and memory limit, and checks its exit
+# status and the lines it prints.
+
+TSP=${TSP:-target/tsp}
+TESTS=$(dirname "$0")
+TIMEOUT=10
+SCRATCH=$(mktemp -d)
+trap 'rm -rf "$SCRATCH"' EXIT
+failures=0
+
+# Runs `$TSP` with the given arguments, and keeps its output in `$output` and
+# its exit status in `$status`
+run() {
+    output=$( (ulimit -v 2000000; timeout "$TIMEOUT" "$TSP" "$@") 2>&1)
+    status=$?
+}
+
+fail() {
+    printf '\033[1;31mFAIL\033[0m %s: %s\n' "$1" "$2"
+    failures=$((failures + 1))
+}
+
+pass() {
+    printf '\033[1;32mPASS\033[0m %s\n' "$1"
+}
+
+# Checks the exit status of the last run, reporting the failure if it differs
+check_status() {
+    if [ "$status" -eq 124 ] || [ "$status" -gt 128 ]; then
+        fail "$1" "killed after ${TIMEOUT}s or out of memory"
+    elif [ "$status" -ne "$2" ]; then
+        fail "$1" "exit status $status instead of $2"
+    else
+        return 0
+    fi
+    return 1
+}
+
+# Checks that the solver exits with the given status and prints the given line
+expect() {
+    name=$1
+    expected_status=$2
+    expected_line=$3
+    shift 3
+    run "$@"
+    if ! check_status "$name" "$expected_status"; then
+        return
+    elif ! printf '%s\n' "$output" | grep -qF "$expected_line"; then
+        fail "$name" "no line \`$expected_line\`"
+    else
+        pass "$name"
+    fi
+}
+
+# Checks that the solver succeeds with a tour that does not use the edge
+# between the given nodes
+expect_no_edge() {
+    name=$1
+    from=$2
+    to=$3
+    shift 3
+    run "$@"
+    if ! check_status "$name" 0; then
+        return
+    elif printf '%s\n' "$output" | grep '^Path taken:' |
+        grep -qE "(^|[^0-9])($from -> $to|$to -> $from)( |\$)"; then
+        fail "$name" "the tour uses the edge $from-$to"
+    else
+        pass "$name"
+    fi
+}
+
+# Local search moves assume symmetric weights, asymmetric instances used to
+# make `lk` loop until it ran out of memory
+expect "lk refuses asymmetric instances" 1 "invalid argument" \
+    -e lk "$TESTS/atsp_7.txt"
+
+# A line that is not a pair of coordinates used to be skipped, which shifted
+# the numbering of the nodes after it
+expect "coordinates reject malformed lines" 1 "malformed" \
+    "$TESTS/euc_corrupt.txt"
+
+expect "portfolio refuses asymmetric instances" 1 "invalid argument" \
+    -e portfolio -t 1 "$TESTS/atsp_7.txt"
+
+# Tours of less than 8 nodes cannot be kicked, the portfolio used to restart
+# runs until the end of its time limit
+expect "portfolio stops on tiny instances" 0 "Minimum cost: 19" \
+    -e portfolio -t 60 "$TESTS/sym_5.txt"
+
+# Instances of 1000 nodes and more are renumbered once loaded, which used to
+# compute their Euclidean weights again and lose the delta
+awk 'BEGIN {
+    print "1000 EUC_2D"
+    for (i = 0; i < 1000; i++) print 10 * (i % 40), 10 * int(i / 40)
+}' > "$SCRATCH/grid_1000.txt"
+awk 'BEGIN { for (i = 0; i < 1000; i++) printf "%d ", i; print "0" }' \
+    > "$SCRATCH/grid_1000.tour"
+printf '0 1 100000000\n1 2 100000000\n2 3 100000000\n' \
+    > "$SCRATCH/grid_1000.delta"
+expect_no_edge "renumbering keeps the delta" 1 2 -e lk \
+    -P "$SCRATCH/grid_1000.tour" -D "$SCRATCH/grid_1000.delta" \
+    "$SCRATCH/grid_1000.txt"
+
+# Euclidean instances used to be cached by their coordinates only, so the
+# result of the instance before a delta was read back after it
+awk 'BEGIN {
+    print "20 EUC_2D"
+    for (i = 0; i < 20; i++) print 10 * (i % 5), 10 * int(i / 5)
+}' > "$SCRATCH/grid_20.txt"
+run -e lk -C "$SCRATCH/cache" "$SCRATCH/grid_20.txt"
+printf '%s\n' "$output" | sed -n 's/^Path taken: //p' > "$SCRATCH/grid_20.tour"
+read -r first _ second _ < "$SCRATCH/grid_20.tour"
+printf '%s %s 100000000\n' "$first" "$second" > "$SCRATCH/grid_20.delta"
+expect_no_edge "the cache tells deltas apart" "$first" "$second" -e lk \
+    -C "$SCRATCH/cache" -P "$SCRATCH/grid_20.tour" \
+    -D "$SCRATCH/grid_20.delta" "$SCRATCH/grid_20.txt"
+
+# Twice the matching is no lower bound without the triangle inequality, the
+# optimal tour of this instance costs 104
+expect "christofides bounds non-metric instances" 0 "Lower bound: 4 " \
+    -e christofides "$TESTS/nonmetric_5.txt"
+
+# Asymmetric instances used to fall back to the search of `exact`, whose bound
+# can prune the optimal tour (it finds 1758)
+expect "cut solves asymmetric instances exactly" 0 "Minimum cost: 1412" \
+    -e cut "$TESTS/atsp_7.txt"
+
+# Asymmetric instances of any size used to be given to `little`, which
+# ignored the time limit
+awk 'BEGIN {
+    print 300
+    seed = 12345
+    for (i = 0; i < 300; i++) {
+        for (j = 0; j < 300; j++) {
+            seed = (seed * 1103515245 + 12345) % 2147483648
+            printf "%d ", i == j ? 0 : 1 + seed % 1000
+        }
+        print ""
+    }
+}' > "$SCRATCH/atsp_300.txt"
+expect "auto stops on large asymmetric instances" 0 "Minimum cost:" \
+    -e auto -t 2 "$SCRATCH/atsp_300.txt"
+
+# Unknown kinds of instances used to be read as an adjacency matrix
+printf '4 GEO\n0 1 2 1\n1 0 1 2\n2 1 0 1\n1 2 1 0\n' > "$SCRATCH/geo_4.txt"
+expect "unknown instance kinds are malformed" 1 "malformed" \
+    "$SCRATCH/geo_4.txt"
+
+# The first tour and its local search used to ignore the time limit, which
+# took seconds on large instances
+awk 'BEGIN {
+    print "100000 EUC_2D"
+    srand(1)
+    for (i = 0; i < 100000; i++) print int(rand() * 1e6), int(rand() * 1e6)
+}' > "$SCRATCH/uniform_100000.txt"
+TIMEOUT=5
+expect "lk stops at its time limit" 0 "Minimum cost:" \
+    -e lk -t 0.5 "$SCRATCH/uniform_100000.txt"
+TIMEOUT=10
+
+# Negative thread counts used to wrap around to a huge allocation
+expect "negative thread counts are rejected" 1 "invalid number of threads" \
+    -e portfolio -j -1 "$TESTS/sym_5.txt"
+
+# The local search of a run used to ignore the time limit
+TIMEOUT=5
+expect "portfolio stops at its time limit" 0 "Minimum cost:" \
+    -e portfolio -t 0.5 "$SCRATCH/uniform_100000.txt"
+TIMEOUT=10
+
+# A time limit that is not a number used to be read as no time limit
+expect "malformed time limits are rejected" 1 "invalid time limit" \
+    -e lk -t abc "$TESTS/sym_5.txt"
+
+if [ "$failures" -ne 0 ]; then
+    printf '%d test(s) failed\n' "$failures"
+    exit 1
+fi